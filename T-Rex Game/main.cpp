@@ -3,14 +3,54 @@
 // ------------------------------------------------------------------
 // Features
 //  - Smooth 60 FPS loop with double‑buffered GDI rendering
+//  - The fixed-step simulation runs on its own thread (trex_simthread.h):
+//    the UI thread posts timestamped inputs and renders the latest
+//    published snapshot, so a slow frame never slows the game down
 //  - Jump (SPACE/UP/Left‑Click), Duck (DOWN)
 //  - Procedural obstacles: small/large/double cacti, low/high birds, boulders
-//  - Difficulty ramps with speed + spawn rate; parallax clouds
+//  - Difficulty ramps with speed + spawn rate; clouds are one pre-rendered
+//    sprite each, the ground's pebbles a scrolling strip (trex_parallax.h)
 //  - Score + persistent High Score (trex_highscore.dat)
 //  - Run log (trex_runs.log with timestamp)
+//  - Input recording of every finished run (trex_runs.rec, seed + key
+//    events); trex_cli --replay re-simulates and checks the scores
 //  - Top‑5 leaderboard persistence (trex_top5.txt)
-//  - R = restart, ESC = quit
-// Build: Win32 GUI app, link Gdi32 (Visual Studio or MinGW). No assets needed.
+//  - Score files are written on a background thread (trex_persist.cpp),
+//    replaced atomically, never from inside the frame loop
+//  - R = restart, ESC = quit, F2 = software framebuffer / GDI renderer
+//  - F3 = show pixels repainted per frame (dirty rectangles) and frame
+//    pacing (p99 interval, render cost) in the title
+//  - F4 = export frame pacing histograms to trex_pacing.csv
+//  - Obstacle shapes and odds per score tier come from trex_spawn.txt
+//    when present (format in trex_spawn.h), else the built-in table; a
+//    file that doesn't parse is reported at startup and in trex_spawn.log
+//  - Obstacles come from a stream generated ahead on a worker thread and
+//    checked against the dino's jump/duck reach, so every run can be
+//    survived (trex_stream.h)
+//  - Dust on take-off/landing, debris (and feathers from birds) on a
+//    crash; cosmetic only, see trex_particles.h
+//  - Day/night cycle by score: the finished frame is remapped through a
+//    per-channel color LUT (trex_palette.h); the GDI renderer maps the
+//    colors it draws through the same LUT
+//  - Resizable window: the 900x360 frame is scaled to fit, letterboxed
+//    (trex_scale.h); F5 = bilinear / integer nearest-neighbour
+//  - Built with -DTREX_TRACK_ALLOC, heap calls are counted per frame and
+//    shown by F3 (trex_alloc.h); play is meant to allocate nothing
+//  - F6 = start/stop recording the game to trex_capture_<time>.y4m
+//    (software renderer only); frames are encoded on a background
+//    thread, and dropped rather than waited for (trex_capture.h)
+//  - Live counters (state, score, FPS, frame-time percentiles, ...) are
+//    published every frame to a shared-memory segment for external
+//    monitors such as trex_top (trex_telemetry.h)
+//  - Two-player race over UDP, one window per player, with rollback
+//    netcode (trex_racelink.h); the keyboard drives your dino, the
+//    rival's is drawn as an outline:
+//      T-Rex.exe --race 0 --port 7000 --peer-port 7001
+//      T-Rex.exe --race 1 --port 7001 --peer-port 7000 [--host IP]
+//    plus [--seed S] [--delay D]; both sides need the same seed
+// Build: Win32 GUI app, link Gdi32 and Ws2_32 (Visual Studio or MinGW). No assets needed.
+//        Game rules live in trex_sim.cpp (shared with the headless trex_cli);
+//        scene drawing in trex_render.cpp, against the GdiBackend below.
 // ------------------------------------------------------------------
 
 #define UNICODE
@@ -19,65 +59,36 @@
 
 #include <windows.h>
 #include <windowsx.h>
+#include "trex_sim.h"
+#include "trex_render.h"
+#include "trex_fb.h"
+#include "trex_damage.h"
+#include "trex_replay.h"
+#include "trex_persist.h"
+#include "trex_pacing.h"
+#include "trex_particles.h"
+#include "trex_stream.h"
+#include "trex_telemetry.h"
+#include "trex_palette.h"
+#include "trex_scale.h"
+#include "trex_alloc.h"
+#include "trex_simthread.h"
+#include "trex_capture.h"
+#include "trex_racelink.h"
 #include <vector>
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <cwchar>
+#include <cstring>
+#include <cstdio>
 #include <random>
 #include <chrono>
 #include <ctime>
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <memory>
 
-// ----------------------- Config -----------------------
-static const int   W_WIDTH   = 900;
-static const int   W_HEIGHT  = 360;
-static const int   GROUND_H  = 64;     // ground strip height
-static const int   FPS       = 60;     // target frames per second
-static const float DT        = 1.0f / FPS;
-static const float GRAVITY   = 2200.0f;  // px/s^2
-static const float JUMP_VEL  = 760.0f;   // px/s
-static const float BASE_SPD  = 360.0f;   // world scroll speed px/s
-
-// Colors (BGR)
-static const COLORREF COL_BG      = RGB(245, 245, 245);
-static const COLORREF COL_GROUND  = RGB(60, 60, 60);
-static const COLORREF COL_DINO    = RGB(48, 48, 48);
-static const COLORREF COL_OBS     = RGB(30, 30, 30);
-static const COLORREF COL_BIRD    = RGB(10, 10, 10);
-static const COLORREF COL_TEXT    = RGB(10, 10, 10);
-static const COLORREF COL_UI      = RGB(0, 120, 215);
-
-// ----------------------- Types ------------------------
-enum class GameState { MENU, PLAYING, GAMEOVER };
-enum class ObType    { CactusSmall, CactusLarge, CactusDouble, BirdLow, BirdHigh, Boulder };
-
-struct RectF { float x, y, w, h; };
-static inline bool Intersect(const RectF&a, const RectF&b){
-    return !(a.x + a.w < b.x || b.x + b.w < a.x || a.y + a.h < b.y || b.y + b.h < a.y);
-}
-
-struct Obstacle {
-    ObType type{};
-    float x{}, y{}, w{}, h{}, speed{};
-    int anim{0}; // for birds
-};
-
-struct Cloud { float x, y, speed; };
-
-struct Dino {
-    float x{}, y{};     // top‑left position
-    float vy{};         // vertical velocity
-    bool onGround{true};
-    bool duck{false};
-    int  blink{0};      // hit flash
-
-    RectF bbox() const {
-        float bw = 44.0f;
-        float bh = duck ? 28.0f : 48.0f;
-        return RectF{ x, y + (duck ? 20.0f : 0.0f), bw, bh };
-    }
-};
+static const wchar_t* WINDOW_TITLE = L"T‑Rex — Win32 (C++/GDI)";
 
 // -------------------- Globals ------------------------
 HINSTANCE   g_hInst;
@@ -86,269 +97,299 @@ HDC         g_hMemDC;
 HBITMAP     g_hBmp;
 HBITMAP     g_hBmpOld;
 
-GameState   g_state = GameState::MENU;
-Dino        g_dino;
-std::vector<Obstacle> g_obs;
-std::vector<Cloud>    g_clouds;
-std::mt19937          g_rng{ std::random_device{}() };
+SpawnTable  g_spawnFile;   // trex_spawn.txt, if it loaded
+ScoreWriter g_scores;      // score files, written off the game thread (trex_persist.h)
 
-float g_worldSpd = BASE_SPD;
-float g_spawnTimer = 0.0f;
-float g_spawnGapMin = 0.85f, g_spawnGapMax = 1.85f; // seconds
-float g_nextSpawnIn = 1.0f;
-
-int   g_score = 0;          // integer score (meters)
-int   g_highScore = 0;
-std::vector<int> g_top5;
+// What the UI thread draws: the latest SimSnapshot, unpacked. The World
+// itself, recorder and obstacle stream live on the sim thread (g_sim).
+World       g_view;
+int         g_viewHighScore = 0;
+std::vector<int> g_viewTop5;
+uint64_t    g_viewStep = 0;
+uint64_t    g_viewRun = 0;
+ParticleSystem g_fx;       // dust/debris/feathers, driven by the snapshots
 
 bool  g_leftMouseDown = false;
-LARGE_INTEGER g_freq, g_prev;
 
-// ---------------- Persistence ------------------------
-int LoadHighScore(){
-    std::ifstream f("trex_highscore.dat");
-    int hs=0; if(f) f>>hs; return hs;
-}
+// QueryPerformanceCounter as a pacing clock
+class QpcClock : public Clock {
+public:
+    QpcClock(){ LARGE_INTEGER f; QueryPerformanceFrequency(&f); freq_ = (uint64_t)f.QuadPart; }
+    uint64_t Now() override { LARGE_INTEGER t; QueryPerformanceCounter(&t); return (uint64_t)t.QuadPart; }
+    uint64_t Frequency() const override { return freq_; }
+private:
+    uint64_t freq_;
+};
 
-void SaveHighScore(int hs){
-    std::ofstream f("trex_highscore.dat", std::ios::trunc);
-    if(f) f<<hs;
-}
+QpcClock   g_clock;
+FramePacer g_pacer(g_clock, DT);   // UI frame interval + render cost histograms
+SimThread  g_sim(g_clock);
 
-std::vector<int> LoadTop5(){
-    std::vector<int> v; std::ifstream f("trex_top5.txt");
-    int s; while(f>>s) v.push_back(s);
-    std::sort(v.begin(), v.end(), std::greater<int>());
-    if(v.size()>5) v.resize(5);
-    return v;
+// ---------------- Run setup --------------------------
+// Fresh seed per run; time is mixed in because some MinGW random_device
+// implementations return the same sequence on every launch.
+uint32_t NewRunSeed(){
+    return std::random_device{}() ^ (uint32_t)std::time(nullptr);
 }
 
-void SaveTop5(const std::vector<int>& v){
-    std::ofstream f("trex_top5.txt", std::ios::trunc);
-    for(size_t i=0;i<v.size() && i<5;i++) f<<v[i]<<"\n";
-}
-
-void AppendRunLog(int score){
-    std::ofstream f("trex_runs.log", std::ios::app);
-    if(!f) return;
-    std::time_t t = std::time(nullptr);
-    std::tm tm{};
-#ifdef _WIN32
-    localtime_s(&tm, &t);
-#else
-    tm = *std::localtime(&t);
-#endif
-    char buf[64]; std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
-    f << buf << ", " << score << "\n";
-}
-
-// ---------------- Utilities --------------------------
-float frand(float a, float b){ std::uniform_real_distribution<float> d(a,b); return d(g_rng);} 
-int   irand(int a,int b){ std::uniform_int_distribution<int> d(a,b); return d(g_rng);} 
-
-void ResetGame(){
-    g_obs.clear();
-    g_clouds.clear();
-
-    // Dino position
-    float groundY = (float)(W_HEIGHT - GROUND_H);
-    g_dino.x = 80.0f; g_dino.y = groundY - 52.0f; // standing height baseline
-    g_dino.vy = 0.0f; g_dino.onGround = true; g_dino.duck=false; g_dino.blink=0;
-
-    // Clouds
-    for(int i=0;i<6;i++){
-        g_clouds.push_back({ frand(0, (float)W_WIDTH), frand(30, 120.0f), frand(10.0f, 24.0f) });
+// trex_spawn.txt is optional, but one that is there and doesn't parse
+// must not be ignored quietly: the error goes to trex_spawn.log and into
+// g_spawnError, shown once the window is up. False: built-in table.
+std::wstring g_spawnError;
+
+bool LoadSpawnOverride(std::wstring& why){
+    const char* path = "trex_spawn.txt";
+    FILE* probe = std::fopen(path, "r");
+    if(!probe) return false;
+    std::fclose(probe);
+    FILE* log = std::fopen("trex_spawn.log", "w+");
+    bool ok = LoadSpawnTable(path, g_spawnFile, log);
+    if(!ok){
+        char msg[256] = "";
+        if(log){ std::rewind(log); if(!std::fgets(msg, sizeof(msg), log)) msg[0] = '\0'; }
+        why = L"trex_spawn.txt was not loaded; the built-in obstacle table is used.\n\n";
+        for(const char* c = msg; *c; c++) why += (wchar_t)(unsigned char)*c;
     }
-
-    g_worldSpd = BASE_SPD;
-    g_spawnGapMin = 0.85f; g_spawnGapMax = 1.85f;
-    g_spawnTimer = 0.0f; g_nextSpawnIn = frand(g_spawnGapMin, g_spawnGapMax);
-    g_score = 0;
+    if(log){ std::fclose(log); if(ok) std::remove("trex_spawn.log"); }
+    return ok;
 }
 
-// Obstacle factory
-Obstacle MakeObstacle(){
-    float groundY = (float)(W_HEIGHT - GROUND_H);
-    ObType t;
-    // Weighted selection; birds unlock at higher scores
-    int roll = irand(0, 99);
-    if(g_score < 200){
-        // early: mostly cacti
-        if(roll < 50) t = ObType::CactusSmall;
-        else if(roll < 85) t = ObType::CactusLarge;
-        else t = ObType::CactusDouble;
-    } else {
-        if(roll < 30) t = ObType::CactusSmall;
-        else if(roll < 55) t = ObType::CactusLarge;
-        else if(roll < 70) t = ObType::CactusDouble;
-        else if(roll < 85) t = ObType::BirdLow;
-        else if(roll < 95) t = ObType::BirdHigh;
-        else t = ObType::Boulder;
-    }
-
-    Obstacle o; o.type = t; o.speed = g_worldSpd; o.anim=0; o.x = (float)W_WIDTH + frand(0, 40);
-    switch(t){
-        case ObType::CactusSmall:
-            o.w=22; o.h=42; o.y = groundY - o.h; break;
-        case ObType::CactusLarge:
-            o.w=34; o.h=72; o.y = groundY - o.h; break;
-        case ObType::CactusDouble:
-            o.w=52; o.h=46; o.y = groundY - o.h; break;
-        case ObType::BirdLow:
-            o.w=44; o.h=26; o.y = groundY - 24.0f - o.h; break; // knee height
-        case ObType::BirdHigh:
-            o.w=44; o.h=26; o.y = groundY - 88.0f - o.h; break; // head height
-        case ObType::Boulder:
-            o.w=32; o.h=32; o.y = groundY - o.h; o.speed = g_worldSpd * 1.18f; break;
+// ---------------- Race mode --------------------------
+// --race replaces the sim thread with a RaceLink on the UI thread: each
+// timer tick runs the frames the pacer hands out, rolling back when a
+// late remote input contradicts its guess. Both dinos are simulated
+// here; g_view shows ours, g_rival theirs. Races don't touch the score
+// files.
+RaceConfig  g_raceCfg;             // player -1: no race
+std::unique_ptr<RaceLink> g_race;
+World       g_rival;
+RaceView    g_raceView;
+bool        g_raceJump = false;    // pressed since the last frame ran
+bool        g_raceDuck = false;    // held
+std::wstring g_raceError;
+
+// T-Rex.exe [--race 0|1 --port P --peer-port Q [--host H] [--seed S] [--delay D]]
+bool ParseCommandLine(int argc, char** argv, RaceConfig& c){
+    for(int i=1;i<argc;i++){
+        if(!std::strcmp(argv[i], "--race") && i + 1 < argc) c.player = std::atoi(argv[++i]);
+        else if(!ParseRaceArg(argc, argv, i, c)) return false;
     }
-    return o;
+    return c.player < 0 || RaceConfigValid(c);
 }
 
-// ----------------- Rendering helpers -----------------
-void FillRectF(HDC dc, const RectF&r, COLORREF c){
-    HBRUSH br = CreateSolidBrush(c);
-    RECT rr{ (int)r.x, (int)r.y, (int)(r.x+r.w), (int)(r.y+r.h) };
-    FillRect(dc, &rr, br);
-    DeleteObject(br);
+// Our input for the next frame: a jump counts once, duck while held
+uint8_t RaceKeys(const World&){
+    uint8_t in = (uint8_t)((g_raceJump ? RB_JUMP : 0) | (g_raceDuck ? RB_DUCK : 0));
+    g_raceJump = false;
+    return in;
 }
 
-void DrawGround(HDC dc){
-    RECT r{0, W_HEIGHT - GROUND_H, W_WIDTH, W_HEIGHT};
-    HBRUSH br=CreateSolidBrush(COL_GROUND);
-    FillRect(dc,&r,br); DeleteObject(br);
+// Nothing runs until the peer is heard from (packets still go out), so
+// the side started first doesn't play its first frames alone. Returns
+// the frames advanced.
+uint64_t RaceFrame(){
+    int steps = g_pacer.Advance();
+    int moved = g_race->Pump(g_race->Waiting() ? 0 : steps, UINT32_MAX, RaceKeys);
+    const RollbackSession& s = g_race->Session();
+    g_view = s.State().p[s.LocalPlayer()];
+    g_rival = s.State().p[1 - s.LocalPlayer()];
+    g_raceView.rival = &g_rival;
+    g_raceView.waiting = g_race->Waiting();
+    if(!moved) return 0;
+    g_fx.Observe(g_view);
+    for(int i=0;i<moved;i++) g_fx.Update(DT);
+    return (uint64_t)moved;
 }
 
-void DrawDino(HDC dc){
-    RectF b = g_dino.bbox();
-    // Body
-    FillRectF(dc, RectF{ b.x, b.y, b.w, b.h }, COL_DINO);
-    // Head/neck simple shape when standing
-    if(!g_dino.duck){
-        FillRectF(dc, RectF{ b.x + b.w - 10, b.y - 16, 14, 16 }, COL_DINO);
-        // eye
-        RECT e{ (int)(b.x + b.w - 4), (int)(b.y - 10), (int)(b.x + b.w - 1), (int)(b.y - 7) };
-        HBRUSH br = CreateSolidBrush(RGB(255,255,255)); FillRect(dc,&e,br); DeleteObject(br);
-    }
-    if(g_dino.blink>0){ // hit flash overlay
-        HBRUSH br=CreateSolidBrush(RGB(255,0,0));
-        RECT rr{ (int)b.x-2,(int)b.y-2,(int)(b.x+b.w+2),(int)(b.y+b.h+2)};
-        FrameRect(dc,&rr,br); DeleteObject(br);
-    }
-}
+const RaceView* CurrentRace(){ return g_race ? &g_raceView : nullptr; }
 
-void DrawCactus(HDC dc, const Obstacle&o){ FillRectF(dc, RectF{o.x,o.y,o.w,o.h}, COL_OBS); }
-
-void DrawBird(HDC dc, const Obstacle&o){
-    // body
-    FillRectF(dc, RectF{o.x, o.y + 6, o.w, o.h - 12}, COL_BIRD);
-    // wings animate up/down
-    int wing = (o.anim / 8) % 2; // toggle every few frames
-    if(wing==0){ // wings up
-        RECT w1{ (int)o.x, (int)o.y, (int)(o.x+o.w/2), (int)(o.y+6)};
-        RECT w2{ (int)(o.x+o.w/2), (int)o.y, (int)(o.x+o.w), (int)(o.y+6)};
-        HBRUSH br=CreateSolidBrush(COL_BIRD); FillRect(dc,&w1,br); FillRect(dc,&w2,br); DeleteObject(br);
-    } else { // wings down
-        RECT w1{ (int)o.x, (int)(o.y+o.h-6), (int)(o.x+o.w/2), (int)(o.y+o.h)};
-        RECT w2{ (int)(o.x+o.w/2), (int)(o.y+o.h-6), (int)(o.x+o.w), (int)(o.y+o.h)};
-        HBRUSH br=CreateSolidBrush(COL_BIRD); FillRect(dc,&w1,br); FillRect(dc,&w2,br); DeleteObject(br);
-    }
+// Input goes to whichever game is running
+void OnJump(){
+    if(g_race) g_raceJump = true;
+    else g_sim.Post(SimInputKind::Jump);
 }
-
-void DrawBoulder(HDC dc, const Obstacle&o){
-    // Approximate circle with rectangle + frame to stand out
-    FillRectF(dc, RectF{o.x, o.y, o.w, o.h}, COL_OBS);
-    HBRUSH br=CreateSolidBrush(RGB(200,200,200));
-    RECT r{ (int)o.x, (int)o.y, (int)(o.x+o.w), (int)(o.y+o.h) }; FrameRect(dc,&r,br); DeleteObject(br);
+void OnDuck(bool down){
+    if(g_race) g_raceDuck = down;
+    else g_sim.Post(down ? SimInputKind::DuckDown : SimInputKind::DuckUp);
 }
 
-void DrawCloud(HDC dc, const Cloud&c){
-    HBRUSH br = CreateSolidBrush(RGB(200,200,200));
-    RECT r1{ (int)c.x, (int)c.y, (int)(c.x+38), (int)(c.y+18) };
-    RECT r2{ (int)(c.x+16), (int)(c.y-8), (int)(c.x+56), (int)(c.y+12) };
-    RECT r3{ (int)(c.x+30), (int)(c.y+4), (int)(c.x+76), (int)(c.y+22) };
-    FillRect(dc,&r1,br); FillRect(dc,&r2,br); FillRect(dc,&r3,br); DeleteObject(br);
+// Newest snapshot into g_view; particles follow the steps it advanced.
+// Returns that step count.
+uint64_t TakeSnapshot(){
+    const SimSnapshot& s = g_sim.Latest();
+    LoadWorld(s.world, g_view);
+    g_viewHighScore = s.highScore;
+    g_viewTop5.assign(s.top5, s.top5 + s.top5Count);
+    uint64_t steps = s.step - g_viewStep;
+    g_viewStep = s.step;
+    g_viewRun = s.run;
+    if(!steps) return 0;
+    g_fx.Observe(g_view);
+    for(uint64_t i=0;i<steps && i<PACING_MAX_STEPS;i++) g_fx.Update(DT);   // keeps going on the game-over screen
+    return steps;
 }
 
-void DrawTextSimple(HDC dc, int x, int y, const std::wstring& s, COLORREF col=COL_TEXT, int size=18, bool bold=false){
-    LOGFONTW lf{}; lf.lfHeight = -size; lf.lfWeight = bold? FW_SEMIBOLD:FW_NORMAL; wcscpy_s(lf.lfFaceName, L"Segoe UI");
-    HFONT f=CreateFontIndirectW(&lf); HFONT old=(HFONT)SelectObject(dc,f);
-    SetTextColor(dc, col); SetBkMode(dc, TRANSPARENT);
-    TextOutW(dc, x, y, s.c_str(), (int)s.size());
-    SelectObject(dc,old); DeleteObject(f);
+// ----------------- GDI backend -----------------------
+// Brushes and fonts are created the first time a color / size+weight is
+// drawn and kept until the window goes away, so a steady-state frame
+// creates no GDI objects.
+static HBRUSH NewBrush(uint64_t key){ return CreateSolidBrush((COLORREF)key); }
+static HFONT  NewFont(uint64_t key){
+    LOGFONTW lf{}; lf.lfHeight = -(LONG)(key >> 1); lf.lfWeight = (key & 1) ? FW_SEMIBOLD : FW_NORMAL;
+    wcscpy_s(lf.lfFaceName, L"Segoe UI");
+    return CreateFontIndirectW(&lf);
 }
-
-// --------------- Game update & logic -----------------
-void SpawnIfNeeded(float dt){
-    g_spawnTimer += dt;
-    if(g_spawnTimer >= g_nextSpawnIn){
-        g_spawnTimer = 0.0f;
-        g_nextSpawnIn = frand(g_spawnGapMin, g_spawnGapMax);
-        // Prevent unfair overlaps: ensure last obstacle is far enough
-        if(g_obs.empty() || (W_WIDTH - g_obs.back().x) > 40.0f){
-            g_obs.push_back(MakeObstacle());
+static void DropBrush(HBRUSH h){ DeleteObject(h); }
+static void DropFont(HFONT h){ DeleteObject(h); }
+
+class GdiBackend : public DrawBackend {
+public:
+    GdiBackend() : brushes_(NewBrush, DropBrush), fonts_(NewFont, DropFont) {}
+
+    void Bind(HDC dc){ dc_ = dc; }
+    // Colors are drawn through `lut` (day/night); null draws them as is
+    void SetLut(const PaletteLut* lut){ lut_ = lut; }
+    void BeginFrame() override {
+        oldFont_ = nullptr; curFont_ = nullptr;
+        SetBkMode(dc_, TRANSPARENT);
+    }
+    void FillRect(int l, int t, int r, int b, Color c) override {
+        RECT rr{ l, t, r, b }; ::FillRect(dc_, &rr, brushes_.Get(BrushKey(Map(c))));
+    }
+    void FrameRect(int l, int t, int r, int b, Color c) override {
+        RECT rr{ l, t, r, b }; ::FrameRect(dc_, &rr, brushes_.Get(BrushKey(Map(c))));
+    }
+    void Text(int x, int y, const wchar_t* s, int len, Color c, int size, bool bold) override {
+        HFONT f = fonts_.Get(FontKey(size, bold));
+        if(f != curFont_){
+            HFONT prev = (HFONT)SelectObject(dc_, f);
+            if(!oldFont_) oldFont_ = prev;
+            curFont_ = f;
         }
+        SetTextColor(dc_, Map(c));
+        TextOutW(dc_, x, y, s, len);
     }
-}
-
-void UpdateGame(float dt){
-    float groundY = (float)(W_HEIGHT - GROUND_H);
-
-    // Difficulty ramp: every 100 score, speed increases, spawn gap shrinks
-    float tSpeed = BASE_SPD + std::min(280.0f, (float)g_score * 0.8f);
-    g_worldSpd = tSpeed;
-    g_spawnGapMin = std::max(0.55f, 0.85f - (float)g_score * 0.0009f);
-    g_spawnGapMax = std::max(0.95f, 1.85f - (float)g_score * 0.0009f);
-
-    // Dino physics
-    if(!g_dino.onGround){
-        g_dino.vy += GRAVITY * dt;
-        g_dino.y  += g_dino.vy * dt;
-        if(g_dino.y >= groundY - 52.0f){
-            g_dino.y = groundY - 52.0f; g_dino.vy = 0.0f; g_dino.onGround = true;
+    void EndFrame() override {
+        if(oldFont_) SelectObject(dc_, oldFont_);   // cached font must not stay selected
+        oldFont_ = nullptr; curFont_ = nullptr;
+    }
+    // One PolyPolygon per SQUARE_BATCH squares instead of a FillRect
+    // each; with no pen the fill covers [l,r) x [t,b) like FillRect.
+    void FillSquares(const float* x, const float* y, size_t n, int size, Color c) override {
+        if(pts_.empty()){ pts_.resize(SQUARE_BATCH * 4); counts_.assign(SQUARE_BATCH, 4); }
+        HGDIOBJ oldBrush = SelectObject(dc_, brushes_.Get(BrushKey(Map(c))));
+        HGDIOBJ oldPen = SelectObject(dc_, GetStockObject(NULL_PEN));
+        for(size_t i=0;i<n;){
+            size_t m = n - i < SQUARE_BATCH ? n - i : SQUARE_BATCH;
+            for(size_t j=0;j<m;j++,i++){
+                LONG l = (LONG)x[i], t = (LONG)y[i];
+                POINT* q = &pts_[j * 4];
+                q[0] = POINT{ l, t }; q[1] = POINT{ l + size, t };
+                q[2] = POINT{ l + size, t + size }; q[3] = POINT{ l, t + size };
+            }
+            PolyPolygon(dc_, pts_.data(), counts_.data(), (int)m);
         }
+        SelectObject(dc_, oldPen);
+        SelectObject(dc_, oldBrush);
     }
-
-    // Clouds (parallax)
-    for(auto &c: g_clouds){
-        c.x -= c.speed * dt;
-        if(c.x < -80) { c.x = (float)W_WIDTH + frand(0, 140); c.y = frand(30, 130); c.speed = frand(10.0f, 24.0f);}    }
-
-    // Obstacles move & animate
-    for(auto &o: g_obs){
-        float s = (o.type==ObType::Boulder) ? o.speed : g_worldSpd;
-        o.x -= s * dt;
-        if(o.type==ObType::BirdLow || o.type==ObType::BirdHigh) o.anim++;
+    // Background strips go straight from their pixels with
+    // SetDIBitsToDevice, in two pieces where the band wraps. At night a
+    // strip is drawn from a copy remapped through the LUT, redone only
+    // when the LUT changes.
+    void Layer(const Framebuffer& strip, int x, int y, int w, int scroll) override {
+        const Framebuffer* src = &strip;
+        if(lut_){
+            LayerCopy* e = nullptr;
+            for(auto &c: layers_) if(c.strip == &strip) e = &c;
+            if(!e){ layers_.push_back(LayerCopy()); e = &layers_.back(); e->strip = &strip; }
+            if(e->mapped.w != strip.w || e->mapped.h != strip.h || std::memcmp(&e->lut, lut_, sizeof(PaletteLut))){
+                e->mapped.Resize(strip.w, strip.h);
+                e->lut = *lut_;
+                RemapRect(e->lut, strip, e->mapped, IRect{ 0, 0, strip.w, strip.h });
+            }
+            src = &e->mapped;
+        }
+        BITMAPINFO bi{};
+        bi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bi.bmiHeader.biWidth = src->w;
+        bi.bmiHeader.biHeight = -src->h;          // top-down
+        bi.bmiHeader.biPlanes = 1;
+        bi.bmiHeader.biBitCount = 32;
+        bi.bmiHeader.biCompression = BI_RGB;
+        int s = ((scroll % src->w) + src->w) % src->w;
+        for(int done=0;done<w;){
+            int n = std::min(w - done, src->w - s);
+            SetDIBitsToDevice(dc_, x + done, y, n, src->h, s, 0, 0, src->h, src->px.data(), &bi, DIB_RGB_COLORS);
+            done += n; s = 0;
+        }
     }
-    // remove offscreen
-    g_obs.erase(std::remove_if(g_obs.begin(), g_obs.end(), [](const Obstacle&o){return o.x + o.w < -8; }), g_obs.end());
-
-    // Spawn new ones
-    SpawnIfNeeded(dt);
-
-    // Score
-    g_score += (int)std::round(40.0f * dt); // tweak rate
-
-    // Collision
-    RectF dbox = g_dino.bbox();
-    for(const auto &o: g_obs){
-        RectF obox{ o.x, o.y, o.w, o.h };
-        if(Intersect(dbox, obox)){
-            g_dino.blink = 14; // flash frames
-            g_state = GameState::GAMEOVER;
-            // persist scores
-            if(g_score > g_highScore){ g_highScore = g_score; SaveHighScore(g_highScore); }
-            // update top 5
-            g_top5.push_back(g_score);
-            std::sort(g_top5.begin(), g_top5.end(), std::greater<int>());
-            if(g_top5.size()>5) g_top5.resize(5);
-            SaveTop5(g_top5);
-            AppendRunLog(g_score);
-            break;
+    // GDI has no color-keyed copy without msimg32, so a sprite is cut
+    // into same-colored rectangles the first time it is drawn and
+    // filled from those; the LUT applies to each like any FillRect.
+    void Sprite(const Framebuffer& img, int x, int y) override {
+        SpriteShape* e = nullptr;
+        for(auto &c: sprites_) if(c.img == &img) e = &c;
+        if(!e){
+            sprites_.push_back(SpriteShape());
+            e = &sprites_.back(); e->img = &img;
+            SpriteRects(img, e->rects);
         }
+        for(const auto &q: e->rects) FillRect(x + q.r.l, y + q.r.t, x + q.r.r, y + q.r.b, q.c);
     }
+    void Release(){ brushes_.Clear(); fonts_.Clear(); layers_.clear(); sprites_.clear(); }
+
+private:
+    static const size_t SQUARE_BATCH = 1024;
+
+    struct LayerCopy {
+        const Framebuffer* strip = nullptr;
+        PaletteLut  lut;
+        Framebuffer mapped;
+    };
+    struct SpriteShape {
+        const Framebuffer* img = nullptr;
+        std::vector<SpriteRect> rects;
+    };
+
+    Color Map(Color c) const { return lut_ ? lut_->MapColor(c) : c; }
+
+    HDC   dc_ = nullptr;
+    const PaletteLut* lut_ = nullptr;
+    HFONT oldFont_ = nullptr, curFont_ = nullptr;
+    std::vector<POINT> pts_;      // FillSquares scratch, sized on first use
+    std::vector<INT>   counts_;
+    ResourceCache<HBRUSH> brushes_;
+    ResourceCache<HFONT>  fonts_;
+    std::vector<LayerCopy> layers_;
+    std::vector<SpriteShape> sprites_;
+};
 
-    if(g_dino.blink>0) g_dino.blink--;
-}
+GdiBackend g_gdi;
+
+// Software renderer: the scene is recorded into g_list, diffed against
+// the previous frame, and only the damaged rectangles are rasterised
+// into g_fb and presented with SetDIBitsToDevice. g_fb always holds day
+// colors; at night the same rectangles are remapped into g_night, which
+// is presented instead.
+Framebuffer   g_fb;
+Framebuffer   g_night;
+DayNight      g_dayNight;
+// At any other window size the presented buffer is resampled into g_out
+// (client-sized, letterbox bars left black) and g_out is presented.
+Framebuffer   g_out;
+Scaler        g_scaler;
+ScaleMode     g_scaleMode = ScaleMode::Bilinear;
+int           g_clientW = W_WIDTH, g_clientH = W_HEIGHT;
+SoftBackend   g_soft(g_fb);
+DisplayList   g_list;
+DamageTracker g_damage;
+bool          g_softRender = true;
+bool          g_showStats = false;
+uint64_t      g_pixelsTouched = 0;   // last frame
+AllocCounts   g_frameAllocs;         // heap calls of the last WM_TIMER frame
+uint64_t      g_allocFrames = 0;     // PLAYING frames that allocated
+CaptureWriter g_capture;             // F6: Y4M recording of Shown()
+TelemetryWriter g_telemetry;         // trex_telemetry.<pid>, read by trex_top
 
 // ---------------------- Paint ------------------------
 void EnsureBackbuffer(){
@@ -369,122 +410,278 @@ void ReleaseBackbuffer(){
     }
 }
 
-void Render(){
-    EnsureBackbuffer();
-
-    HDC dc = g_hMemDC;
-    HBRUSH bg=CreateSolidBrush(COL_BG);
-    RECT full{0,0,W_WIDTH,W_HEIGHT}; FillRect(dc,&full,bg); DeleteObject(bg);
-
-    // Clouds
-    for(const auto &c: g_clouds) DrawCloud(dc, c);
-
-    // Ground
-    DrawGround(dc);
-
-    // Obstacles
-    for(const auto &o: g_obs){
-        switch(o.type){
-            case ObType::CactusSmall:
-            case ObType::CactusLarge:
-            case ObType::CactusDouble: DrawCactus(dc,o); break;
-            case ObType::BirdLow:
-            case ObType::BirdHigh:     DrawBird(dc,o);   break;
-            case ObType::Boulder:      DrawBoulder(dc,o);break;
-        }
-    }
+bool NativeSize(){ return g_clientW == W_WIDTH && g_clientH == W_HEIGHT; }
+
+// The logical-size buffer holding the finished frame
+const Framebuffer& Shown(){ return g_dayNight.IsDay() ? g_fb : g_night; }
+
+// Copies rectangle r of fb to the window at the same position. The DIB
+// header describes only the rows of r (stride = full width), which
+// sidesteps the bottom-up ySrc rules of SetDIBitsToDevice.
+void PresentRect(HDC hdc, const Framebuffer& fb, const IRect& r){
+    if(r.Empty()) return;
+    BITMAPINFO bi{};
+    bi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bi.bmiHeader.biWidth = fb.w;
+    bi.bmiHeader.biHeight = -(r.b - r.t);     // top-down rows
+    bi.bmiHeader.biPlanes = 1;
+    bi.bmiHeader.biBitCount = 32;
+    bi.bmiHeader.biCompression = BI_RGB;
+    SetDIBitsToDevice(hdc, r.l, r.t, r.r - r.l, r.b - r.t, r.l, 0, 0, r.b - r.t,
+                      fb.Row(r.t), &bi, DIB_RGB_COLORS);
+}
 
-    // Dino
-    DrawDino(dc);
+void UpdateStatsTitle(){
+    static int frame = 0;
+    if(!g_showStats || (++frame % 30) != 0) return;
+    HistSummary iv = g_pacer.Stats().interval.Summary();
+    HistSummary rc = g_pacer.Stats().render.Summary();
+    const SimStats& ss = g_sim.Stats();
+    wchar_t buf[320];
+    int n = swprintf(buf, 320, L"T‑Rex — %llu px repainted (%.1f%%) — frame p99 %.1f ms, render p99 %.2f ms — sim %llu late, worst %.1f ms",
+                     (unsigned long long)g_pixelsTouched, 100.0 * (double)g_pixelsTouched / (W_WIDTH * W_HEIGHT),
+                     iv.p99 / 1000.0, rc.p99 / 1000.0,
+                     (unsigned long long)ss.late.load(), ss.maxLateUs.load() / 1000.0);
+    if(g_capture.Active() && n > 0 && n < 320)
+        n += swprintf(buf + n, 320 - n, L" — recording, %llu frames, %llu dropped",
+                      (unsigned long long)g_capture.Stats().written.load(), (unsigned long long)g_capture.Stats().dropped.load());
+    if(AllocTracking() && n > 0 && n < 320)
+        swprintf(buf + n, 320 - n, L" — %llu heap calls last frame, %llu frames / %llu steps allocated",
+                 (unsigned long long)g_frameAllocs.Calls(), (unsigned long long)g_allocFrames,
+                 (unsigned long long)ss.allocSteps.load());
+    SetWindowTextW(g_hWnd, buf);
+}
 
-    // UI text
-    std::wstringstream ss; ss<<L"Score: "<<g_score<<L"    High: "<<g_highScore;
-    DrawTextSimple(dc, W_WIDTH-300, 14, ss.str(), COL_UI, 18, true);
+void ExportPacing(){
+    FILE* f = std::fopen("trex_pacing.csv", "w");
+    if(!f) return;
+    // the steps come from the sim thread, which keeps its own lateness
+    const SimStats& ss = g_sim.Stats();
+    std::fprintf(f, "# sim steps %llu, late %llu (worst %.2f ms), re-bases %llu\n",
+                 (unsigned long long)ss.steps.load(), (unsigned long long)ss.late.load(),
+                 ss.maxLateUs.load() / 1000.0, (unsigned long long)ss.resyncs.load());
+    g_pacer.Stats().Export(f);
+    std::fclose(f);
+}
 
-    if(g_state==GameState::MENU){
-        DrawTextSimple(dc, 26, 18, L"T‑Rex — Win32 Edition", COL_TEXT, 28, true);
-        DrawTextSimple(dc, 26, 52, L"SPACE/UP or Left‑Click: Jump    DOWN: Duck    R: Restart", COL_TEXT, 18, false);
-        DrawTextSimple(dc, 26, 78, L"Press SPACE to start", RGB(0,0,0), 22, true);
+void ToggleCapture(){
+    if(g_capture.Active()){
+        g_capture.Stop();
+        SetWindowTextW(g_hWnd, WINDOW_TITLE);
+        return;
+    }
+    char path[64];
+    std::time_t now = std::time(nullptr);
+    std::tm tm{};
+    localtime_s(&tm, &now);
+    std::strftime(path, sizeof(path), "trex_capture_%Y%m%d_%H%M%S.y4m", &tm);
+    if(g_capture.Start(path, W_WIDTH, W_HEIGHT, FPS))
+        SetWindowTextW(g_hWnd, L"T‑Rex — recording (F6 to stop)");
+}
 
-        DrawTextSimple(dc, 26, 118, L"Top 5:", COL_TEXT, 18, true);
-        for(size_t i=0;i<g_top5.size();++i){
-            std::wstringstream s2; s2<< (i+1) << L". "<< g_top5[i];
-            DrawTextSimple(dc, 26, 140+(int)i*20, s2.str(), COL_TEXT, 18, false);
+void Render(){
+    bool relit = g_dayNight.Update(g_view.score);
+    if(g_softRender){
+        const IRect screen{ 0, 0, W_WIDTH, W_HEIGHT };
+        if(g_fb.w != W_WIDTH || g_fb.h != W_HEIGHT){ g_fb.Resize(W_WIDTH, W_HEIGHT); g_damage.Invalidate(); }
+        if(g_night.w != W_WIDTH || g_night.h != W_HEIGHT){ g_night.Resize(W_WIDTH, W_HEIGHT); relit = true; }
+        RenderScene(g_list, g_view, g_viewHighScore, g_viewTop5, &g_fx, CurrentRace());
+        const std::vector<IRect>& dmg = g_damage.Update(g_list, screen);
+        g_soft.ResetPixels();
+        for(const auto &r: dmg){ g_soft.SetClip(r); g_list.Replay(g_soft, r); }
+        g_soft.ResetClip();
+        g_pixelsTouched = g_soft.Pixels();
+        // a new fade step remaps and presents the whole frame once
+        if(!g_dayNight.IsDay()){
+            if(relit) RemapRect(g_dayNight.Lut(), g_fb, g_night, screen);
+            else for(const auto &r: dmg) RemapRect(g_dayNight.Lut(), g_fb, g_night, r);
         }
-    }
-    else if(g_state==GameState::GAMEOVER){
-        DrawTextSimple(dc, 26, 18, L"Game Over", RGB(200,0,0), 30, true);
-        DrawTextSimple(dc, 26, 54, L"Press R to retry", COL_TEXT, 20, false);
-        std::wstringstream s3; s3<<L"Run: "<<g_score<<L"    High: "<<g_highScore; 
-        DrawTextSimple(dc, 26, 82, s3.str(), COL_TEXT, 20, true);
-
-        DrawTextSimple(dc, 26, 118, L"Top 5:", COL_TEXT, 18, true);
-        for(size_t i=0;i<g_top5.size();++i){
-            std::wstringstream s2; s2<< (i+1) << L". "<< g_top5[i];
-            DrawTextSimple(dc, 26, 140+(int)i*20, s2.str(), COL_TEXT, 18, false);
+        if(NativeSize()){
+            if(relit || !dmg.empty()){
+                HDC hdc = GetDC(g_hWnd);
+                if(relit) PresentRect(hdc, Shown(), screen);
+                else for(const auto &r: dmg) PresentRect(hdc, Shown(), r);
+                ReleaseDC(g_hWnd, hdc);
+            }
+        } else {
+            // only the output under each damaged rectangle is resampled
+            bool relayout = !g_scaler.Matches(W_WIDTH, W_HEIGHT, g_clientW, g_clientH, g_scaleMode);
+            if(relayout){
+                g_out.Resize(g_clientW, g_clientH);
+                g_scaler.Configure(W_WIDTH, W_HEIGHT, g_clientW, g_clientH, g_scaleMode);
+            }
+            if(relayout || relit || !dmg.empty()){
+                HDC hdc = GetDC(g_hWnd);
+                if(relayout || relit){
+                    g_scaler.Run(Shown(), g_out, screen);
+                    PresentRect(hdc, g_out, IRect{ 0, 0, g_out.w, g_out.h });
+                }
+                else for(const auto &r: dmg) PresentRect(hdc, g_out, g_scaler.Run(Shown(), g_out, r));
+                ReleaseDC(g_hWnd, hdc);
+            }
         }
-        // subtle hint if new high
-        if(g_score==g_highScore){ DrawTextSimple(dc, 26, 140+(int)g_top5.size()*20 + 8, L"NEW HIGH SCORE!", COL_UI, 20, true);}        
+        UpdateStatsTitle();
+        return;
     }
 
-    // Blit to screen
+    EnsureBackbuffer();
+
+    HDC dc = g_hMemDC;
+    g_gdi.Bind(dc);
+    g_gdi.SetLut(g_dayNight.IsDay() ? nullptr : &g_dayNight.Lut());
+    RenderScene(g_gdi, g_view, g_viewHighScore, g_viewTop5, &g_fx, CurrentRace());
+
+    // Blit to screen; GDI stretches it when the window isn't 900x360
     HDC hdc = GetDC(g_hWnd);
-    BitBlt(hdc, 0,0, W_WIDTH,W_HEIGHT, dc, 0,0, SRCCOPY);
+    if(NativeSize()) BitBlt(hdc, 0,0, W_WIDTH,W_HEIGHT, dc, 0,0, SRCCOPY);
+    else {
+        IRect d = FitRect(W_WIDTH, W_HEIGHT, g_clientW, g_clientH, g_scaleMode);
+        PatBlt(hdc, 0, 0, g_clientW, d.t, BLACKNESS);
+        PatBlt(hdc, 0, d.b, g_clientW, g_clientH - d.b, BLACKNESS);
+        PatBlt(hdc, 0, d.t, d.l, d.b - d.t, BLACKNESS);
+        PatBlt(hdc, d.r, d.t, g_clientW - d.r, d.b - d.t, BLACKNESS);
+        SetStretchBltMode(hdc, g_scaleMode == ScaleMode::Nearest ? COLORONCOLOR : HALFTONE);
+        StretchBlt(hdc, d.l, d.t, d.r - d.l, d.b - d.t, dc, 0, 0, W_WIDTH, W_HEIGHT, SRCCOPY);
+    }
     ReleaseDC(g_hWnd, hdc);
 }
 
-// -------------------- Input --------------------------
-void DoJump(){
-    if(g_state==GameState::MENU){ g_state=GameState::PLAYING; }
-    if(g_state==GameState::PLAYING && g_dino.onGround){
-        g_dino.onGround=false; g_dino.vy = -JUMP_VEL;
+// ---------------- Telemetry --------------------------
+// One seqlocked publish per frame. Percentiles scan the pacing
+// histograms, so they are refreshed twice a second, not every frame.
+uint64_t    g_frames = 0;
+uint64_t    g_fpsFrames = 0, g_fpsSince = 0;
+float       g_fps = 0.0f;
+HistSummary g_telemIv = {}, g_telemRc = {};
+
+void PublishTelemetry(){
+    g_frames++;
+    uint64_t now = g_clock.Now(), f = g_clock.Frequency();
+    if(!g_fpsSince) g_fpsSince = now;
+    if(now - g_fpsSince >= f){
+        g_fps = (float)((double)(g_frames - g_fpsFrames) * (double)f / (double)(now - g_fpsSince));
+        g_fpsFrames = g_frames; g_fpsSince = now;
     }
-}
-
-void SetDuck(bool down){
-    if(g_state==GameState::PLAYING){ g_dino.duck = down && g_dino.onGround; }
+    if(!g_telemetry.IsOpen()) return;
+    if(g_frames % (FPS / 2) == 1){
+        g_telemIv = g_pacer.Stats().interval.Summary();
+        g_telemRc = g_pacer.Stats().render.Summary();
+    }
+    const SimStats& ss = g_sim.Stats();
+    TelemetrySample t = {};
+    t.updatedNs   = TelemetryNowNs();
+    t.frames      = g_frames;
+    t.simSteps    = ss.steps.load(std::memory_order_relaxed);
+    t.lateSteps   = ss.late.load(std::memory_order_relaxed);
+    t.runs        = g_viewRun;
+    t.state       = (int32_t)g_view.state;
+    t.score       = g_view.score;
+    t.highScore   = g_viewHighScore;
+    t.obstacles   = (uint32_t)g_view.obs.size();
+    t.particles   = (uint32_t)g_fx.Live();
+    t.allocFrames = (uint32_t)g_allocFrames;
+    t.fps         = g_fps;
+    t.frameP50Ms  = g_telemIv.p50 / 1000.0f;
+    t.frameP99Ms  = g_telemIv.p99 / 1000.0f;
+    t.frameMaxMs  = g_telemIv.max / 1000.0f;
+    t.renderP99Ms = g_telemRc.p99 / 1000.0f;
+    t.flags = (g_softRender ? TELEM_SOFT_RENDER : 0) |
+              (g_capture.Active() ? TELEM_CAPTURING : 0) |
+              (g_dayNight.IsDay() ? 0 : TELEM_NIGHT);
+    g_telemetry.Publish(t);
 }
 
 // -------------------- Window proc --------------------
 LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam){
     switch(msg){
     case WM_CREATE:
-        QueryPerformanceFrequency(&g_freq); QueryPerformanceCounter(&g_prev);
+        g_pacer.Reset();
         SetTimer(hWnd, 1, 1000/FPS, NULL);
-        g_highScore = LoadHighScore();
-        g_top5 = LoadTop5();
-        ResetGame();
+        g_soft.Glyphs().Prebuild(SCENE_FONTS, SCENE_FONT_COUNT);
+        g_viewTop5.reserve(5);
+        if(g_raceCfg.player >= 0){
+            g_race.reset(new RaceLink(g_clock));
+            if(!g_race->Open(g_raceCfg)){
+                g_race.reset();
+                g_raceError = L"UDP port " + std::to_wstring(g_raceCfg.port) + L" could not be opened; playing solo instead.";
+            }
+        }
+        if(g_race) RaceFrame();     // the built-in obstacle table on both sides
+        else {
+            SimSetup setup;
+            ScoreFiles files;
+            setup.highScore = LoadHighScore(files.highScore);
+            setup.top5 = LoadTop5(files.top5);
+            setup.seed = NewRunSeed();
+            setup.scores = &g_scores;
+            if(LoadSpawnOverride(g_spawnError)) setup.spawn = &g_spawnFile;
+            g_scores.Start(setup.highScore, setup.top5);
+            g_sim.Start(setup);
+            TakeSnapshot();
+        }
+        g_telemetry.Open(TelemetryName(CurrentPid()));   // optional: no monitor, no loss
         return 0;
     case WM_TIMER: {
-        LARGE_INTEGER now; QueryPerformanceCounter(&now);
-        double dt = double(now.QuadPart - g_prev.QuadPart) / double(g_freq.QuadPart);
-        g_prev = now;
-        // clamp dt to avoid huge jumps
-        if(dt > 0.08) dt = 0.08;
-        // fixed‑step: accumulate in steps of DT
-        static double acc=0.0; acc += dt;
-        while(acc >= DT){
-            if(g_state==GameState::PLAYING) UpdateGame((float)DT);
-            acc -= DT;
-        }
+        // draw whatever the sim thread published last; it keeps its own
+        // time. A race runs its frames right here instead.
+        AllocScope frameAllocs;
+        uint64_t steps;
+        if(g_race) steps = RaceFrame();   // runs its frames here, timed by the pacer
+        else { steps = TakeSnapshot(); g_pacer.Mark(steps); }   // interval + steps this frame showed
+        g_pacer.RenderStart();
         Render();
+        g_pacer.RenderEnd();
+        // one video frame per sim step, so the file runs at game speed
+        if(g_capture.Active() && g_softRender && steps)
+            g_capture.Submit(Shown(), (uint32_t)std::min<uint64_t>(steps, FPS));
+        g_frameAllocs = frameAllocs.Delta();
+        if(g_frameAllocs.Calls() && g_view.state==GameState::PLAYING) g_allocFrames++;
+        PublishTelemetry();
         return 0; }
-    case WM_LBUTTONDOWN: DoJump(); return 0;
+    case WM_LBUTTONDOWN: OnJump(); return 0;
     case WM_KEYDOWN:
-        if(wParam==VK_SPACE || wParam==VK_UP) DoJump();
-        else if(wParam==VK_DOWN) SetDuck(true);
-        else if(wParam=='R') { g_state=GameState::PLAYING; ResetGame(); }
+        if(wParam==VK_SPACE || wParam==VK_UP) OnJump();
+        else if(wParam==VK_DOWN) OnDuck(true);
+        else if(wParam=='R'){ if(!g_race) g_sim.Post(SimInputKind::Restart, NewRunSeed()); }
+        else if(wParam==VK_F2) { g_softRender = !g_softRender; g_damage.Invalidate(); Render(); }
+        else if(wParam==VK_F3) { g_showStats = !g_showStats; if(!g_showStats) SetWindowTextW(hWnd, WINDOW_TITLE); }
+        else if(wParam==VK_F4) ExportPacing();
+        else if(wParam==VK_F6) ToggleCapture();
+        else if(wParam==VK_F5) {
+            g_scaleMode = g_scaleMode == ScaleMode::Bilinear ? ScaleMode::Nearest : ScaleMode::Bilinear;
+            Render();
+        }
         else if(wParam==VK_ESCAPE) DestroyWindow(hWnd);
         return 0;
     case WM_KEYUP:
-        if(wParam==VK_DOWN) SetDuck(false);
+        if(wParam==VK_DOWN) OnDuck(false);
         return 0;
+    case WM_PAINT: {
+        // Uncovered window areas: the presented buffer always holds the
+        // whole last frame
+        PAINTSTRUCT ps; HDC hdc = BeginPaint(hWnd, &ps);
+        if(g_softRender && g_fb.w == W_WIDTH){
+            if(NativeSize()) PresentRect(hdc, Shown(), IRect{ 0, 0, W_WIDTH, W_HEIGHT });
+            else if(g_out.w == g_clientW && g_out.h == g_clientH) PresentRect(hdc, g_out, IRect{ 0, 0, g_out.w, g_out.h });
+        }
+        EndPaint(hWnd, &ps);
+        if(!g_softRender) Render();
+        return 0; }
     case WM_SIZE:
+        if(wParam == SIZE_MINIMIZED || !LOWORD(lParam) || !HIWORD(lParam)) return 0;
+        g_clientW = LOWORD(lParam); g_clientH = HIWORD(lParam);
+        g_damage.Invalidate();
         Render();
         return 0;
     case WM_DESTROY:
         KillTimer(hWnd,1);
         ReleaseBackbuffer();
+        g_gdi.Release();
+        g_race.reset();             // closes the socket
+        g_sim.Stop();               // no more game overs after this
+        g_capture.Stop();           // writes the frames still queued
+        g_telemetry.Close();
+        g_scores.Stop();            // flush queued scores before exit
         PostQuitMessage(0);
         return 0;
     }
@@ -494,18 +691,32 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam){
 // --------------------- WinMain -----------------------
 int APIENTRY WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int){
     g_hInst = hInst;
+    if(!ParseCommandLine(__argc, __argv, g_raceCfg)){
+        MessageBoxW(NULL, L"usage: T-Rex.exe [--race 0|1 --port P --peer-port Q [--host H] [--seed S] [--delay D]]",
+                    L"T-Rex", MB_OK | MB_ICONWARNING);
+        return 2;
+    }
 
     WNDCLASSW wc{}; wc.style = CS_HREDRAW|CS_VREDRAW; wc.lpfnWndProc=WndProc; wc.hInstance=hInst;
     wc.hCursor=LoadCursor(NULL, IDC_ARROW); wc.hbrBackground=(HBRUSH)(COLOR_WINDOW+1); wc.lpszClassName=L"TRexWin32";
     RegisterClassW(&wc);
 
-    DWORD style = WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU | WS_MINIMIZEBOX;
+    DWORD style = WS_OVERLAPPEDWINDOW;       // resizable; the scaler fits the frame
     RECT r{0,0,W_WIDTH,W_HEIGHT}; AdjustWindowRect(&r, style, FALSE);
-    g_hWnd = CreateWindowW(L"TRexWin32", L"T‑Rex — Win32 (C++/GDI)", style,
+    g_hWnd = CreateWindowW(L"TRexWin32", WINDOW_TITLE, style,
                            CW_USEDEFAULT, CW_USEDEFAULT,
                            r.right - r.left, r.bottom - r.top,
                            NULL, NULL, hInst, NULL);
     ShowWindow(g_hWnd, SW_SHOW); UpdateWindow(g_hWnd);
+    if(g_race){
+        wchar_t title[96];
+        swprintf(title, 96, L"T‑Rex — race, player %d (UDP %u)", g_raceCfg.player + 1, (unsigned)g_raceCfg.port);
+        SetWindowTextW(g_hWnd, title);
+    }
+    if(!g_raceError.empty())
+        MessageBoxW(g_hWnd, g_raceError.c_str(), L"T-Rex: race not started", MB_OK | MB_ICONWARNING);
+    if(!g_spawnError.empty())
+        MessageBoxW(g_hWnd, g_spawnError.c_str(), L"T-Rex: trex_spawn.txt ignored", MB_OK | MB_ICONWARNING);
 
     // message loop
     MSG msg; while(GetMessageW(&msg, NULL, 0,0)) { TranslateMessage(&msg); DispatchMessageW(&msg);}    
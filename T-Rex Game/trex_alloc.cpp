@@ -0,0 +1,68 @@
+// ------------------------------------------------------------------
+// File: trex_alloc.cpp
+// Counting replacements for operator new/delete (and malloc on glibc)
+// ------------------------------------------------------------------
+#include "trex_alloc.h"
+#include <cstdlib>
+#include <new>
+
+#if defined(TREX_TRACK_ALLOC)
+
+// Plain thread_local PODs: no constructor runs, so they are safe to touch
+// from inside malloc itself.
+static thread_local uint64_t t_news, t_mallocs, t_bytes;
+
+bool AllocTracking(){ return true; }
+
+AllocCounts ThreadAllocs(){
+    AllocCounts c;
+    c.news = t_news; c.mallocs = t_mallocs; c.bytes = t_bytes;
+    return c;
+}
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t n);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t n);
+
+void* malloc(size_t n){ t_mallocs++; t_bytes += n; return __libc_malloc(n); }
+void* calloc(size_t n, size_t size){ t_mallocs++; t_bytes += n * size; return __libc_calloc(n, size); }
+void* realloc(void* p, size_t n){ t_mallocs++; t_bytes += n; return __libc_realloc(p, n); }
+}
+static void* RawAlloc(size_t n){ return __libc_malloc(n); }
+#else
+static void* RawAlloc(size_t n){ return std::malloc(n); }
+#endif
+
+static void* CountedNew(size_t n){
+    t_news++; t_bytes += n;
+    return RawAlloc(n ? n : 1);
+}
+
+void* operator new(size_t n){
+    void* p = CountedNew(n);
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t n){
+    void* p = CountedNew(n);
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new(size_t n, const std::nothrow_t&) noexcept { return CountedNew(n); }
+void* operator new[](size_t n, const std::nothrow_t&) noexcept { return CountedNew(n); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+#else
+
+bool AllocTracking(){ return false; }
+AllocCounts ThreadAllocs(){ return AllocCounts(); }
+
+#endif
@@ -0,0 +1,52 @@
+// ------------------------------------------------------------------
+// File: trex_alloc.h
+// Opt-in allocation tracker: heap calls counted per thread
+// ------------------------------------------------------------------
+//  - built with -DTREX_TRACK_ALLOC, trex_alloc.cpp replaces the global
+//    operator new/delete family and, on glibc, malloc/calloc/realloc
+//    (forwarding to __libc_*), so allocations made inside the standard
+//    library count too; the MinGW build counts operator new only
+//  - without the define every call here is free and reports zeros, and
+//    AllocTracking() is false
+//  - counters are thread_local: the stream generator and score writer
+//    threads never show up in the game thread's numbers
+//  - main.cpp counts each WM_TIMER frame and SimThread each step; trex_bench
+//    alloc fails if a steady-state gameplay frame allocates at all
+// ------------------------------------------------------------------
+#ifndef TREX_ALLOC_H
+#define TREX_ALLOC_H
+
+#include <cstdint>
+
+struct AllocCounts {
+    uint64_t news = 0;        // operator new / new[]
+    uint64_t mallocs = 0;     // malloc / calloc / realloc
+    uint64_t bytes = 0;       // requested, both kinds
+
+    uint64_t Calls() const { return news + mallocs; }
+};
+
+// True if this build counts anything
+bool AllocTracking();
+
+// Running totals for the calling thread
+AllocCounts ThreadAllocs();
+
+// Heap calls made by this thread since construction / Restart()
+class AllocScope {
+public:
+    AllocScope() : start_(ThreadAllocs()) {}
+    void Restart(){ start_ = ThreadAllocs(); }
+    AllocCounts Delta() const {
+        AllocCounts now = ThreadAllocs(), d;
+        d.news = now.news - start_.news;
+        d.mallocs = now.mallocs - start_.mallocs;
+        d.bytes = now.bytes - start_.bytes;
+        return d;
+    }
+
+private:
+    AllocCounts start_;
+};
+
+#endif
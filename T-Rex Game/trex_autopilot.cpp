@@ -0,0 +1,91 @@
+// ------------------------------------------------------------------
+// File: trex_autopilot.cpp
+// Beam search autopilot
+// ------------------------------------------------------------------
+#include "trex_autopilot.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+Autopilot::Autopilot(const AutopilotConfig& cfg, TaskPool& pool) : cfg_(cfg), pool_(pool){
+    if(cfg_.width < 1) cfg_.width = 1;
+    if(cfg_.depth < 1) cfg_.depth = 1;
+    if(cfg_.step < 1) cfg_.step = 1;
+    // Worlds are copy-assigned into these slots, so after the first
+    // decision the search allocates nothing
+    cur_.resize((size_t)cfg_.width * 3);
+    next_.resize((size_t)cfg_.width * 3);
+    beam_.reserve(cfg_.width);
+    order_.reserve((size_t)cfg_.width * 3);
+}
+
+// Child i of next_: copy the parent and hold its action for `step` ticks.
+void Autopilot::Expand(size_t i){
+    Node& c = next_[i];
+    c.w = cur_[c.parent].w;
+    c.dead = false;
+    for(int k=0;k<cfg_.step;k++){
+        TickInput in{ c.act==Jump && k==0, c.act==Duck };
+        ApplyInput(c.w, in);
+        if(UpdateGame(c.w, DT)){ c.dead = true; c.deathTick = c.w.ticks; return; }
+    }
+}
+
+static bool SameDino(const Dino& a, const Dino& b){
+    return a.y==b.y && a.vy==b.vy && a.onGround==b.onGround && a.duck==b.duck;
+}
+
+TickInput Autopilot::Decide(const World& w){
+    auto t0 = std::chrono::steady_clock::now();
+    cur_[0].w = w;
+    cur_[0].first = Wait;
+    beam_.assign(1, 0);
+
+    Action best = Wait;
+    uint32_t longest = 0;
+    bool survived = true;
+    for(int level=0;level<cfg_.depth;level++){
+        // Expand
+        size_t n = 0;
+        for(int b: beam_){
+            const Node& p = cur_[b];
+            int acts = p.w.dino.onGround ? 3 : 1;
+            for(int a=0;a<acts;a++){
+                Node& c = next_[n++];
+                c.parent = b; c.act = (Action)a;
+                c.first = level == 0 ? (Action)a : p.first;
+            }
+        }
+        pool_.For(n, [this](size_t i){ Expand(i); });
+        stats_.nodes += n;
+        for(size_t i=0;i<n;i++) stats_.ticks += next_[i].w.ticks - cur_[next_[i].parent].w.ticks;
+
+        // Select: survivors, grounded first (they can still react), then
+        // child order; drop repeats of a dino state already kept
+        order_.clear();
+        for(size_t i=0;i<n;i++){
+            const Node& c = next_[i];
+            if(!c.dead){ order_.push_back((int)i); continue; }
+            if(c.deathTick > longest){ longest = c.deathTick; best = c.first; }
+        }
+        if(order_.empty()){ survived = false; break; }
+        std::stable_sort(order_.begin(), order_.end(), [this](int a, int b){
+            return next_[a].w.dino.onGround > next_[b].w.dino.onGround;
+        });
+        beam_.clear();
+        for(int i: order_){
+            bool dup = false;
+            for(int k: beam_) if(SameDino(next_[k].w.dino, next_[i].w.dino)){ dup = true; break; }
+            if(dup) continue;
+            beam_.push_back(i);
+            if((int)beam_.size() == cfg_.width) break;
+        }
+        cur_.swap(next_);
+    }
+    if(survived) best = cur_[beam_[0]].first;
+    else stats_.doomed++;
+
+    stats_.decisions++;
+    stats_.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return TickInput{ best==Jump, best==Duck };
+}
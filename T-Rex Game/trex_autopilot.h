@@ -0,0 +1,71 @@
+// ------------------------------------------------------------------
+// File: trex_autopilot.h
+// Look-ahead autopilot: beam search over forked Worlds
+// ------------------------------------------------------------------
+//  - every tick the live World is copied and played forward with the
+//    real ApplyInput/UpdateGame; a node is one copy held on an action
+//    (nothing, jump, duck) for `step` ticks
+//  - each level expands every beam node by the actions that would
+//    change anything (an airborne dino can only wait), simulates the
+//    children on a TaskPool and keeps the `width` best survivors;
+//    children with the same dino state are the same future, so only
+//    the first is kept
+//  - the tick's input is the first action of the best node after
+//    `depth` levels, or of the longest-lived branch if all of them die
+//  - deterministic for any thread count: ranking ties break on child
+//    order, never on which thread finished first
+// ------------------------------------------------------------------
+#ifndef TREX_AUTOPILOT_H
+#define TREX_AUTOPILOT_H
+
+#include "trex_sim.h"
+#include "trex_pool.h"
+#include <cstdint>
+#include <vector>
+
+struct AutopilotConfig {
+    int width = 24;           // nodes kept per level
+    int depth = 12;           // levels searched
+    int step  = 4;            // ticks per level: depth * step ticks ahead
+};
+
+struct AutopilotStats {
+    uint64_t decisions = 0;
+    uint64_t nodes = 0;       // children simulated
+    uint64_t ticks = 0;       // UpdateGame calls made by the search
+    uint64_t doomed = 0;      // decisions where every branch died
+    double   seconds = 0.0;   // wall time spent in Decide()
+};
+
+class Autopilot {
+public:
+    Autopilot(const AutopilotConfig& cfg, TaskPool& pool);
+
+    // Input for this tick of `w` (which must be PLAYING).
+    TickInput Decide(const World& w);
+
+    const AutopilotStats& Stats() const { return stats_; }
+    void ResetStats(){ stats_ = AutopilotStats(); }
+
+private:
+    enum Action : uint8_t { Wait, Jump, Duck };
+    struct Node {
+        World    w;
+        int      parent;      // index into the previous level
+        Action   act;
+        Action   first;       // root action this branch started with
+        bool     dead;
+        uint32_t deathTick;
+    };
+
+    void Expand(size_t i);
+
+    AutopilotConfig cfg_;
+    TaskPool&       pool_;
+    std::vector<Node> cur_, next_;   // 3 * width nodes each, reused
+    std::vector<int>  beam_;         // indices into cur_
+    std::vector<int>  order_;
+    AutopilotStats  stats_;
+};
+
+#endif
@@ -0,0 +1,1627 @@
+// ------------------------------------------------------------------
+// File: trex_bench.cpp
+// Headless micro-benchmarks for the T-Rex sim and renderer pieces
+// ------------------------------------------------------------------
+// Usage: trex_bench <name> [options]      (trex_bench --list)
+//   soa [--frames N]   AoS std::vector<Obstacle> vs ObstacleSoA
+//                      (move + despawn + hit test per frame)
+//   draw [--runs N]    RenderScene into the counting backend; fails if a
+//                      frame creates a brush/font after the warm-up run
+//   fb [--frames N] [--ppm FILE]
+//                      RenderScene into the software framebuffer, ns/frame
+//   damage [--runs N]  pixels touched per frame with dirty rectangles; fails
+//                      if a damage-only frame differs from a full redraw
+//                      (particles included)
+//   pacing [--frames N] [--timer-ms F] [--csv]
+//                      FramePacer on a fake clock with a jittery coarse
+//                      timer; fails if steps drift from elapsed time
+//   stress [--frames N] [--max N]
+//                      UpdateGame / RenderScene / broadphase cost as the
+//                      drawn entity count doubles; fails if grid and
+//                      all-pairs hit counts ever differ
+//   spawn [--draws N] [--table FILE]
+//                      alias-method type sampling vs a cumulative scan;
+//                      fails if any tier's frequencies stray from its
+//                      weights
+//   rollback [--frames N] [--latency F]
+//                      8-frame restore + re-simulate cost of a two-player
+//                      race, then two RollbackSessions over a lossy
+//                      in-memory link and through one-way loss bursts;
+//                      fails if p99 re-sim >= 1 ms or the peers'
+//                      checksums ever differ
+//   stream [--seeds N] [--ticks N]
+//                      validated obstacle stream: generation cost per
+//                      chunk, game-thread cost of taking chunks from the
+//                      worker, and an exhaustive survivability audit of
+//                      every seed (legacy spawner for comparison); fails
+//                      if any fed run is impossible or the worker's
+//                      stream differs from the inline one
+//   particles [--count N] [--frames N]
+//                      N live particles (default 50k): ns/particle for
+//                      Update() (SIMD and scalar) and for drawing them
+//                      into the framebuffer; fails if the kernels
+//                      disagree, a kind takes more than one draw call,
+//                      or a damage-tracked frame misses 60 fps
+//   palette [--frames N]
+//                      day/night LUT remap at 900x360 and 3840x2160
+//                      (scene and noise), SIMD vs scalar, then a score
+//                      sweep through a fade on the damage path; fails if
+//                      the kernels disagree, the vector kernel is slower
+//                      than scalar, or a swept frame differs from a full
+//                      redraw + remap
+//   scale [--frames N]
+//                      900x360 scene resampled to 1080p, 1440p and 4K,
+//                      nearest and bilinear, SIMD vs scalar, plus the
+//                      damage-only path at 4K; fails if the kernels
+//                      disagree or a damage-only frame differs from a
+//                      full rescale
+//   alloc [--frames N] [--warmup N]
+//                      the main.cpp frame (input recording, stream feed,
+//                      UpdateGame, particles, display list, damage,
+//                      raster, day/night remap, 1080p scale) with the
+//                      allocation tracker on; fails if any steady-state
+//                      gameplay frame calls operator new or malloc
+//   simthread [--seconds N]
+//                      SimThread on the steady clock while one thread
+//                      floods it with inputs and restarts and this one
+//                      reads snapshots flat out with random stalls and
+//                      busy renders; fails if a snapshot is torn or goes
+//                      backwards, an input is lost, the step count drifts
+//                      from elapsed time, or a playing step allocates
+//   capture [--frames N] [--out FILE]
+//                      BGRA -> I420 at 900x360 and 4K, SIMD vs scalar,
+//                      then a headless run recorded to a Y4M file (wait
+//                      mode) and one submitted flat out (drop mode);
+//                      fails if the kernels disagree, the file size is
+//                      off, or recording is slower than real time
+//   parallax [--frames N]
+//                      sky band as per-cloud FillRects, per-cloud sprite
+//                      blits and one layer blit as the cloud count grows,
+//                      plus a scroll sweep; fails if a wrapped blit
+//                      differs from drawing the shapes at that offset,
+//                      overlapping cloud sprites (soft blit or GDI's
+//                      rectangles) differ from the rects, or the layer
+//                      blit's cost grows with the cloud count
+//   telemetry [--seconds N] [--serve]
+//                      seqlock publish / read cost, then one writer and
+//                      two readers (own mappings) flat out on a real
+//                      segment; fails on a torn or out-of-order read.
+//                      --serve plays a headless game at 60 fps and
+//                      publishes every frame, for trex_top
+// Build (Linux): g++ -O2 -std=c++14 -march=native -o trex_bench
+//                    trex_bench.cpp trex_sim.cpp trex_soa.cpp trex_render.cpp trex_fb.cpp
+//                    trex_damage.cpp trex_glyphs.cpp trex_pacing.cpp
+//                    trex_stress.cpp trex_spawn.cpp trex_rollback.cpp trex_particles.cpp
+//                    trex_stream.cpp trex_palette.cpp trex_scale.cpp trex_replay.cpp
+//                    trex_persist.cpp trex_alloc.cpp trex_simthread.cpp trex_capture.cpp
+//                    trex_parallax.cpp trex_telemetry.cpp
+//                    -DTREX_TRACK_ALLOC -pthread
+// ------------------------------------------------------------------
+#include "trex_sim.h"
+#include "trex_soa.h"
+#include "trex_render.h"
+#include "trex_draw.h"
+#include "trex_fb.h"
+#include "trex_damage.h"
+#include "trex_pacing.h"
+#include "trex_stress.h"
+#include "trex_rollback.h"
+#include "trex_particles.h"
+#include "trex_stream.h"
+#include "trex_palette.h"
+#include "trex_scale.h"
+#include "trex_replay.h"
+#include "trex_persist.h"
+#include "trex_alloc.h"
+#include "trex_simthread.h"
+#include "trex_capture.h"
+#include "trex_parallax.h"
+#include "trex_telemetry.h"
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock BenchClock;
+
+static double SecondsSince(BenchClock::time_point t0){
+    return std::chrono::duration<double>(BenchClock::now() - t0).count();
+}
+
+// Returns the value after `flag`, or `def` when it is absent.
+static long ArgLong(int argc, char** argv, const char* flag, long def){
+    for(int i=0;i+1<argc;i++) if(!std::strcmp(argv[i], flag)) return std::strtol(argv[i+1], nullptr, 10);
+    return def;
+}
+
+static const char* ArgStr(int argc, char** argv, const char* flag, const char* def){
+    for(int i=0;i+1<argc;i++) if(!std::strcmp(argv[i], flag)) return argv[i+1];
+    return def;
+}
+
+// Plays seed 7 with the reflex policy, restarting on death, and calls
+// frame() after every step; used by the renderer benches.
+template<class F>
+static void PlayFrames(long frames, F frame){
+    World w; ResetWorld(w, 7);
+    w.state = GameState::PLAYING;
+    uint64_t run = 7;
+    for(long f=0;f<frames;f++){
+        ApplyInput(w, ReflexPolicy(w));
+        if(UpdateGame(w, DT)){ frame(w); ResetWorld(w, ++run); w.state = GameState::PLAYING; continue; }
+        frame(w);
+    }
+}
+
+// ---------------- soa --------------------------------
+// Obstacles drift over a strip wide enough to hold n of them; whatever
+// leaves on the left is respawned on the right so the count stays n.
+// The probe box sits above everything, so every sweep runs to the end.
+static const RectF SOA_PROBE{ 80.0f, -1000.0f, 44.0f, 48.0f };
+
+static void FillObstacles(size_t n, float strip, std::vector<Obstacle>& out){
+    World w; ResetWorld(w, 1234);
+    w.score = 400;                              // unlock every type
+    out.clear();
+    for(size_t i=0;i<n;i++){
+        Obstacle o = MakeObstacle(w);
+        o.x = -8.0f + strip * (float)i / (float)n;
+        out.push_back(o);
+    }
+}
+
+static double BenchAoS(size_t n, float strip, int frames, double& checksum){
+    std::vector<Obstacle> obs; FillObstacles(n, strip, obs);
+    std::vector<Obstacle> spawn(obs);
+    size_t next = 0; int hits = 0;
+    auto t0 = BenchClock::now();
+    for(int f=0;f<frames;f++){
+        for(auto &o: obs){
+            float s = (o.type==ObType::Boulder) ? o.speed : 420.0f;
+            o.x -= s * DT;
+            if(o.type==ObType::BirdLow || o.type==ObType::BirdHigh) o.anim++;
+        }
+        obs.erase(std::remove_if(obs.begin(), obs.end(), [](const Obstacle&o){return o.x + o.w < -8; }), obs.end());
+        while(obs.size() < n){ Obstacle o = spawn[next++ % n]; o.x = strip; obs.push_back(o); }
+        for(const auto &o: obs){
+            if(Intersect(SOA_PROBE, RectF{ o.x, o.y, o.w, o.h })){ hits++; break; }
+        }
+    }
+    double secs = SecondsSince(t0);
+    checksum = hits; for(const auto &o: obs) checksum += o.x;
+    return secs;
+}
+
+static double BenchSoA(size_t n, float strip, int frames, bool simd, double& checksum){
+    std::vector<Obstacle> init; FillObstacles(n, strip, init);
+    ObstacleSoA obs; obs.reserve(n);
+    for(const auto &o: init) obs.push(o);
+    size_t next = 0; int hits = 0;
+    auto t0 = BenchClock::now();
+    for(int f=0;f<frames;f++){
+        if(simd) obs.Move(420.0f, DT); else obs.MoveScalar(420.0f, DT);
+        obs.Compact(-8.0f);
+        while(obs.size() < n){ Obstacle o = init[next++ % n]; o.x = strip; obs.push(o); }
+        int hit = simd ? obs.FirstHit(SOA_PROBE) : obs.FirstHitScalar(SOA_PROBE);
+        if(hit >= 0) hits++;
+    }
+    double secs = SecondsSince(t0);
+    checksum = hits; for(size_t i=0;i<obs.size();i++) checksum += obs.x[i];
+    return secs;
+}
+
+// FMA contraction may round the scalar loops differently from the SIMD ones
+static bool SameChecksum(double a, double b){
+    return std::fabs(a - b) <= 1e-4 * std::max(1.0, std::fabs(a));
+}
+
+static int BenchSoa(int argc, char** argv){
+    long frameBudget = ArgLong(argc, argv, "--frames", 0);
+    const size_t counts[] = { 8, 64, 1024, 16384, 262144 };
+    std::printf("soa: kernels %s; ns per obstacle per frame (move + despawn + hit test)\n", SoaKernelName());
+    std::printf("%9s %8s %10s %10s %10s %9s\n", "obstacles", "frames", "aos", "soa-scal", "soa-simd", "speedup");
+    for(size_t n: counts){
+        int frames = frameBudget > 0 ? (int)frameBudget : (int)std::max<size_t>(200, 40000000 / n);
+        float strip = std::max(900.0f, (float)n * 6.0f);
+        double cA, cS, cV;
+        double a = BenchAoS(n, strip, frames, cA);
+        double s = BenchSoA(n, strip, frames, false, cS);
+        double v = BenchSoA(n, strip, frames, true, cV);
+        double per = 1e9 / ((double)n * frames);
+        std::printf("%9zu %8d %10.3f %10.3f %10.3f %8.2fx%s\n", n, frames, a*per, s*per, v*per, a / v,
+                    (SameChecksum(cA, cS) && SameChecksum(cS, cV)) ? "" : "  (checksum mismatch)");
+    }
+    return 0;
+}
+
+// ---------------- draw -------------------------------
+// Menu -> play -> game over, N times. The first run is the warm-up that
+// meets every color and font; any later frame that creates one is a
+// cache miss we care about.
+static int BenchDraw(int argc, char** argv){
+    long runs = ArgLong(argc, argv, "--runs", 5);
+    CountingBackend cb;
+    World w; ResetWorld(w, 99);
+    std::vector<int> top5{ 1200, 950, 800, 410, 200 };
+    uint64_t frames = 0, calls = 0, created = 0, steadyCreated = 0;
+    uint32_t firstFrameCreated = 0;
+    bool warm = false;
+
+    auto frame = [&](){
+        RenderScene(cb, w, 1200, top5);
+        const CountingBackend::FrameStats& st = cb.Last();
+        if(frames == 0) firstFrameCreated = st.created;
+        if(warm) steadyCreated += st.created;
+        frames++; created += st.created;
+        calls += st.fills + st.frames + st.texts;
+    };
+
+    auto t0 = BenchClock::now();
+    for(long r=0;r<runs;r++){
+        ResetWorld(w, 99 + (uint64_t)r);
+        w.state = GameState::MENU;
+        for(int i=0;i<30;i++) frame();
+        w.state = GameState::PLAYING;
+        while(w.state==GameState::PLAYING){
+            ApplyInput(w, ReflexPolicy(w));
+            UpdateGame(w, DT);
+            frame();
+        }
+        for(int i=0;i<30;i++) frame();
+        warm = true;
+    }
+    double secs = SecondsSince(t0);
+
+    std::printf("draw: %llu frames, %.1f draw calls/frame, %.0f ns/frame (counting backend)\n",
+                (unsigned long long)frames, frames ? (double)calls / frames : 0.0, frames ? secs * 1e9 / frames : 0.0);
+    std::printf("      cache: %zu brushes, %zu fonts; created %llu total, %u in first frame\n",
+                cb.Brushes(), cb.Fonts(), (unsigned long long)created, firstFrameCreated);
+    std::printf("      steady-state creations: %llu %s\n", (unsigned long long)steadyCreated,
+                steadyCreated ? "FAIL" : "ok");
+    return steadyCreated ? 1 : 0;
+}
+
+// ---------------- fb ---------------------------------
+static int BenchFb(int argc, char** argv){
+    long frames = ArgLong(argc, argv, "--frames", 20000);
+    const char* ppm = ArgStr(argc, argv, "--ppm", nullptr);
+    Framebuffer fb; fb.Resize(W_WIDTH, W_HEIGHT);
+    SoftBackend sb(fb);
+    std::vector<int> top5{ 1200, 950, 800, 410, 200 };
+    double renderSecs = 0.0;
+    PlayFrames(frames, [&](const World& w){
+        auto t0 = BenchClock::now();
+        RenderScene(sb, w, 1200, top5);
+        renderSecs += SecondsSince(t0);
+    });
+    double ns = renderSecs * 1e9 / (double)frames;
+    std::printf("fb: %ld frames %dx%d, %.0f ns/frame, %.0f Mpix/s cleared+drawn\n", frames, fb.w, fb.h, ns,
+                (double)fb.w * fb.h / ns * 1e3);
+    if(ppm && !WritePPM(fb, ppm)){ std::fprintf(stderr, "cannot write %s\n", ppm); return 1; }
+    return 0;
+}
+
+// ---------------- damage -----------------------------
+// Every frame is drawn twice: the damage path (display list diff, clipped
+// replay) and a full reference redraw. They must match pixel for pixel.
+static int BenchDamage(int argc, char** argv){
+    long runs = ArgLong(argc, argv, "--runs", 3);
+    Framebuffer fb, ref; fb.Resize(W_WIDTH, W_HEIGHT); ref.Resize(W_WIDTH, W_HEIGHT);
+    SoftBackend sb(fb), refSb(ref);
+    DisplayList dl; DamageTracker dt;
+    const IRect screen{ 0, 0, W_WIDTH, W_HEIGHT };
+    std::vector<int> top5{ 1200, 950, 800, 410, 200 };
+    uint64_t touched[3] = {}, frames[3] = {}, mismatches = 0, n = 0;
+    World w; ResetWorld(w, 11);
+    ParticleSystem fx;
+
+    auto frame = [&](){
+        fx.Observe(w);
+        fx.Update(DT);
+        RenderScene(dl, w, 1200, top5, &fx);
+        sb.ResetPixels();
+        for(const auto &r: dt.Update(dl, screen)){ sb.SetClip(r); dl.Replay(sb, r); }
+        sb.ResetClip();
+        RenderScene(refSb, w, 1200, top5, &fx);
+        if(fb.px != ref.px) mismatches++;
+        int si = (int)w.state;
+        if(n++ > 0){ touched[si] += sb.Pixels(); frames[si]++; }   // frame 0 is a full paint
+    };
+
+    for(long r=0;r<runs;r++){
+        ResetWorld(w, 11 + (uint64_t)r);
+        w.state = GameState::MENU;
+        for(int i=0;i<60;i++) frame();
+        w.state = GameState::PLAYING;
+        while(w.state==GameState::PLAYING){ ApplyInput(w, ReflexPolicy(w)); UpdateGame(w, DT); frame(); }
+        for(int i=0;i<60;i++) frame();
+    }
+
+    const char* names[3] = { "menu", "playing", "gameover" };
+    double full = (double)W_WIDTH * W_HEIGHT;
+    std::printf("damage: pixels touched per frame (full frame = %.0f)\n", full);
+    for(int i=0;i<3;i++){
+        double avg = frames[i] ? (double)touched[i] / frames[i] : 0.0;
+        std::printf("  %-9s %8llu frames %10.0f px/frame %6.2f%%\n", names[i], (unsigned long long)frames[i], avg, 100.0 * avg / full);
+    }
+    std::printf("  mismatching frames vs full redraw: %llu %s\n", (unsigned long long)mismatches, mismatches ? "FAIL" : "ok");
+    return mismatches ? 1 : 0;
+}
+
+// ---------------- pacing -----------------------------
+// WM_TIMER at 1000/FPS ms really fires on the 15.6 ms system tick, so
+// intervals are one or two ticks with a little noise, plus the odd long
+// stall. Render cost is charged to the fake clock as well.
+static int BenchPacing(int argc, char** argv){
+    long frames = ArgLong(argc, argv, "--frames", 100000);
+    double tick = std::atof(ArgStr(argc, argv, "--timer-ms", "15.625")) / 1000.0;
+    bool csv = false;
+    for(int i=0;i<argc;i++) if(!std::strcmp(argv[i], "--csv")) csv = true;
+
+    FakeClock clock;
+    FramePacer pacer(clock, DT);
+    pacer.Reset();
+    Pcg32 rng; rng.seed(99);
+    double gameTime = 0.0, wallTime = 0.0;   // wall time between Advance() calls, after the 0.08 s clamp
+    uint64_t last = clock.Now();
+    for(long f=0;f<frames;f++){
+        double dt = tick * (rng.range(0, 9) == 0 ? 2 : 1) + rng.uniform(-0.0005f, 0.0005f);
+        if(rng.range(0, 999) == 0) dt = 0.25;            // window drag, debugger, ...
+        double render = std::min((double)rng.uniform(0.0002f, 0.0015f), dt * 0.5);
+        clock.AdvanceSeconds(dt - render);
+        wallTime += std::min((double)(clock.Now() - last) / (double)clock.Frequency(), 0.08);
+        last = clock.Now();
+        gameTime += pacer.Advance() * (double)DT;
+        pacer.RenderStart();
+        clock.AdvanceSeconds(render);
+        pacer.RenderEnd();
+    }
+
+    const PacingStats& st = pacer.Stats();
+    uint64_t stepFrames = 0;
+    for(const auto &s: st.steps) stepFrames += s.load();
+    // game time trails wall time by exactly what is left in the accumulator
+    double lag = wallTime - gameTime;
+    bool ok = stepFrames == (uint64_t)frames && lag > -1e-6 && lag < (double)DT + 1e-6;
+    st.Export(stdout, csv);
+    std::printf("pacing: %ld frames, game time %.3f s vs clamped wall time %.3f s (lag %.2f ms) %s\n",
+                frames, gameTime, wallTime, lag * 1000.0, ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+// ---------------- stress -----------------------------
+// Doubling obstacle counts (clouds at a quarter of that, one runner per
+// 32 obstacles), each level warmed up for a second of game time. Live
+// obstacles all share one screen, so overlaps grow with the count too;
+// the grid's cost tracks obstacles + hits, all-pairs runners x obstacles.
+// "drawn" counts what RenderScene issues draw calls for (the runners are
+// hit-test only), so render cost is read against that.
+static int BenchStress(int argc, char** argv){
+    long frames = ArgLong(argc, argv, "--frames", 120);
+    long maxN = ArgLong(argc, argv, "--max", 16384);
+    Framebuffer fb; fb.Resize(W_WIDTH, W_HEIGHT);
+    SoftBackend sb(fb);
+    std::vector<int> top5;
+    StressScene scene;
+    bool ok = true;
+    std::printf("stress: per frame, %ld frames per level\n", frames);
+    std::printf("  %8s %8s %7s %9s %10s %10s %10s %10s %9s\n",
+                "drawn", "obstacle", "runners", "spawn/s", "update us", "render us", "grid us", "pairs us", "hits");
+    for(long n=1024;n<=maxN;n*=2){
+        StressConfig cfg;
+        cfg.obstacles = (uint32_t)n;
+        cfg.clouds = (uint32_t)(n / 4);
+        cfg.runners = (uint32_t)std::max(16L, n / 32);
+        scene.Reset(cfg);
+        StressFrame fr;
+        for(int i=0;i<FPS;i++) scene.Step(fr);
+        double update = 0, render = 0, grid = 0, pairs = 0;
+        uint64_t spawned = 0, hits = 0, entities = 0;
+        for(long f=0;f<frames;f++){
+            scene.Step(fr);
+            auto t0 = BenchClock::now();
+            RenderScene(sb, scene.GetWorld(), 0, top5);
+            render += SecondsSince(t0);
+            update += fr.spawnSec + fr.updateSec;
+            grid += fr.gridSec; pairs += fr.naiveSec;
+            spawned += fr.spawned; hits += fr.gridHits;
+            entities += DrawnEntities(scene.GetWorld());
+            if(fr.gridHits != fr.naiveHits) ok = false;
+        }
+        double k = 1e6 / (double)frames;
+        std::printf("  %8llu %8ld %7u %9.0f %10.1f %10.1f %10.1f %10.1f %9.1f\n",
+                    (unsigned long long)(entities / (uint64_t)frames), n, cfg.runners,
+                    (double)spawned / ((double)frames * DT), update * k, render * k, grid * k, pairs * k,
+                    (double)hits / (double)frames);
+    }
+    std::printf("  grid vs all-pairs hit counts: %s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+// ---------------- stream -----------------------------
+// Independent of the generator's own check: whole Worlds stepped with
+// ApplyInput/UpdateGame, one per distinct dino state. Returns the tick
+// at which no state is left alive, or maxTicks.
+static uint32_t AuditRun(uint64_t seed, const SpawnFeed* feed, uint32_t maxTicks, size_t& maxStates){
+    const TickInput inputs[3] = { { false, false }, { true, false }, { false, true } };
+    std::vector<World> cur(1), next;
+    cur[0].feed = feed;
+    ResetWorld(cur[0], seed);
+    cur[0].state = GameState::PLAYING;
+    for(uint32_t t=0;t<maxTicks;t++){
+        next.clear();
+        for(const auto &w: cur){
+            for(int i=0;i<3;i++){
+                if(i > 0 && !w.dino.onGround) break;
+                World c = w;
+                ApplyInput(c, inputs[i]);
+                if(UpdateGame(c, DT)) continue;
+                const Dino& d = c.dino;
+                bool seen = false;
+                for(const auto &o: next){
+                    if(o.dino.y == d.y && o.dino.vy == d.vy && o.dino.onGround == d.onGround && o.dino.duck == d.duck){ seen = true; break; }
+                }
+                if(!seen) next.push_back(c);
+            }
+        }
+        if(next.empty()) return t + 1;
+        maxStates = std::max(maxStates, next.size());
+        cur.swap(next);
+    }
+    return maxTicks;
+}
+
+static int BenchStream(int argc, char** argv){
+    long seeds = ArgLong(argc, argv, "--seeds", 8);
+    uint32_t ticks = (uint32_t)ArgLong(argc, argv, "--ticks", 5400);
+    const Tuning tune;
+
+    // Generation, inline
+    StreamGenerator gen;
+    StreamStats total;
+    double worstChunk = 0.0;
+    for(long s=0;s<seeds;s++){
+        gen.Reset(1000 + (uint64_t)s, tune, &DEFAULT_SPAWN_TABLE);
+        StreamChunk c;
+        for(uint32_t n=0;n*STREAM_CHUNK_TICKS<ticks;n++){
+            double before = gen.Stats().seconds;
+            gen.Next(c);
+            worstChunk = std::max(worstChunk, gen.Stats().seconds - before);
+        }
+        const StreamStats& st = gen.Stats();
+        total.chunks += st.chunks; total.events += st.events; total.rerolls += st.rerolls;
+        total.emptied += st.emptied; total.ticksChecked += st.ticksChecked; total.seconds += st.seconds;
+        total.maxStates = std::max(total.maxStates, st.maxStates);
+    }
+
+    // Game side: a worker feeding a World, one Feed() per step. Steps run
+    // ~1000x faster than real time (1 ms pause per 60), which still leaves
+    // the worker far more slack than it needs.
+    StreamWorker worker;
+    SpawnFeed feed;
+    World w; w.feed = &feed;
+    ResetWorld(w, 1000); w.state = GameState::PLAYING;
+    feed.Clear();
+    worker.Start(1000, tune, &DEFAULT_SPAWN_TABLE);
+    std::vector<Obstacle> served;
+    double feedSecs = 0.0, worstFeed = 0.0;
+    for(uint32_t t=0;t<ticks;t++){
+        if(t % FPS == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        auto t0 = BenchClock::now();
+        worker.Feed(feed, w.ticks + 1);
+        double fs = SecondsSince(t0);
+        feedSecs += fs;
+        worstFeed = std::max(worstFeed, fs);
+        uint32_t before = w.spawned;
+        UpdateGame(w, DT);                                // keeps going through hits
+        if(w.spawned != before) served.push_back(w.obs.back());
+    }
+    worker.Stop();
+    uint64_t stalls = worker.Stalls();
+
+    SpawnFeed inlineFeed(ticks / STREAM_CHUNK_TICKS + 2);
+    gen.Reset(1000, tune, &DEFAULT_SPAWN_TABLE);
+    FillFeed(gen, inlineFeed, ticks);
+    World ref; ref.feed = &inlineFeed;
+    ResetWorld(ref, 1000); ref.state = GameState::PLAYING;
+    bool same = true;
+    size_t k = 0;
+    for(uint32_t t=0;t<ticks && same;t++){
+        uint32_t before = ref.spawned;
+        UpdateGame(ref, DT);
+        if(ref.spawned == before) continue;
+        const Obstacle& o = ref.obs.back();
+        same = k < served.size() && served[k].type == o.type && served[k].x == o.x && served[k].speed == o.speed;
+        k++;
+    }
+    same = same && k == served.size();
+
+    // Audit: every seed, fed and legacy
+    uint32_t fedDead = 0, legacyDead = 0;
+    size_t auditStates = 0;
+    double legacyFirst = 0.0;
+    auto ta = BenchClock::now();
+    for(long s=0;s<seeds;s++){
+        uint64_t seed = 1000 + (uint64_t)s;
+        SpawnFeed f(ticks / STREAM_CHUNK_TICKS + 2);
+        gen.Reset(seed, tune, &DEFAULT_SPAWN_TABLE);
+        FillFeed(gen, f, ticks);
+        uint32_t a = AuditRun(seed, &f, ticks, auditStates);
+        uint32_t b = AuditRun(seed, nullptr, ticks, auditStates);
+        if(a < ticks){ fedDead++; std::printf("  seed %llu: fed stream impossible at tick %u\n", (unsigned long long)seed, a); }
+        if(b < ticks){ legacyDead++; legacyFirst += b; }
+    }
+    double auditSecs = SecondsSince(ta);
+
+    double chunkUs = total.chunks ? total.seconds * 1e6 / (double)total.chunks : 0.0;
+    std::printf("stream: %ld seeds x %u ticks, chunks of %u ticks\n", seeds, ticks, STREAM_CHUNK_TICKS);
+    std::printf("  generate   %llu chunks, %.0f us/chunk (worst %.0f us), %llu re-rolled, %llu served empty, %.1f obstacles/chunk\n",
+                (unsigned long long)total.chunks, chunkUs, worstChunk * 1e6, (unsigned long long)total.rerolls,
+                (unsigned long long)total.emptied, total.chunks ? (double)total.events / total.chunks : 0.0);
+    std::printf("             %llu ticks checked, up to %zu reachable dino states\n",
+                (unsigned long long)total.ticksChecked, total.maxStates);
+    std::printf("  game side  %.0f ns/step average, %.1f us worst, %llu waits for the worker\n",
+                feedSecs * 1e9 / ticks, worstFeed * 1e6, (unsigned long long)stalls);
+    std::printf("  audit      %.1f s, up to %zu World copies per tick\n", auditSecs, auditStates);
+    std::printf("             legacy spawner: %u of %ld seeds impossible within %u ticks",
+                legacyDead, seeds, ticks);
+    if(legacyDead) std::printf(" (first dead end after %.0f ticks on average)", legacyFirst / legacyDead);
+    std::printf("\n");
+    std::printf("  fed runs all survivable: %s\n", fedDead ? "FAIL" : "ok");
+    std::printf("  worker stream == inline stream: %s (%zu obstacles)\n", same ? "ok" : "FAIL", served.size());
+    return fedDead || !same ? 1 : 0;
+}
+
+// ---------------- particles --------------------------
+// Keeps perKind particles of each kind alive: dust along the ground,
+// debris and feathers across the sky, re-emitted as they expire.
+static void TopUpParticles(ParticleSystem& fx, size_t perKind, Pcg32& rng){
+    const float groundY = (float)(W_HEIGHT - GROUND_H);
+    const RectF sky{ 0.0f, 40.0f, (float)W_WIDTH, groundY - 120.0f };
+    for(size_t n = fx.Pool(PK_DUST).n; n < perKind; n++) fx.Dust(rng.uniform(0.0f, (float)W_WIDTH), groundY, 1, -200.0f);
+    if(fx.Pool(PK_DEBRIS).n < perKind) fx.Debris(sky, (int)(perKind - fx.Pool(PK_DEBRIS).n));
+    if(fx.Pool(PK_FEATHER).n < perKind) fx.Feathers(sky, (int)(perKind - fx.Pool(PK_FEATHER).n));
+}
+
+static int BenchParticles(int argc, char** argv){
+    long count = ArgLong(argc, argv, "--count", 50000);
+    long frames = ArgLong(argc, argv, "--frames", 600);
+    size_t perKind = (size_t)(count > 3 ? count / 3 : 1);
+    ParticleSystem fx(perKind), ref(perKind);
+    Pcg32 rngA, rngB; rngA.seed(17); rngB.seed(17);
+
+    // Update: same emissions into both systems, SIMD vs scalar kernel
+    double simdSecs = 0.0, scalarSecs = 0.0, updated = 0.0, maxDiff = 0.0;
+    bool countsMatch = true;
+    for(long f=0;f<frames;f++){
+        TopUpParticles(fx, perKind, rngA);
+        TopUpParticles(ref, perKind, rngB);
+        updated += (double)fx.Live();
+        auto t0 = BenchClock::now();
+        fx.Update(DT);
+        simdSecs += SecondsSince(t0);
+        t0 = BenchClock::now();
+        ref.UpdateScalar(DT);
+        scalarSecs += SecondsSince(t0);
+        for(int k=0;k<PK_COUNT;k++){
+            const ParticlePool &a = fx.Pool((ParticleKind)k), &b = ref.Pool((ParticleKind)k);
+            if(a.n != b.n){ countsMatch = false; continue; }
+            for(size_t i=0;i<a.n;i++)
+                maxDiff = std::max(maxDiff, (double)std::max(std::fabs(a.x[i] - b.x[i]), std::fabs(a.y[i] - b.y[i])));
+        }
+    }
+    bool kernelsOk = countsMatch && maxDiff < 1e-3;
+
+    // Draw: the same scene with and without particles, straight into the
+    // framebuffer and through the display list + damage path the game uses
+    Framebuffer fb; fb.Resize(W_WIDTH, W_HEIGHT);
+    SoftBackend sb(fb);
+    DisplayList dl; DamageTracker dt;
+    CountingBackend cb;
+    const IRect screen{ 0, 0, W_WIDTH, W_HEIGHT };
+    std::vector<int> top5{ 1200, 950, 800, 410, 200 };
+    World w; ResetWorld(w, 7); w.state = GameState::PLAYING;
+    double withSecs = 0.0, withoutSecs = 0.0, frameSecs = 0.0, worstFrame = 0.0, drawn = 0.0;
+    uint32_t extraCalls = 0;
+    for(long f=0;f<frames;f++){
+        TopUpParticles(fx, perKind, rngA);
+        ApplyInput(w, ReflexPolicy(w));
+        if(UpdateGame(w, DT)){ ResetWorld(w, 7 + (uint64_t)f); w.state = GameState::PLAYING; }
+
+        auto t0 = BenchClock::now();
+        fx.Update(DT);
+        RenderScene(dl, w, 1200, top5, &fx);
+        for(const auto &r: dt.Update(dl, screen)){ sb.SetClip(r); dl.Replay(sb, r); }
+        sb.ResetClip();
+        double fs = SecondsSince(t0);
+        frameSecs += fs;
+        worstFrame = std::max(worstFrame, fs);
+
+        drawn += (double)fx.Live();
+        t0 = BenchClock::now();
+        RenderScene(sb, w, 1200, top5);
+        withoutSecs += SecondsSince(t0);
+        t0 = BenchClock::now();
+        RenderScene(sb, w, 1200, top5, &fx);
+        withSecs += SecondsSince(t0);
+
+        RenderScene(cb, w, 1200, top5);
+        uint32_t base = cb.Last().fills;
+        RenderScene(cb, w, 1200, top5, &fx);
+        extraCalls = std::max(extraCalls, cb.Last().fills - base);
+    }
+    double perFrame = frameSecs * 1e3 / (double)frames;
+    bool batched = extraCalls <= (uint32_t)PK_COUNT;
+    bool fits = perFrame < 1000.0 / FPS;
+
+    std::printf("particles: %ld frames, %.0f live on average (%zu per kind), kernels %s\n",
+                frames, updated / (double)frames, perKind, ParticleKernelName());
+    std::printf("  update  %6.2f ns/particle  (scalar %.2f ns/particle, %.2fx)\n",
+                simdSecs * 1e9 / updated, scalarSecs * 1e9 / updated, simdSecs > 0.0 ? scalarSecs / simdSecs : 0.0);
+    std::printf("  draw    %6.2f ns/particle  (software framebuffer, %u draw calls for all particles)\n",
+                std::max(0.0, withSecs - withoutSecs) * 1e9 / drawn, extraCalls);
+    std::printf("  frame   %6.2f ms average, %.2f ms worst (update + display list + damage + raster)\n",
+                perFrame, worstFrame * 1e3);
+    std::printf("  kernels agree: %s (max drift %.2g px)\n", kernelsOk ? "ok" : "FAIL", maxDiff);
+    std::printf("  one draw call per kind: %s\n", batched ? "ok" : "FAIL");
+    std::printf("  60 fps budget (%.1f ms): %s\n", 1000.0 / FPS, fits ? "ok" : "FAIL");
+    return kernelsOk && batched && fits ? 0 : 1;
+}
+
+// ---------------- palette ----------------------------
+// The kernels are timed on a rendered scene (tiled up to 4K) and on noise,
+// where no two neighbours match and every block takes the gather path.
+static void TileInto(const Framebuffer& tile, Framebuffer& out){
+    for(int y=0;y<out.h;y++){
+        const uint32_t* s = tile.Row(y % tile.h);
+        uint32_t* d = out.Row(y);
+        for(int x=0;x<out.w;x++) d[x] = s[x % tile.w];
+    }
+}
+
+static int BenchPalette(int argc, char** argv){
+    long frames = ArgLong(argc, argv, "--frames", 200);
+    std::vector<int> top5{ 1200, 950, 800, 410, 200 };
+    Framebuffer scene; scene.Resize(W_WIDTH, W_HEIGHT);
+    {
+        SoftBackend sb(scene);
+        World w; ResetWorld(w, 7); w.state = GameState::PLAYING;
+        for(int i=0;i<400;i++){ ApplyInput(w, ReflexPolicy(w)); UpdateGame(w, DT); }
+        RenderScene(sb, w, 1200, top5);
+    }
+    PaletteLut lut; lut.Night(0.5f);
+    bool kernelsOk = true, neverSlower = true;
+
+    std::printf("palette: LUT remap, kernel %s, %ld frames per case\n", PaletteKernelName(), frames);
+    const int sizes[2][2] = { { W_WIDTH, W_HEIGHT }, { 3840, 2160 } };
+    for(const auto &sz: sizes){
+        Framebuffer src, a, b;
+        src.Resize(sz[0], sz[1]); a.Resize(sz[0], sz[1]); b.Resize(sz[0], sz[1]);
+        const IRect all{ 0, 0, sz[0], sz[1] };
+        for(int pass=0;pass<2;pass++){
+            if(pass == 0) TileInto(scene, src);
+            else { Pcg32 rng; rng.seed(19); for(auto &p: src.px) p = 0xFF000000u | (rng.next() & 0xFFFFFFu); }
+            long n = sz[0] >= 3840 ? frames / 4 + 1 : frames;
+            auto t0 = BenchClock::now();
+            for(long f=0;f<n;f++) RemapRect(lut, src, a, all);
+            double simd = SecondsSince(t0) / (double)n;
+            t0 = BenchClock::now();
+            for(long f=0;f<n;f++) RemapRectScalar(lut, src, b, all);
+            double scalar = SecondsSince(t0) / (double)n;
+            if(a.px != b.px) kernelsOk = false;
+            if(simd > scalar * 1.1) neverSlower = false;      // 10% for timer noise
+            std::printf("  %4dx%-4d %-5s %7.3f ms/frame %7.0f Mpix/s %5.1f%% of a 60 fps frame  (scalar %.3f ms, %.2fx)\n",
+                        sz[0], sz[1], pass == 0 ? "scene" : "noise", simd * 1e3, (double)sz[0] * sz[1] / simd * 1e-6,
+                        simd * 100.0 * FPS, scalar * 1e3, simd > 0.0 ? scalar / simd : 0.0);
+        }
+    }
+
+    // Fade: score swept through a whole night, one point per frame, drawn
+    // the way main.cpp does it and checked against full redraw + remap
+    Framebuffer fb, night, ref, refNight;
+    fb.Resize(W_WIDTH, W_HEIGHT); night.Resize(W_WIDTH, W_HEIGHT);
+    ref.Resize(W_WIDTH, W_HEIGHT); refNight.Resize(W_WIDTH, W_HEIGHT);
+    SoftBackend sb(fb), refSb(ref);
+    DisplayList dl; DamageTracker dt; DayNight dn;
+    const IRect screen{ 0, 0, W_WIDTH, W_HEIGHT };
+    World w; ResetWorld(w, 7); w.state = GameState::PLAYING;
+    uint64_t sweep = 0, fullPasses = 0, mismatches = 0, maxFull = 0;
+    double remapped = 0.0, frameSecs = 0.0;
+    for(int score=NIGHT_START-100;score<NIGHT_PERIOD+100;score++,sweep++){
+        ApplyInput(w, ReflexPolicy(w));
+        if(UpdateGame(w, DT)){ ResetWorld(w, 7 + sweep); w.state = GameState::PLAYING; }
+        World v = w; v.score = score;
+
+        auto t0 = BenchClock::now();
+        bool relit = dn.Update(v.score);
+        RenderScene(dl, v, 1200, top5);
+        const std::vector<IRect>& dmg = dt.Update(dl, screen);
+        for(const auto &r: dmg){ sb.SetClip(r); dl.Replay(sb, r); }
+        sb.ResetClip();
+        uint64_t full = 0;
+        if(!dn.IsDay()){
+            if(relit){ RemapRect(dn.Lut(), fb, night, screen); full++; remapped += (double)W_WIDTH * W_HEIGHT; }
+            else for(const auto &r: dmg){ RemapRect(dn.Lut(), fb, night, r); remapped += (double)(r.r - r.l) * (r.b - r.t); }
+        }
+        frameSecs += SecondsSince(t0);
+        fullPasses += full;
+        maxFull = std::max(maxFull, full);
+
+        RenderScene(refSb, v, 1200, top5);
+        if(dn.IsDay()){ if(fb.px != ref.px) mismatches++; }
+        else {
+            RemapRectScalar(dn.Lut(), ref, refNight, screen);
+            if(night.px != refNight.px) mismatches++;
+        }
+    }
+    std::printf("  fade      %llu frames (score %d..%d), %llu full remaps (%d LUT steps each way), at most %llu per frame\n",
+                (unsigned long long)sweep, NIGHT_START - 100, NIGHT_PERIOD + 99, (unsigned long long)fullPasses,
+                NIGHT_LEVELS, (unsigned long long)maxFull);
+    std::printf("            %.0f px remapped per frame on average, %.3f ms per frame (damage + remap)\n",
+                remapped / (double)sweep, frameSecs * 1e3 / (double)sweep);
+    std::printf("  kernels agree: %s\n", kernelsOk ? "ok" : "FAIL");
+    std::printf("  %s kernel never slower than scalar: %s\n", PaletteKernelName(), neverSlower ? "ok" : "FAIL");
+    std::printf("  mismatching frames vs full redraw + remap: %llu %s\n", (unsigned long long)mismatches, mismatches ? "FAIL" : "ok");
+    return kernelsOk && neverSlower && !mismatches && maxFull <= 1 ? 0 : 1;
+}
+
+// ---------------- scale ------------------------------
+static int BenchScale(int argc, char** argv){
+    long frames = ArgLong(argc, argv, "--frames", 100);
+    std::vector<int> top5{ 1200, 950, 800, 410, 200 };
+    Framebuffer scene; scene.Resize(W_WIDTH, W_HEIGHT);
+    SoftBackend sb(scene);
+    {
+        World w; ResetWorld(w, 7); w.state = GameState::PLAYING;
+        for(int i=0;i<400;i++){ ApplyInput(w, ReflexPolicy(w)); UpdateGame(w, DT); }
+        RenderScene(sb, w, 1200, top5);
+    }
+    const IRect all{ 0, 0, W_WIDTH, W_HEIGHT };
+    bool kernelsOk = true;
+
+    std::printf("scale: %dx%d scene, kernel %s, %ld frames per case\n", W_WIDTH, W_HEIGHT, ScaleKernelName(), frames);
+    const int outs[3][2] = { { 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 } };
+    const ScaleMode modes[2] = { ScaleMode::Nearest, ScaleMode::Bilinear };
+    for(const auto &o: outs){
+        Framebuffer a, b; a.Resize(o[0], o[1]); b.Resize(o[0], o[1]);
+        for(ScaleMode m: modes){
+            Scaler sc; sc.Configure(W_WIDTH, W_HEIGHT, o[0], o[1], m);
+            const IRect& d = sc.Dest();
+            auto t0 = BenchClock::now();
+            for(long f=0;f<frames;f++) sc.Run(scene, a, all);
+            double simd = SecondsSince(t0) / (double)frames;
+            t0 = BenchClock::now();
+            for(long f=0;f<frames;f++) sc.RunScalar(scene, b, all);
+            double scalar = SecondsSince(t0) / (double)frames;
+            if(a.px != b.px) kernelsOk = false;
+            double px = (double)(d.r - d.l) * (d.b - d.t);
+            std::printf("  %4dx%-4d %-8s -> %4dx%-4d %7.3f ms/frame %6.0f Mpix/s %5.1f%% of a 60 fps frame  (scalar %.3f ms, %.2fx)\n",
+                        o[0], o[1], ScaleModeName(m), d.r - d.l, d.b - d.t, simd * 1e3, px / simd * 1e-6,
+                        simd * 100.0 * FPS, scalar * 1e3, simd > 0.0 ? scalar / simd : 0.0);
+        }
+    }
+
+    // Damage path at 4K: only the output under each dirty rectangle is
+    // rescaled, checked against rescaling the whole frame
+    Framebuffer out, ref; out.Resize(3840, 2160); ref.Resize(3840, 2160);
+    DisplayList dl; DamageTracker dt;
+    const IRect screen{ 0, 0, W_WIDTH, W_HEIGHT };
+    uint64_t mismatches = 0, n = 0;
+    double rescaled[2] = {}, secs[2] = {};
+    for(ScaleMode m: modes){
+        Scaler sc; sc.Configure(W_WIDTH, W_HEIGHT, out.w, out.h, m);
+        dt.Invalidate();
+        PlayFrames(frames * 3, [&](const World& w){
+            RenderScene(dl, w, 1200, top5);
+            const std::vector<IRect>& dmg = dt.Update(dl, screen);
+            for(const auto &r: dmg){ sb.SetClip(r); dl.Replay(sb, r); }
+            sb.ResetClip();
+            auto t0 = BenchClock::now();
+            for(const auto &r: dmg){ IRect o = sc.Run(scene, out, r); rescaled[(int)m] += (double)(o.r - o.l) * (o.b - o.t); }
+            secs[(int)m] += SecondsSince(t0);
+            sc.RunScalar(scene, ref, all);
+            if(out.px != ref.px) mismatches++;
+            n++;
+        });
+    }
+    double full = 3840.0 * 2160.0, per = (double)(frames * 3);
+    for(ScaleMode m: modes)
+        std::printf("  damage    %-8s %8.0f px rescaled per frame (%.1f%% of 4K), %.3f ms/frame\n", ScaleModeName(m),
+                    rescaled[(int)m] / per, 100.0 * rescaled[(int)m] / per / full, secs[(int)m] * 1e3 / per);
+    std::printf("  kernels agree: %s\n", kernelsOk ? "ok" : "FAIL");
+    std::printf("  mismatching damage-only frames vs full rescale: %llu of %llu %s\n",
+                (unsigned long long)mismatches, (unsigned long long)n, mismatches ? "FAIL" : "ok");
+    return kernelsOk && !mismatches ? 0 : 1;
+}
+
+// ---------------- alloc ------------------------------
+// One WM_TIMER frame of main.cpp, phase by phase. Steady state means a
+// PLAYING frame after the warm-up that neither starts nor ends a run;
+// game-over frames are reported but allowed to allocate.
+enum AllocPhase { AP_INPUT, AP_SIM, AP_FX, AP_RENDER, AP_PRESENT, AP_COUNT };
+static const char* ALLOC_PHASE_NAMES[AP_COUNT] = { "input", "sim", "fx", "render", "present" };
+
+static int BenchAlloc(int argc, char** argv){
+    long frames = ArgLong(argc, argv, "--frames", 20000);
+    long warmup = ArgLong(argc, argv, "--warmup", 600);
+    if(!AllocTracking()){
+        std::printf("alloc: this trex_bench was built without -DTREX_TRACK_ALLOC, nothing is counted\n");
+        return 2;
+    }
+
+    World w; SpawnFeed feed; StreamWorker worker; InputRecorder rec;
+    ParticleSystem fx; DayNight dn;
+    Framebuffer fb, night, out; fb.Resize(W_WIDTH, W_HEIGHT); night.Resize(W_WIDTH, W_HEIGHT);
+    SoftBackend sb(fb);
+    DisplayList dl; DamageTracker dt;
+    Scaler scaler; out.Resize(1920, 1080); scaler.Configure(W_WIDTH, W_HEIGHT, out.w, out.h, ScaleMode::Bilinear);
+    const IRect screen{ 0, 0, W_WIDTH, W_HEIGHT };
+    std::vector<int> top5{ 1200, 950, 800, 410, 200 };
+    int highScore = 1200;
+    std::vector<RunRecording*> finished;      // what main.cpp hands to ScoreWriter
+
+    uint64_t seed = 21;
+    auto newRun = [&](){
+        ResetWorld(w, seed);
+        feed.Clear();
+        worker.Start(seed, w.tune, w.spawn);
+        w.feed = &feed;
+        w.state = GameState::PLAYING;
+        rec.Begin(w, seed);
+        seed++;
+    };
+    newRun();
+
+    AllocCounts phase[AP_COUNT], overAllocs;
+    uint64_t steady = 0, dirty = 0, overFrames = 0, runs = 1;
+    long firstBad = -1; int firstBadPhase = -1;
+    bool startOfRun = true;
+    for(long f=0;f<frames;f++){
+        AllocCounts got[AP_COUNT];
+        AllocScope scope;
+        bool over = false;
+
+        rec.Apply(w, ReflexPolicy(w));
+        got[AP_INPUT] = scope.Delta(); scope.Restart();
+
+        worker.Feed(feed, w.ticks + 1);
+        if(UpdateGame(w, DT)){
+            over = true;
+            if(w.score > highScore) highScore = w.score;
+            InsertTop5(top5, w.score);
+            finished.push_back(new RunRecording(rec.Finish(w)));
+        }
+        got[AP_SIM] = scope.Delta(); scope.Restart();
+
+        fx.Observe(w);
+        fx.Update(DT);
+        got[AP_FX] = scope.Delta(); scope.Restart();
+
+        bool relit = dn.Update(w.score);
+        RenderScene(dl, w, highScore, top5, &fx);
+        const std::vector<IRect>& dmg = dt.Update(dl, screen);
+        for(const auto &r: dmg){ sb.SetClip(r); dl.Replay(sb, r); }
+        sb.ResetClip();
+        got[AP_RENDER] = scope.Delta(); scope.Restart();
+
+        if(!dn.IsDay()){
+            if(relit) RemapRect(dn.Lut(), fb, night, screen);
+            else for(const auto &r: dmg) RemapRect(dn.Lut(), fb, night, r);
+        }
+        const Framebuffer& shown = dn.IsDay() ? fb : night;
+        if(relit) scaler.Run(shown, out, screen);
+        else for(const auto &r: dmg) scaler.Run(shown, out, r);
+        got[AP_PRESENT] = scope.Delta();
+
+        uint64_t calls = 0;
+        for(int i=0;i<AP_COUNT;i++) calls += got[i].Calls();
+        if(over){
+            overFrames++; overAllocs.news += calls;
+            for(int i=0;i<60;i++){ fx.Observe(w); fx.Update(DT); }   // a second on the game-over screen
+            newRun(); runs++;
+            startOfRun = true;
+            continue;
+        }
+        if(f >= warmup && !startOfRun){
+            steady++;
+            if(calls) dirty++;
+            for(int i=0;i<AP_COUNT;i++){
+                phase[i].news += got[i].news; phase[i].mallocs += got[i].mallocs; phase[i].bytes += got[i].bytes;
+                if(got[i].Calls() && firstBad < 0){ firstBad = f; firstBadPhase = i; }
+            }
+        }
+        startOfRun = false;
+    }
+    worker.Stop();
+    for(auto *r: finished) delete r;
+
+    std::printf("alloc: %ld frames over %llu runs, %llu steady-state (after %ld warm-up frames)\n",
+                frames, (unsigned long long)runs, (unsigned long long)steady, warmup);
+    for(int i=0;i<AP_COUNT;i++)
+        std::printf("  %-8s %8llu new %8llu malloc %10llu bytes\n", ALLOC_PHASE_NAMES[i],
+                    (unsigned long long)phase[i].news, (unsigned long long)phase[i].mallocs,
+                    (unsigned long long)phase[i].bytes);
+    std::printf("  game-over frames: %llu, %llu heap calls between them (allowed)\n",
+                (unsigned long long)overFrames, (unsigned long long)overAllocs.news);
+    if(firstBad >= 0)
+        std::printf("  first allocating frame: %ld (%s)\n", firstBad, ALLOC_PHASE_NAMES[firstBadPhase]);
+    std::printf("  steady-state frames that allocated: %llu %s\n", (unsigned long long)dirty, dirty ? "FAIL" : "ok");
+    return dirty ? 1 : 0;
+}
+
+// ---------------- simthread --------------------------
+// The reader plays the UI thread: mostly tight reads, sometimes a 20-80 ms
+// sleep (a stalled frame) or a 5-30 ms busy spin (a slow GDI render).
+static int BenchSimThread(int argc, char** argv){
+    double seconds = (double)ArgLong(argc, argv, "--seconds", 10);
+    SteadyClock clock;
+    SimThread sim(clock);
+    SimSetup setup; setup.seed = 5;
+    sim.Start(setup);
+    const uint64_t f = clock.Frequency();
+    uint64_t t0 = clock.Now();
+
+    // Writer side: inputs every 0.1-2 ms, a restart every ~2 s
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> posted{0}, refused{0};
+    std::thread hammer([&](){
+        Pcg32 rng; rng.seed(99);
+        uint64_t lastRestart = clock.Now();
+        while(!done.load()){
+            SimInputKind k = (SimInputKind)rng.range(0, 2);
+            uint64_t now = clock.Now();
+            if(now - lastRestart > 2 * f){ k = SimInputKind::Restart; lastRestart = now; }
+            if(sim.Post(k, rng.next())) posted++; else refused++;
+            std::this_thread::sleep_for(std::chrono::microseconds(rng.range(100, 2000)));
+        }
+    });
+
+    Pcg32 rng; rng.seed(7);
+    uint64_t reads = 0, fresh = 0, torn = 0, backwards = 0, stalls = 0, spins = 0;
+    uint64_t lastStep = 0, lastRun = 0, lastDue = 0;
+    uint32_t lastTicks = 0;
+    while(clock.Now() - t0 < (uint64_t)(seconds * (double)f)){
+        const SimSnapshot& s = sim.Latest();
+        reads++;
+        if(s.step != lastStep) fresh++;
+        if(WorldChecksum(s.world) != s.checksum) torn++;
+        bool sameRun = s.run == lastRun;
+        if(s.step < lastStep || s.dueAt < lastDue || s.run < lastRun ||
+           (sameRun && s.world.ticks < lastTicks) || s.world.ticks > s.step) backwards++;
+        lastStep = s.step; lastRun = s.run; lastDue = s.dueAt; lastTicks = s.world.ticks;
+
+        uint32_t r = rng.range(0, 999);
+        if(r < 3){ stalls++; std::this_thread::sleep_for(std::chrono::milliseconds(rng.range(20, 80))); }
+        else if(r < 6){
+            spins++;
+            uint64_t until = clock.Now() + (uint64_t)rng.range(5, 30) * (f / 1000);
+            while(clock.Now() < until) {}
+        }
+        else std::this_thread::yield();
+    }
+    done = true;
+    hammer.join();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));   // everything posted is now due
+    uint64_t t1 = clock.Now();
+    sim.Stop();
+    uint64_t stopped = sim.Latest().step;
+
+    const SimStats& st = sim.Stats();
+    double elapsed = (double)(t1 - t0) / (double)f;
+    double expected = elapsed * FPS;
+    double drift = (double)stopped - expected;
+    bool rateOk = std::fabs(drift) <= 2.0 + (double)FPS * 0.005 && st.resyncs == 0;
+    bool inputsOk = st.inputs == posted && st.dropped == refused && refused == 0;
+
+    std::printf("simthread: %.1f s, %llu steps (%.0f expected, drift %+.1f), %llu late, worst %.2f ms late, %llu re-bases\n",
+                elapsed, (unsigned long long)stopped, expected, drift, (unsigned long long)st.late,
+                st.maxLateUs / 1000.0, (unsigned long long)st.resyncs);
+    std::printf("  reader   %llu reads, %llu fresh, %llu stalls, %llu busy renders\n",
+                (unsigned long long)reads, (unsigned long long)fresh, (unsigned long long)stalls, (unsigned long long)spins);
+    std::printf("  inputs   %llu posted, %llu applied, %llu refused (queue full)\n",
+                (unsigned long long)posted, (unsigned long long)st.inputs.load(), (unsigned long long)refused);
+    std::printf("  torn snapshots: %llu, out-of-order snapshots: %llu %s\n", (unsigned long long)torn,
+                (unsigned long long)backwards, torn || backwards ? "FAIL" : "ok");
+    std::printf("  every input applied: %s\n", inputsOk ? "ok" : "FAIL");
+    std::printf("  step count matches elapsed time: %s\n", rateOk ? "ok" : "FAIL");
+    if(AllocTracking())
+        std::printf("  playing steps that allocated: %llu %s\n", (unsigned long long)st.allocSteps.load(),
+                    st.allocSteps ? "FAIL" : "ok");
+    return !torn && !backwards && inputsOk && rateOk && !st.allocSteps ? 0 : 1;
+}
+
+// ---------------- capture ----------------------------
+static int BenchCapture(int argc, char** argv){
+    long frames = ArgLong(argc, argv, "--frames", 1200);
+    const char* out = ArgStr(argc, argv, "--out", "trex_capture_bench.y4m");
+    std::vector<int> top5{ 1200, 950, 800, 410, 200 };
+    bool kernelsOk = true;
+
+    // Odd sizes exercise the scalar tails and the repeated edge samples
+    const int odd[4][2] = { { 1, 1 }, { 7, 3 }, { 33, 9 }, { 901, 361 } };
+    for(const auto &sz: odd){
+        Framebuffer fb; fb.Resize(sz[0], sz[1]);
+        Pcg32 rng; rng.seed(23);
+        for(auto &p: fb.px) p = 0xFF000000u | (rng.next() & 0xFFFFFFu);
+        std::vector<uint8_t> a(I420Size(fb.w, fb.h)), b(a.size());
+        BgraToI420(fb, a.data()); BgraToI420Scalar(fb, b.data());
+        if(a != b) kernelsOk = false;
+    }
+
+    Framebuffer scene; scene.Resize(W_WIDTH, W_HEIGHT);
+    SoftBackend sb(scene);
+    PlayFrames(400, [&](const World& w){ RenderScene(sb, w, 1200, top5); });
+    std::printf("capture: BGRA -> I420, kernel %s\n", CaptureKernelName());
+    const int sizes[2][2] = { { W_WIDTH, W_HEIGHT }, { 3840, 2160 } };
+    for(const auto &sz: sizes){
+        Framebuffer src; src.Resize(sz[0], sz[1]);
+        TileInto(scene, src);
+        std::vector<uint8_t> a(I420Size(src.w, src.h)), b(a.size());
+        long n = sz[0] >= 3840 ? 20 : 200;
+        auto t0 = BenchClock::now();
+        for(long f=0;f<n;f++) BgraToI420(src, a.data());
+        double simd = SecondsSince(t0) / (double)n;
+        t0 = BenchClock::now();
+        for(long f=0;f<n;f++) BgraToI420Scalar(src, b.data());
+        double scalar = SecondsSince(t0) / (double)n;
+        if(a != b) kernelsOk = false;
+        std::printf("  %4dx%-4d %7.3f ms/frame %7.0f Mpix/s  (scalar %.3f ms, %.2fx)\n",
+                    sz[0], sz[1], simd * 1e3, (double)sz[0] * sz[1] / simd * 1e-6, scalar * 1e3,
+                    simd > 0.0 ? scalar / simd : 0.0);
+    }
+
+    // Headless recording: every step rendered and submitted, waiting for
+    // a slot when the encoder is behind, the way trex_cli --capture does
+    CaptureWriter cap;
+    if(!cap.Start(out, W_WIDTH, W_HEIGHT, FPS)){ std::fprintf(stderr, "cannot write %s\n", out); return 1; }
+    auto t0 = BenchClock::now();
+    double submitMax = 0.0;
+    PlayFrames(frames, [&](const World& w){
+        RenderScene(sb, w, 1200, top5);
+        auto s0 = BenchClock::now();
+        cap.Submit(scene, 1, true);
+        submitMax = std::max(submitMax, SecondsSince(s0));
+    });
+    cap.Stop();
+    double secs = SecondsSince(t0);
+    const CaptureStats& cs = cap.Stats();
+    uint64_t written = cs.written, bytes = cs.bytes, convertNs = cs.convertNs;
+    long fileSize = -1;
+    if(std::FILE* f = std::fopen(out, "rb")){ std::fseek(f, 0, SEEK_END); fileSize = std::ftell(f); std::fclose(f); }
+    char header[96];
+    long headerLen = std::snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n",
+                                   W_WIDTH, W_HEIGHT, FPS);
+    bool fileOk = written == (uint64_t)frames && !cs.failed &&
+                  fileSize == headerLen + (long)(written * (6 + I420Size(W_WIDTH, W_HEIGHT)));
+    double speed = secs > 0.0 ? (double)frames / secs / FPS : 0.0;
+    std::printf("  record    %ld frames (%.1f s of play) in %.3f s, %.1fx real time, %.1f MB to %s\n",
+                frames, (double)frames / FPS, secs, speed, bytes / 1e6, out);
+    std::printf("            %.3f ms convert per frame on the encoder, submit worst %.3f ms\n",
+                written ? convertNs / 1e6 / (double)written : 0.0, submitMax * 1e3);
+
+    // Game mode: submitted without waiting and without rendering in
+    // between, far faster than the encoder can go; the surplus is dropped
+    if(!cap.Start(out, W_WIDTH, W_HEIGHT, FPS)){ std::fprintf(stderr, "cannot write %s\n", out); return 1; }
+    submitMax = 0.0;
+    for(long f=0;f<frames;f++){
+        auto s0 = BenchClock::now();
+        cap.Submit(scene, 1, false);
+        submitMax = std::max(submitMax, SecondsSince(s0));
+    }
+    cap.Stop();
+    std::printf("  flood     %ld submits, %llu written, %llu dropped, submit worst %.3f ms\n", frames,
+                (unsigned long long)cap.Stats().written.load(), (unsigned long long)cap.Stats().dropped.load(), submitMax * 1e3);
+    if(!ArgStr(argc, argv, "--out", nullptr)) std::remove(out);
+
+    std::printf("  kernels agree: %s\n", kernelsOk ? "ok" : "FAIL");
+    std::printf("  file holds every frame: %s\n", fileOk ? "ok" : "FAIL");
+    std::printf("  faster than real time: %s\n", speed >= 1.0 ? "ok" : "FAIL");
+    return kernelsOk && fileOk && speed >= 1.0 ? 0 : 1;
+}
+
+// ---------------- parallax ---------------------------
+// The 3-rect cloud of trex_render.cpp
+static void BenchCloud(DrawBackend& b, float x, float y, Color c){
+    b.FillRect((int)x, (int)y, (int)(x+38), (int)(y+18), c);
+    b.FillRect((int)(x+16), (int)(y-8), (int)(x+56), (int)(y+12), c);
+    b.FillRect((int)(x+30), (int)(y+4), (int)(x+76), (int)(y+22), c);
+}
+
+static int BenchParallax(int argc, char** argv){
+    long frames = ArgLong(argc, argv, "--frames", 2000);
+    const int period = 2 * W_WIDTH, top = 20, height = 136;
+    Framebuffer fb, ref; fb.Resize(W_WIDTH, W_HEIGHT); ref.Resize(W_WIDTH, W_HEIGHT);
+    SoftBackend sb(fb), refSb(ref);
+
+    // Sweep: every offset of the stock sky against its clouds drawn
+    // directly; a strip with shapes across the seam stands in for them
+    Pcg32 rng; rng.seed(31);
+    std::vector<float> cx(40), cy(40);
+    for(size_t i=0;i<cx.size();i++){ cx[i] = rng.uniform(-60.0f, (float)period); cy[i] = rng.uniform(10.0f, 110.0f); }
+    ParallaxLayer layer;
+    layer.Begin(period, height, top, 1.0f, COL_BG);
+    layer.Paint([&](DrawBackend& b, int dx){ for(size_t i=0;i<cx.size();i++) BenchCloud(b, cx[i] + dx, cy[i], COL_CLOUD); });
+    uint64_t mismatches = 0;
+    for(int s=0;s<period;s+=7){
+        layer.Draw(sb, (double)s, W_WIDTH);
+        FillSpanRect(ref, 0, top, W_WIDTH, top + height, ColorToPixel(COL_BG));
+        refSb.SetClip(IRect{ 0, top, W_WIDTH, top + height });
+        for(int k=-1;k<=1;k++)
+            for(size_t i=0;i<cx.size();i++) BenchCloud(refSb, cx[i] - s + k * period, cy[i] + top, COL_CLOUD);
+        refSb.ResetClip();
+        if(std::memcmp(fb.Row(top), ref.Row(top), sizeof(uint32_t) * W_WIDTH * height)) mismatches++;
+    }
+
+    // The cloud sprite RenderScene draws once per live cloud: overlapping
+    // clouds must come out as the rects do, blitted and as the
+    // rectangles the GDI backend fills instead
+    const Framebuffer& sprite = SceneBackground().cloud;
+    std::vector<SpriteRect> pieces;
+    SpriteRects(sprite, pieces);
+    Framebuffer cut; cut.Resize(W_WIDTH, W_HEIGHT);
+    SoftBackend cutSb(cut);
+    FillSpanRect(fb, 0, 0, W_WIDTH, W_HEIGHT, ColorToPixel(COL_BG));
+    FillSpanRect(ref, 0, 0, W_WIDTH, W_HEIGHT, ColorToPixel(COL_BG));
+    FillSpanRect(cut, 0, 0, W_WIDTH, W_HEIGHT, ColorToPixel(COL_BG));
+    for(size_t i=0;i<cx.size();i++){
+        int x = (int)cx[i] / 2, y = (int)cy[i] + top;     // packed into one screen so they overlap
+        BenchCloud(refSb, (float)x, (float)y, COL_CLOUD);
+        sb.Sprite(sprite, x, y - 8);
+        for(const auto &q: pieces) cutSb.FillRect(x + q.r.l, y - 8 + q.r.t, x + q.r.r, y - 8 + q.r.b, q.c);
+    }
+    bool spriteOk = fb.px == ref.px && cut.px == ref.px;
+
+    // Cost per frame as the clouds multiply: FillRects straight into the
+    // frame, one sprite blit per cloud, and the same clouds pre-rendered
+    // once into a strip and blitted
+    std::printf("parallax: %dx%d sky band, %ld frames per count\n", W_WIDTH, height, frames);
+    std::printf("  %8s %14s %14s %14s %10s\n", "clouds", "rects us", "sprites us", "layer us", "build ms");
+    double firstBlit = 0.0, lastBlit = 0.0;
+    for(int n=6;n<=6144;n*=4){
+        std::vector<float> x(n), y(n);
+        for(int i=0;i<n;i++){ x[i] = rng.uniform(-80.0f, (float)period); y[i] = rng.uniform(10.0f, 110.0f); }
+        auto t0 = BenchClock::now();
+        for(long f=0;f<frames;f++){
+            float s = (float)(f % period);
+            FillSpanRect(fb, 0, top, W_WIDTH, top + height, ColorToPixel(COL_BG));
+            for(int i=0;i<n;i++){
+                float px = x[i] - s;
+                if(px < -80.0f) px += period;
+                if(px < W_WIDTH) BenchCloud(sb, px, y[i] + top, COL_CLOUD);
+            }
+        }
+        double rects = SecondsSince(t0) / (double)frames;
+        t0 = BenchClock::now();
+        for(long f=0;f<frames;f++){
+            float s = (float)(f % period);
+            FillSpanRect(fb, 0, top, W_WIDTH, top + height, ColorToPixel(COL_BG));
+            for(int i=0;i<n;i++){
+                float px = x[i] - s;
+                if(px < -80.0f) px += period;
+                if(px < W_WIDTH) sb.Sprite(sprite, (int)px, (int)(y[i] + top) - 8);
+            }
+        }
+        double sprites = SecondsSince(t0) / (double)frames;
+        t0 = BenchClock::now();
+        ParallaxLayer l;
+        l.Begin(period, height, top, 1.0f, COL_BG);
+        l.Paint([&](DrawBackend& b, int dx){ for(int i=0;i<n;i++) BenchCloud(b, x[i] + dx, y[i], COL_CLOUD); });
+        double build = SecondsSince(t0);
+        t0 = BenchClock::now();
+        for(long f=0;f<frames;f++) l.Draw(sb, (double)(f % period), W_WIDTH);
+        double blit = SecondsSince(t0) / (double)frames;
+        if(n == 6) firstBlit = blit;
+        lastBlit = blit;
+        std::printf("  %8d %14.2f %14.2f %14.2f %10.2f\n", n, rects * 1e6, sprites * 1e6, blit * 1e6, build * 1e3);
+    }
+    // same band, same copy: allow timer noise, not a trend
+    bool flat = lastBlit <= firstBlit * 2.0 + 2e-6;
+    std::printf("  wrapped blit matches direct drawing: %llu of %d offsets differ %s\n", (unsigned long long)mismatches,
+                (period + 6) / 7, mismatches ? "FAIL" : "ok");
+    std::printf("  overlapping cloud sprites match the rects (%zu GDI rects per cloud): %s\n", pieces.size(), spriteOk ? "ok" : "FAIL");
+    std::printf("  layer cost independent of cloud count: %s\n", flat ? "ok" : "FAIL");
+    return !mismatches && spriteOk && flat ? 0 : 1;
+}
+
+// ---------------- telemetry --------------------------
+// Self-test: every field of a synthetic sample is a function of k, so a
+// reader can tell a torn copy from a whole one. One thread publishes
+// flat out into a real segment while readers on their own mappings poll
+// flat out. --serve instead plays a headless game at 60 fps and
+// publishes like main.cpp does, for trying trex_top against.
+static TelemetrySample SyntheticSample(uint64_t k){
+    TelemetrySample t = {};
+    t.updatedNs = k * 16666667ull;
+    t.frames = k;
+    t.simSteps = k * 3 + 1;
+    t.lateSteps = k ^ 0x5555555555555555ull;
+    t.runs = k / 7;
+    t.state = (int32_t)(k % 3);
+    t.score = (int32_t)(k * 5);
+    t.highScore = (int32_t)~k;
+    t.obstacles = (uint32_t)(k * 11);
+    t.particles = (uint32_t)(k >> 3);
+    t.allocFrames = (uint32_t)(k * 13);
+    t.fps = (float)(k & 0xFFFF);
+    t.frameP50Ms = (float)((k >> 4) & 0xFFFF);
+    t.frameP99Ms = (float)((k >> 8) & 0xFFFF);
+    t.frameMaxMs = (float)((k >> 12) & 0xFFFF);
+    t.renderP99Ms = (float)((k >> 16) & 0xFFFF);
+    t.flags = (uint32_t)(k * 0x9E3779B9u);
+    return t;
+}
+
+static bool SampleWhole(const TelemetrySample& t){
+    TelemetrySample e = SyntheticSample(t.frames);
+    e.publishes = t.publishes;
+    return !std::memcmp(&e, &t, sizeof(e));
+}
+
+static int ServeTelemetry(double seconds){
+    TelemetryWriter tw;
+    std::string name = TelemetryName(CurrentPid());
+    if(!tw.Open(name)){ std::printf("telemetry: cannot create %s\n", name.c_str()); return 1; }
+    std::printf("telemetry: serving %s for %.0f s (trex_top --pid %u)\n", name.c_str(), seconds, (unsigned)CurrentPid());
+    std::fflush(stdout);
+
+    SteadyClock clock;
+    FramePacer pacer(clock, DT);
+    Framebuffer fb; fb.Resize(W_WIDTH, W_HEIGHT);
+    SoftBackend sb(fb);
+    ParticleSystem fx;
+    std::vector<int> top5;
+    World w; ResetWorld(w, 7);
+    w.state = GameState::PLAYING;
+    uint64_t steps = 0, runs = 1, frames = 0, fpsFrames = 0;
+    int high = 0;
+    float fps = 0.0f;
+    HistSummary iv = {}, rc = {};
+    const uint64_t f = clock.Frequency();
+    uint64_t t0 = clock.Now(), fpsSince = t0;
+    pacer.Reset();
+    while(clock.Now() - t0 < (uint64_t)(seconds * (double)f)){
+        int n = pacer.Advance();
+        for(int i=0;i<n;i++){
+            ApplyInput(w, ReflexPolicy(w));
+            steps++;
+            if(UpdateGame(w, DT)){
+                high = std::max(high, w.score);
+                ResetWorld(w, 7 + runs++);
+                w.state = GameState::PLAYING;
+            }
+            fx.Observe(w);
+            fx.Update(DT);
+        }
+        pacer.RenderStart();
+        RenderScene(sb, w, high, top5, &fx);
+        pacer.RenderEnd();
+        frames++;
+        uint64_t now = clock.Now();
+        if(now - fpsSince >= f){
+            fps = (float)((double)(frames - fpsFrames) * (double)f / (double)(now - fpsSince));
+            fpsFrames = frames; fpsSince = now;
+        }
+        if(frames % (FPS / 2) == 1){ iv = pacer.Stats().interval.Summary(); rc = pacer.Stats().render.Summary(); }
+        TelemetrySample t = {};
+        t.updatedNs = TelemetryNowNs();
+        t.frames = frames; t.simSteps = steps; t.runs = runs;
+        t.state = (int32_t)w.state; t.score = w.score; t.highScore = high;
+        t.obstacles = (uint32_t)w.obs.size(); t.particles = (uint32_t)fx.Live();
+        t.fps = fps;
+        t.frameP50Ms = iv.p50 / 1000.0f; t.frameP99Ms = iv.p99 / 1000.0f;
+        t.frameMaxMs = iv.max / 1000.0f; t.renderP99Ms = rc.p99 / 1000.0f;
+        t.flags = TELEM_SOFT_RENDER;
+        tw.Publish(t);
+        std::this_thread::sleep_until(BenchClock::now() + std::chrono::microseconds(
+            (long)std::max(0.0, (DT - pacer.Accumulated()) * 1e6)));
+    }
+    return 0;
+}
+
+static int BenchTelemetry(int argc, char** argv){
+    double seconds = (double)ArgLong(argc, argv, "--seconds", 2);
+    for(int i=0;i<argc;i++) if(!std::strcmp(argv[i], "--serve")) return ServeTelemetry((double)ArgLong(argc, argv, "--seconds", 60));
+
+    std::string name = TelemetryName(CurrentPid());
+    TelemetryWriter tw;
+    if(!tw.Open(name)){ std::printf("telemetry: cannot create %s\n", name.c_str()); return 1; }
+    TelemetryReader probe;
+    bool opened = probe.Open(name);
+    const long loops = 2000000;
+
+    // Uncontended costs
+    auto t0 = BenchClock::now();
+    for(long k=0;k<loops;k++) tw.Publish(SyntheticSample((uint64_t)k));
+    double pubAlone = SecondsSince(t0) / (double)loops;
+    TelemetrySample s;
+    uint64_t sink = 0;
+    t0 = BenchClock::now();
+    for(long k=0;k<loops;k++){ probe.Read(s); sink += s.frames; }
+    double readAlone = SecondsSince(t0) / (double)loops;
+    bool firstOk = opened && SampleWhole(s) && s.publishes == (uint64_t)loops;
+
+    // Contended: one writer, READERS pollers, each on its own mapping
+    const int READERS = 2;
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> published{0};
+    double pubBusy = 0.0;
+    std::thread writer([&](){
+        uint64_t k = (uint64_t)loops;
+        auto w0 = BenchClock::now();
+        while(!done.load(std::memory_order_relaxed)) tw.Publish(SyntheticSample(k++));
+        pubBusy = SecondsSince(w0) / (double)(k - (uint64_t)loops);
+        published = k - (uint64_t)loops;
+    });
+    struct ReaderTally { uint64_t reads = 0, retries = 0, failed = 0, torn = 0, backwards = 0; };
+    ReaderTally tally[READERS];
+    std::vector<std::thread> readers;
+    for(int r=0;r<READERS;r++){
+        readers.emplace_back([&, r](){
+            TelemetryReader tr;
+            ReaderTally& c = tally[r];
+            if(!tr.Open(name)){ c.failed++; return; }
+            uint64_t last = 0;
+            TelemetrySample t;
+            while(!done.load(std::memory_order_relaxed)){
+                uint32_t retries = 0;
+                if(!tr.Read(t, &retries)){ c.failed++; continue; }
+                c.reads++; c.retries += retries;
+                if(!SampleWhole(t)) c.torn++;
+                if(t.publishes < last) c.backwards++;
+                last = t.publishes;
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds((long)(seconds * 1000.0)));
+    done = true;
+    writer.join();
+    for(auto &t: readers) t.join();
+    tw.Close();
+    TelemetryReader gone;
+    bool unlinked = !gone.Open(name);
+
+    ReaderTally sum;
+    for(const auto &c: tally){
+        sum.reads += c.reads; sum.retries += c.retries; sum.failed += c.failed;
+        sum.torn += c.torn; sum.backwards += c.backwards;
+    }
+    std::printf("telemetry: %zu-byte sample, %zu-byte segment %s\n", sizeof(TelemetrySample), sizeof(TelemetryBlock), name.c_str());
+    std::printf("  alone      publish %.1f ns, read %.1f ns\n", pubAlone * 1e9, readAlone * 1e9);
+    std::printf("  contended  %.1f s, %llu publishes (%.1f ns each), %d readers: %llu reads, %llu retried\n",
+                seconds, (unsigned long long)published.load(), pubBusy * 1e9, READERS, (unsigned long long)sum.reads,
+                (unsigned long long)sum.retries);
+    std::printf("  (a game publishes 60 times a second; ~%.4f%% of a frame at the contended cost)\n",
+                pubBusy * 1e9 / (DT * 1e9) * 100.0);
+    bool ok = firstOk && !sum.torn && !sum.backwards && !sum.failed && sum.reads && unlinked;
+    std::printf("  reader sees the last publish: %s\n", firstOk ? "ok" : "FAIL");
+    std::printf("  torn reads: %llu, out-of-order reads: %llu, reads given up: %llu %s\n",
+                (unsigned long long)sum.torn, (unsigned long long)sum.backwards, (unsigned long long)sum.failed,
+                sum.torn || sum.backwards || sum.failed ? "FAIL" : "ok");
+    std::printf("  segment removed on Close: %s\n", unlinked ? "ok" : "FAIL");
+    (void)sink;
+    return ok ? 0 : 1;
+}
+
+// ---------------- spawn ------------------------------
+// Each tier sampled `draws` times from one PCG stream. The alias pick is
+// checked against the weights (4 sigma per type) and timed against the
+// linear inverse-CDF scan over the same baked cumulative weights.
+static ObType ScanCumulative(const BakedTier& t, uint32_t draw){
+    uint64_t r = ((uint64_t)draw * t.cumulative[OBTYPE_COUNT - 1]) >> 32;
+    int i = 0;
+    while(i < OBTYPE_COUNT - 1 && r >= t.cumulative[i]) i++;
+    return (ObType)i;
+}
+
+static int BenchSpawn(int argc, char** argv){
+    long draws = ArgLong(argc, argv, "--draws", 20000000);
+    const char* path = ArgStr(argc, argv, "--table", nullptr);
+    SpawnTable loaded;
+    const SpawnTable* st = &DEFAULT_SPAWN_TABLE;
+    if(path){
+        if(!LoadSpawnTable(path, loaded)) return 2;
+        st = &loaded;
+    }
+    PrintSpawnTable(stdout, *st);
+    bool ok = true;
+    std::printf("  %5s %10s %10s %10s\n", "tier", "alias ns", "scan ns", "max dev");
+    for(int t=0;t<st->tierCount;t++){
+        const BakedTier& b = st->tiers[t];
+        uint64_t seen[OBTYPE_COUNT] = {}, scanSeen[OBTYPE_COUNT] = {};
+        Pcg32 rng; rng.seed(11, (uint64_t)t);
+        auto t0 = BenchClock::now();
+        for(long i=0;i<draws;i++) seen[(int)SpawnTable::Sample(b, rng.next())]++;
+        double alias = SecondsSince(t0);
+        rng.seed(11, (uint64_t)t);
+        t0 = BenchClock::now();
+        for(long i=0;i<draws;i++) scanSeen[(int)ScanCumulative(b, rng.next())]++;
+        double scan = SecondsSince(t0);
+
+        double total = (double)b.cumulative[OBTYPE_COUNT - 1], worst = 0.0;
+        uint32_t prev = 0;
+        for(int i=0;i<OBTYPE_COUNT;i++){
+            double p = (double)(b.cumulative[i] - prev) / total;
+            prev = b.cumulative[i];
+            double sigma = std::sqrt((double)draws * p * (1.0 - p)) + 1.0;
+            double dev = std::fabs((double)seen[i] - (double)draws * p) / sigma;
+            if(p == 0.0 && seen[i]) dev = 1e9;
+            worst = std::max(worst, dev);
+            if(dev > 4.0 || (p == 0.0) != (scanSeen[i] == 0)) ok = false;
+        }
+        std::printf("  %5d %10.2f %10.2f %8.2f sd\n", b.fromScore, alias * 1e9 / (double)draws,
+                    scan * 1e9 / (double)draws, worst);
+    }
+    std::printf("  frequencies match weights: %s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+// ---------------- rollback ---------------------------
+// Two sessions exchange packets through a queue that delays them
+// `latency` (+0..2) frames and drops lossPct%, plus every packet to
+// burstTo sent during [burstFrom, burstFrom + burstTicks). Prints each
+// peer's stats; false on a desync or differing final checksums.
+struct RaceLink {
+    long latency = 5;
+    int  lossPct = 0;
+    int  burstTo = -1;
+    long burstFrom = 0, burstTicks = 0;
+};
+
+template<class F>
+static bool RaceOverLink(uint64_t seed, uint32_t target, const RaceLink& l, Pcg32& rng, F input){
+    std::unique_ptr<RollbackSession> s[2] = { std::unique_ptr<RollbackSession>(new RollbackSession()),
+                                              std::unique_ptr<RollbackSession>(new RollbackSession()) };
+    struct InFlight { long due; int to; RacePacket p; };
+    std::vector<InFlight> wire;
+    for(int i=0;i<2;i++) s[i]->Start(seed, i, 1);
+    long tick = 0;
+    while(s[0]->ConfirmedFrame() < target || s[1]->ConfirmedFrame() < target){
+        for(size_t k=0;k<wire.size();){
+            if(wire[k].due > tick){ k++; continue; }
+            s[wire[k].to]->OnPacket(wire[k].p);
+            wire[k] = wire.back(); wire.pop_back();
+        }
+        for(int i=0;i<2;i++){
+            RollbackSession& r = *s[i];
+            if(r.Frame() < target && r.CanAdvance()){
+                r.AddLocalInput(input(i, r.Frame()));
+                r.Advance();
+            }
+            else if(r.Frame() < target) r.Advance();       // counted as a stall
+            InFlight f;
+            r.MakePacket(f.p);
+            f.to = i ^ 1;
+            f.due = tick + l.latency + rng.range(0, 2);
+            bool burst = f.to == l.burstTo && tick >= l.burstFrom && tick < l.burstFrom + l.burstTicks;
+            if(!burst && (int)rng.range(0, 99) >= l.lossPct) wire.push_back(f);
+        }
+        tick++;
+    }
+    bool ok = true;
+    uint32_t sum[2];
+    for(int i=0;i<2;i++){
+        const RollbackStats& st = s[i]->Stats();
+        const RaceSnapshot& fin = s[i]->ConfirmedSnapshot();
+        sum[i] = WorldChecksum(fin.p[0]) * 31u + WorldChecksum(fin.p[1]);
+        HistSummary h = st.resimUs.Summary();
+        std::printf("    peer %d: %llu frames, %llu stalls, %llu rollbacks (max %u frames, p99 %llu us), "
+                    "%llu mispredicted, %llu checks, %llu desyncs\n", i,
+                    (unsigned long long)st.frames, (unsigned long long)st.stalls, (unsigned long long)st.rollbacks,
+                    st.maxResim, (unsigned long long)h.p99, (unsigned long long)st.mispredicted,
+                    (unsigned long long)st.checks, (unsigned long long)st.desyncs);
+        if(st.desyncs || !st.checks) ok = false;
+    }
+    if(sum[0] != sum[1]) ok = false;
+    std::printf("    final checksums %08x %08x: %s\n", sum[0], sum[1], ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// Part 1: reflex bots race; at every frame the state 8 frames back is
+// restored and re-simulated with the recorded inputs (snapshots saved
+// on the way, as RollbackSession does). Restarts when both are dead.
+// Part 2: two sessions over a link that delays packets `latency`
+// frames and drops 10%, with bots that keep the predictions wrong.
+// Part 3: a one-way loss burst longer than RB_MAX_PREDICT frames.
+// Both peers must agree on every checksum and at the end.
+static int BenchRollback(int argc, char** argv){
+    long frames = ArgLong(argc, argv, "--frames", 20000);
+    long latency = ArgLong(argc, argv, "--latency", 5);
+    const int BACK = 8;
+    std::unique_ptr<RaceState> race(new RaceState()), scratch(new RaceState());
+    std::vector<RaceSnapshot> snaps(BACK + 1);
+    std::vector<uint8_t> inputs(2 * (BACK + 1));
+    std::vector<uint32_t> ns;
+    ns.reserve((size_t)frames);
+    uint64_t seed = 1;
+    ResetRace(*race, seed);
+    for(long f=0;f<frames;f++){
+        int slot = (int)(race->frame % (BACK + 1));
+        SaveRace(*race, snaps[slot]);
+        for(int p=0;p<2;p++){
+            TickInput in = ReflexPolicy(race->p[p]);
+            inputs[slot * 2 + p] = (uint8_t)((in.jump ? RB_JUMP : 0) | (in.duck ? RB_DUCK : 0));
+        }
+        StepRace(*race, &inputs[slot * 2]);
+        if(race->frame >= (uint32_t)BACK){
+            uint32_t from = race->frame - BACK;
+            auto t0 = BenchClock::now();
+            LoadRace(snaps[from % (BACK + 1)], *scratch);
+            for(uint32_t g=from;g<race->frame;g++){
+                StepRace(*scratch, &inputs[(g % (BACK + 1)) * 2]);
+                SaveRace(*scratch, snaps[(g + 1) % (BACK + 1)]);
+            }
+            ns.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - t0).count());
+        }
+        if(RaceOver(*race)){ ResetRace(*race, ++seed); }
+    }
+    std::sort(ns.begin(), ns.end());
+    auto pct = [&](double p){ return ns.empty() ? 0.0 : ns[std::min(ns.size() - 1, (size_t)(p / 100.0 * (double)ns.size()))] / 1000.0; };
+    double p99 = pct(99);
+    std::printf("rollback: snapshot %zu bytes per race; restore + re-simulate %d frames (2 players), %zu samples\n",
+                sizeof(RaceSnapshot), BACK, ns.size());
+    std::printf("  p50 %.2f us  p99 %.2f us  max %.2f us  (budget 1000 us) %s\n",
+                pct(50), p99, ns.empty() ? 0.0 : ns.back() / 1000.0, p99 < 1000.0 ? "ok" : "FAIL");
+
+    // Part 2
+    Pcg32 rng; rng.seed(5, 5);
+    RaceLink lossy;
+    lossy.latency = latency; lossy.lossPct = 10;
+    bool ok = p99 < 1000.0;
+    uint32_t target = (uint32_t)std::min(frames, 6000L);
+    std::printf("  lossy link (%ld frames latency, 10%% loss)\n", latency);
+    ok &= RaceOverLink(9, target, lossy, rng, [&](int, uint32_t){
+        return (uint8_t)((rng.range(0, 99) < 4 ? RB_JUMP : 0) | (rng.range(0, 99) < 20 ? RB_DUCK : 0));
+    });
+
+    // Part 3: B's packets to A are all lost for 30 ticks while B ducks
+    // at frame n and jumps at n + 16, so the catch-up packet after the
+    // burst corrects guesses more than RB_MAX_PREDICT frames old
+    for(uint32_t n: { 100u, 150u, 400u }){
+        RaceLink burst;
+        burst.latency = 2; burst.burstTo = 0; burst.burstFrom = n; burst.burstTicks = 30;
+        std::printf("  one-way loss burst, B -> A ticks %u..%u\n", n, n + 29);
+        ok &= RaceOverLink(9, 1200, burst, rng, [&](int player, uint32_t f){
+            if(player == 0) return (uint8_t)0;
+            return (uint8_t)((f == n + 16 ? RB_JUMP : 0) | (f >= n && f < n + 16 ? RB_DUCK : 0));
+        });
+    }
+    std::printf("  every linked race agreed: %s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+// ---------------- registry ---------------------------
+struct BenchEntry { const char* name; int (*run)(int, char**); const char* help; };
+static const BenchEntry BENCHES[] = {
+    { "soa", BenchSoa, "AoS vs SoA obstacle store (move/despawn/hit)" },
+    { "fb", BenchFb, "software framebuffer render cost per frame" },
+    { "damage", BenchDamage, "dirty-rectangle pixels per frame + correctness check" },
+    { "draw", BenchDraw, "per-frame brush/font creations via the counting backend" },
+    { "stress", BenchStress, "thousands of entities: update/render/broadphase scaling" },
+    { "pacing", BenchPacing, "fixed-step pacer on a fake clock: steps/frame, jitter" },
+    { "rollback", BenchRollback, "two-player rollback: 8-frame re-sim cost, lossy-link agreement" },
+    { "spawn", BenchSpawn, "spawn table sampling: alias vs cumulative scan, frequency check" },
+    { "stream", BenchStream, "validated obstacle stream: chunk cost, feed cost, survivability audit" },
+    { "particles", BenchParticles, "50k SoA particles: update/draw ns per particle, 60 fps check" },
+    { "palette", BenchPalette, "day/night LUT remap at 900x360 and 4K, fade on the damage path" },
+    { "scale", BenchScale, "output scaler: nearest/bilinear to 1080p..4K, damage-only rescale" },
+    { "alloc", BenchAlloc, "heap calls per phase of the game frame; fails if a steady frame allocates" },
+    { "simthread", BenchSimThread, "sim thread + triple buffer under input flood and render stalls" },
+    { "capture", BenchCapture, "BGRA -> I420 kernels and headless Y4M recording speed" },
+    { "parallax", BenchParallax, "cloud rects vs cloud sprites vs one sky layer as clouds multiply" },
+    { "telemetry", BenchTelemetry, "seqlocked shared-memory counters: publish/read cost, torn-read check" },
+};
+
+int main(int argc, char** argv){
+    if(argc >= 2){
+        for(const auto &b: BENCHES) if(!std::strcmp(argv[1], b.name)) return b.run(argc - 2, argv + 2);
+    }
+    std::printf("usage: trex_bench <name> [options]\n");
+    for(const auto &b: BENCHES) std::printf("  %-10s %s\n", b.name, b.help);
+    return (argc >= 2 && !std::strcmp(argv[1], "--list")) ? 0 : 2;
+}
@@ -0,0 +1,42 @@
+// ------------------------------------------------------------------
+// File: trex_bits.h
+// Portable bit scans (GCC/Clang builtins, MSVC _BitScan*)
+// ------------------------------------------------------------------
+//  - HighBit: index of the highest set bit, for the log-bucketed
+//    histograms (trex_pacing.cpp, trex_runlog.cpp)
+//  - LowBit: index of the lowest set bit, for SIMD compare masks
+//  - the argument must not be 0
+// ------------------------------------------------------------------
+#ifndef TREX_BITS_H
+#define TREX_BITS_H
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+  #include <intrin.h>
+#endif
+
+inline int HighBit(uint64_t v){
+#if defined(_MSC_VER) && defined(_WIN64)
+    unsigned long i; _BitScanReverse64(&i, v);
+    return (int)i;
+#elif defined(_MSC_VER)
+    unsigned long i;
+    if(_BitScanReverse(&i, (unsigned long)(v >> 32))) return (int)i + 32;
+    _BitScanReverse(&i, (unsigned long)v);
+    return (int)i;
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+inline int LowBit(uint32_t v){
+#if defined(_MSC_VER)
+    unsigned long i; _BitScanForward(&i, (unsigned long)v);
+    return (int)i;
+#else
+    return __builtin_ctz(v);
+#endif
+}
+
+#endif
@@ -0,0 +1,225 @@
+// ------------------------------------------------------------------
+// File: trex_capture.cpp
+// BGRA -> I420 kernels (SSE2 / scalar) and the Y4M encoder thread
+// ------------------------------------------------------------------
+#include "trex_capture.h"
+#include <chrono>
+#include <cstring>
+
+#if !defined(TREX_SIMD_SCALAR) && (defined(__SSE2__) || defined(_M_X64))
+  #define TREX_CAP_SSE2 1
+  #include <emmintrin.h>
+#endif
+
+const char* CaptureKernelName(){
+#if defined(TREX_CAP_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+size_t I420Size(int w, int h){
+    size_t cw = (size_t)(w + 1) / 2, ch = (size_t)(h + 1) / 2;
+    return (size_t)w * h + 2 * cw * ch;
+}
+
+// ---------------- Conversion -------------------------
+// BT.601 limited range, 8-bit fixed point:
+//   Y =  ( 66 R + 129 G +  25 B + 128) >> 8 +  16
+//   U =  (-38 R -  74 G + 112 B + 128) >> 8 + 128
+//   V =  (112 R -  94 G -  18 B + 128) >> 8 + 128
+// U and V from the rounded mean of each 2x2 block; odd edges repeat the
+// last column / row.
+static inline uint8_t LumaOf(uint32_t p){
+    int b = p & 0xFF, g = (p >> 8) & 0xFF, r = (p >> 16) & 0xFF;
+    return (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+// Rows r0/r1 (r1 may equal r0), columns [x, w) with x even. y1 is null
+// when r1 is only a stand-in for a missing last row.
+static void ConvertSpanScalar(const uint32_t* r0, const uint32_t* r1, int x, int w,
+                              uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v){
+    for(;x<w;x+=2){
+        int x1 = x + 1 < w ? x + 1 : x;
+        const uint32_t p[4] = { r0[x], r0[x1], r1[x], r1[x1] };
+        y0[x] = LumaOf(p[0]);
+        if(x + 1 < w) y0[x + 1] = LumaOf(p[1]);
+        if(y1){
+            y1[x] = LumaOf(p[2]);
+            if(x + 1 < w) y1[x + 1] = LumaOf(p[3]);
+        }
+        int sb = 2, sg = 2, sr = 2;
+        for(uint32_t q: p){ sb += q & 0xFF; sg += (q >> 8) & 0xFF; sr += (q >> 16) & 0xFF; }
+        int b = sb >> 2, g = sg >> 2, r = sr >> 2;
+        u[x / 2] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        v[x / 2] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+}
+
+#if defined(TREX_CAP_SSE2)
+// 4 pixels -> 4 int32 lumas. madd pairs (B,G) and (R,A) per pixel; the
+// 64-bit shift folds the pair so lanes 0 and 2 hold the sums.
+static inline __m128i Luma4(__m128i px, __m128i k){
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), k);
+    __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(px, zero), k);
+    lo = _mm_shuffle_epi32(_mm_add_epi32(lo, _mm_srli_epi64(lo, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+    hi = _mm_shuffle_epi32(_mm_add_epi32(hi, _mm_srli_epi64(hi, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+    __m128i s = _mm_unpacklo_epi64(lo, hi);
+    return _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(s, _mm_set1_epi32(128)), 8), _mm_set1_epi32(16));
+}
+
+// 4 pixels of two rows -> 2 rounded 2x2 means, as 16-bit BGRA lanes
+static inline __m128i Mean2(__m128i p0, __m128i p1){
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(p0, zero), _mm_unpacklo_epi8(p1, zero));
+    __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(p0, zero), _mm_unpackhi_epi8(p1, zero));
+    lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+    hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+    __m128i s = _mm_unpacklo_epi64(lo, hi);
+    return _mm_srli_epi16(_mm_add_epi16(s, _mm_set1_epi16(2)), 2);
+}
+
+// Two Mean2 results -> 4 chroma bytes in the low 32 bits
+static inline int Chroma4(__m128i m0, __m128i m1, __m128i k){
+    __m128i a = _mm_madd_epi16(m0, k), b = _mm_madd_epi16(m1, k);
+    a = _mm_shuffle_epi32(_mm_add_epi32(a, _mm_srli_epi64(a, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+    b = _mm_shuffle_epi32(_mm_add_epi32(b, _mm_srli_epi64(b, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+    __m128i c = _mm_unpacklo_epi64(a, b);
+    c = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(c, _mm_set1_epi32(128)), 8), _mm_set1_epi32(128));
+    c = _mm_packs_epi32(c, c);
+    return _mm_cvtsi128_si32(_mm_packus_epi16(c, c));
+}
+#endif
+
+static void Convert(const Framebuffer& fb, uint8_t* out, bool simd){
+    const int w = fb.w, h = fb.h, cw = (w + 1) / 2;
+    uint8_t* yp = out;
+    uint8_t* up = out + (size_t)w * h;
+    uint8_t* vp = up + (size_t)cw * ((h + 1) / 2);
+#if defined(TREX_CAP_SSE2)
+    // lanes are B,G,R,A per pixel
+    const __m128i kY = _mm_setr_epi16(25, 129, 66, 0, 25, 129, 66, 0);
+    const __m128i kU = _mm_setr_epi16(112, -74, -38, 0, 112, -74, -38, 0);
+    const __m128i kV = _mm_setr_epi16(-18, -94, 112, 0, -18, -94, 112, 0);
+#endif
+    for(int y=0;y<h;y+=2){
+        const uint32_t* r0 = fb.Row(y);
+        const uint32_t* r1 = y + 1 < h ? fb.Row(y + 1) : r0;
+        uint8_t* y0 = yp + (size_t)y * w;
+        uint8_t* y1 = y + 1 < h ? y0 + w : nullptr;
+        uint8_t* u = up + (size_t)(y / 2) * cw;
+        uint8_t* v = vp + (size_t)(y / 2) * cw;
+        int x = 0;
+#if defined(TREX_CAP_SSE2)
+        if(simd){
+            for(;x+8<=w;x+=8){
+                __m128i a0 = _mm_loadu_si128((const __m128i*)(r0 + x));
+                __m128i b0 = _mm_loadu_si128((const __m128i*)(r0 + x + 4));
+                __m128i a1 = _mm_loadu_si128((const __m128i*)(r1 + x));
+                __m128i b1 = _mm_loadu_si128((const __m128i*)(r1 + x + 4));
+                __m128i l = _mm_packs_epi32(Luma4(a0, kY), Luma4(b0, kY));
+                _mm_storel_epi64((__m128i*)(y0 + x), _mm_packus_epi16(l, l));
+                if(y1){
+                    l = _mm_packs_epi32(Luma4(a1, kY), Luma4(b1, kY));
+                    _mm_storel_epi64((__m128i*)(y1 + x), _mm_packus_epi16(l, l));
+                }
+                __m128i ma = Mean2(a0, a1), mb = Mean2(b0, b1);
+                int cu = Chroma4(ma, mb, kU), cv = Chroma4(ma, mb, kV);
+                std::memcpy(u + x / 2, &cu, 4);
+                std::memcpy(v + x / 2, &cv, 4);
+            }
+        }
+#else
+        (void)simd;
+#endif
+        ConvertSpanScalar(r0, r1, x, w, y0, y1, u, v);
+    }
+}
+
+void BgraToI420(const Framebuffer& fb, uint8_t* out){ Convert(fb, out, true); }
+void BgraToI420Scalar(const Framebuffer& fb, uint8_t* out){ Convert(fb, out, false); }
+
+// ---------------- CaptureWriter ----------------------
+bool CaptureWriter::Start(const char* path, int w, int h, int fps){
+    Stop();
+    if(w <= 0 || h <= 0) return false;
+    file_ = std::fopen(path, "wb");
+    if(!file_) return false;
+    // C420jpeg: chroma sited between the four luma samples it averages
+    if(std::fprintf(file_, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n", w, h, fps) < 0){
+        std::fclose(file_); file_ = nullptr;
+        return false;
+    }
+    w_ = w; h_ = h;
+    planes_.resize(I420Size(w, h));
+    uint8_t i;
+    while(free_.TryPop(i)) {}
+    while(ready_.TryPop(i)) {}
+    for(int k=0;k<CAPTURE_SLOTS;k++){ slots_[k].fb.Resize(w, h); free_.TryPush((uint8_t)k); }
+    stats_.submitted = 0; stats_.dropped = 0; stats_.written = 0;
+    stats_.bytes = 0; stats_.convertNs = 0; stats_.failed = 0;
+    stop_ = false;
+    worker_ = std::thread(&CaptureWriter::Run, this);
+    return true;
+}
+
+void CaptureWriter::Stop(){
+    if(!worker_.joinable()) return;
+    { std::lock_guard<std::mutex> lk(mutex_); stop_ = true; }
+    wake_.notify_one();
+    worker_.join();
+    if(std::fclose(file_) != 0) stats_.failed++;
+    file_ = nullptr;
+}
+
+bool CaptureWriter::Submit(const Framebuffer& fb, uint32_t repeat, bool wait){
+    if(!Active() || !repeat || fb.w != w_ || fb.h != h_) return false;
+    uint8_t i;
+    while(!free_.TryPop(i)){
+        if(!wait){ stats_.dropped++; return false; }
+        std::unique_lock<std::mutex> lk(mutex_);
+        room_.wait_for(lk, std::chrono::milliseconds(1), [this]{ return !free_.Empty(); });
+    }
+    Slot& s = slots_[i];
+    std::memcpy(s.fb.px.data(), fb.px.data(), fb.px.size() * sizeof(uint32_t));
+    s.repeat = repeat;
+    ready_.TryPush(i);          // can't be full: only CAPTURE_SLOTS indices exist
+    stats_.submitted++;
+    wake_.notify_one();
+    return true;
+}
+
+void CaptureWriter::Run(){
+    for(;;){
+        uint8_t i;
+        if(ready_.TryPop(i)){
+            Encode(slots_[i]);
+            free_.TryPush(i);
+            room_.notify_one();
+            continue;
+        }
+        if(stop_.load() && ready_.Empty()) break;
+        // Submit doesn't take the mutex, so a wakeup can be missed; the
+        // timeout bounds that to a few milliseconds.
+        std::unique_lock<std::mutex> lk(mutex_);
+        wake_.wait_for(lk, std::chrono::milliseconds(4), [this]{ return stop_.load() || !ready_.Empty(); });
+    }
+}
+
+void CaptureWriter::Encode(Slot& s){
+    if(stats_.failed) return;
+    auto t0 = std::chrono::steady_clock::now();
+    BgraToI420(s.fb, planes_.data());
+    stats_.convertNs += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+    for(uint32_t r=0;r<s.repeat;r++){
+        if(std::fwrite("FRAME\n", 1, 6, file_) != 6 ||
+           std::fwrite(planes_.data(), 1, planes_.size(), file_) != planes_.size()){
+            stats_.failed++;
+            return;
+        }
+        stats_.written++;
+        stats_.bytes += 6 + planes_.size();
+    }
+}
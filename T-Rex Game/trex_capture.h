@@ -0,0 +1,97 @@
+// ------------------------------------------------------------------
+// File: trex_capture.h
+// Gameplay capture: presented frames to an uncompressed Y4M file
+// ------------------------------------------------------------------
+//  - CaptureWriter owns a fixed pool of CAPTURE_SLOTS frame buffers.
+//    Submit() copies the finished BGRA frame into a free slot and hands
+//    it to the encoder thread through an SpscQueue; the slot comes back
+//    through a second queue once written
+//  - the game submits with wait = false: a full pool drops the frame
+//    (counted) instead of stalling the frame. Headless tools pass
+//    wait = true and get every frame, as fast as the disk takes them
+//  - the encoder converts BGRA to I420 (BT.601, limited range, each
+//    chroma sample the average of its 2x2 block) with an SSE2 kernel,
+//    then writes one FRAME per simulation step the frame stood for, so
+//    the file plays back at game speed whatever the paint rate was
+//  - no allocation after Start(); the pool and the I420 plane buffer
+//    are sized there
+// ------------------------------------------------------------------
+#ifndef TREX_CAPTURE_H
+#define TREX_CAPTURE_H
+
+#include "trex_fb.h"
+#include "trex_spsc.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static const int CAPTURE_SLOTS = 8;    // frames in flight, power of two
+
+// I420 planes for a w x h frame: Y is w x h, U and V (w+1)/2 x (h+1)/2
+size_t I420Size(int w, int h);
+
+// BGRA -> I420, planes back to back in `out` (I420Size bytes). The SIMD
+// and scalar versions produce identical bytes.
+void BgraToI420(const Framebuffer& fb, uint8_t* out);
+void BgraToI420Scalar(const Framebuffer& fb, uint8_t* out);
+const char* CaptureKernelName();
+
+// Written by the encoder thread (dropped: by Submit), readable anywhere.
+struct CaptureStats {
+    std::atomic<uint64_t> submitted{0};   // frames accepted by Submit
+    std::atomic<uint64_t> dropped{0};     // Submit found no free slot
+    std::atomic<uint64_t> written{0};     // FRAMEs in the file, repeats included
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> convertNs{0};   // time in BgraToI420
+    std::atomic<uint64_t> failed{0};      // short writes; the capture stops writing
+};
+
+class CaptureWriter {
+public:
+    CaptureWriter() {}
+    ~CaptureWriter(){ Stop(); }
+
+    // Opens path, writes the stream header and starts the encoder.
+    // False if the file can't be created or w/h are not positive.
+    bool Start(const char* path, int w, int h, int fps);
+    // Writes everything still queued, closes the file and joins.
+    void Stop();
+    bool Active() const { return worker_.joinable(); }
+
+    // Game thread. `repeat` = steps this frame covers (0 = nothing to do).
+    // False if the frame was dropped or doesn't match the stream size.
+    bool Submit(const Framebuffer& fb, uint32_t repeat = 1, bool wait = false);
+
+    const CaptureStats& Stats() const { return stats_; }
+
+private:
+    CaptureWriter(const CaptureWriter&);
+    CaptureWriter& operator=(const CaptureWriter&);
+
+    struct Slot {
+        Framebuffer fb;
+        uint32_t    repeat = 0;
+    };
+
+    void Run();
+    void Encode(Slot& s);
+
+    std::FILE*  file_ = nullptr;
+    int         w_ = 0, h_ = 0;
+    Slot        slots_[CAPTURE_SLOTS];
+    std::vector<uint8_t> planes_;          // encoder only
+
+    SpscQueue<uint8_t, CAPTURE_SLOTS> free_;    // encoder -> game
+    SpscQueue<uint8_t, CAPTURE_SLOTS> ready_;   // game -> encoder
+    std::thread             worker_;
+    std::mutex              mutex_;
+    std::condition_variable wake_, room_;
+    std::atomic<bool>       stop_{false};
+    CaptureStats            stats_;
+};
+
+#endif
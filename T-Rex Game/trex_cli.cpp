@@ -0,0 +1,312 @@
+// ------------------------------------------------------------------
+// File: trex_cli.cpp
+// Headless T-Rex driver: runs episodes as fast as the CPU allows
+// ------------------------------------------------------------------
+// No window, no timer: every episode is stepped at the fixed DT in a
+// tight loop using the same rules as the Win32 game (trex_sim.cpp).
+// Episodes are spread over all cores (trex_farm.cpp); the report is
+// the same for any --threads value. --dump-ppm replays episode 0
+// through the software renderer and writes every Nth frame as a PPM;
+// --capture does the same into one Y4M video (every tick, 60 fps) through
+// the background encoder (trex_capture.cpp), as fast as it can go.
+// --record appends each episode's seed + inputs to a .rec file (the
+// format the game writes to trex_runs.rec); --replay re-simulates every
+// run in such a file and exits 1 if any final score differs.
+// --spawn loads obstacle odds/shapes from a file (trex_spawn.h format)
+// for every mode; --spawn-table prints the table in force and exits.
+// --autopilot plays the episodes one after another with the beam search
+// bot (trex_autopilot.cpp), each search spread over --threads, and adds
+// search throughput to the report; a large --max-ticks makes it a soak.
+//
+// Usage: trex_cli [--episodes N] [--seed S] [--max-ticks T] [--threads N]
+//                 [--policy reflex|idle] [--bucket B] [--verbose]
+//                 [--base-speed F] [--speed-per-score F] [--speed-cap F]
+//                 [--gap-min F] [--gap-max F] [--gap-shrink F]
+//                 [--gap-min-floor F] [--gap-max-floor F]
+//                 [--dump-ppm DIR] [--dump-every N] [--capture FILE]
+//                 [--record FILE] [--replay FILE]
+//                 [--spawn FILE] [--spawn-table]
+//                 [--autopilot] [--beam-width N] [--beam-depth N] [--beam-step N]
+// Build (Linux): g++ -O2 -std=c++14 -pthread -o trex_cli trex_cli.cpp trex_sim.cpp
+//                    trex_spawn.cpp trex_farm.cpp trex_render.cpp trex_fb.cpp
+//                    trex_glyphs.cpp trex_replay.cpp trex_autopilot.cpp trex_pool.cpp
+//                    trex_stream.cpp trex_capture.cpp trex_parallax.cpp
+// ------------------------------------------------------------------
+#include "trex_sim.h"
+#include "trex_farm.h"
+#include "trex_render.h"
+#include "trex_fb.h"
+#include "trex_replay.h"
+#include "trex_autopilot.h"
+#include "trex_stream.h"
+#include "trex_capture.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+struct CliOptions {
+    FarmConfig farm;
+    std::string policy = "reflex";
+    int  bucket = 100;
+    bool verbose = false;
+    std::string dumpDir;          // non-empty: write PPM frames of episode 0
+    uint32_t dumpEvery = 1;
+    std::string capturePath;      // non-empty: record episode 0 as Y4M
+    std::string recordPath;       // append episode recordings here
+    std::string replayPath;       // verify the recordings in this file
+    std::string spawnPath;        // spawn table override
+    bool printSpawn = false;
+    SpawnTable spawn;             // loaded from spawnPath
+    bool autopilot = false;
+    AutopilotConfig beam;
+};
+
+static void PrintUsage(){
+    std::printf("usage: trex_cli [--episodes N] [--seed S] [--max-ticks T] [--threads N]\n"
+                "                [--policy reflex|idle] [--bucket B] [--verbose]\n"
+                "                [--base-speed F] [--speed-per-score F] [--speed-cap F]\n"
+                "                [--gap-min F] [--gap-max F] [--gap-shrink F]\n"
+                "                [--gap-min-floor F] [--gap-max-floor F]\n"
+                "                [--dump-ppm DIR] [--dump-every N] [--capture FILE]\n"
+                "                [--record FILE] [--replay FILE]\n"
+                "                [--spawn FILE] [--spawn-table]\n"
+                "                [--autopilot] [--beam-width N] [--beam-depth N] [--beam-step N]\n");
+}
+
+static bool ParseArgs(int argc, char** argv, CliOptions& opt){
+    Tuning& t = opt.farm.tune;
+    struct { const char* name; float* dst; } floats[] = {
+        { "--base-speed", &t.baseSpd },   { "--speed-per-score", &t.speedPerScore },
+        { "--speed-cap", &t.speedCap },   { "--gap-min", &t.gapMin },
+        { "--gap-max", &t.gapMax },       { "--gap-shrink", &t.gapShrink },
+        { "--gap-min-floor", &t.gapMinFloor }, { "--gap-max-floor", &t.gapMaxFloor },
+    };
+    for(int i=1;i<argc;i++){
+        const char* a = argv[i];
+        bool hasVal = (i+1 < argc);
+        bool matched = false;
+        for(auto &fl: floats){
+            if(!std::strcmp(a, fl.name) && hasVal){ *fl.dst = std::strtof(argv[++i], nullptr); matched = true; break; }
+        }
+        if(matched) continue;
+        if(!std::strcmp(a,"--episodes") && hasVal)       opt.farm.episodes = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if(!std::strcmp(a,"--seed") && hasVal)      opt.farm.seed     = std::strtoull(argv[++i], nullptr, 10);
+        else if(!std::strcmp(a,"--max-ticks") && hasVal) opt.farm.maxTicks = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if(!std::strcmp(a,"--threads") && hasVal)   opt.farm.threads  = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if(!std::strcmp(a,"--bucket") && hasVal)    opt.bucket        = std::atoi(argv[++i]);
+        else if(!std::strcmp(a,"--policy") && hasVal)    opt.policy        = argv[++i];
+        else if(!std::strcmp(a,"--dump-ppm") && hasVal)  opt.dumpDir       = argv[++i];
+        else if(!std::strcmp(a,"--dump-every") && hasVal) opt.dumpEvery    = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if(!std::strcmp(a,"--capture") && hasVal)   opt.capturePath   = argv[++i];
+        else if(!std::strcmp(a,"--record") && hasVal)    opt.recordPath    = argv[++i];
+        else if(!std::strcmp(a,"--replay") && hasVal)    opt.replayPath    = argv[++i];
+        else if(!std::strcmp(a,"--spawn") && hasVal)     opt.spawnPath     = argv[++i];
+        else if(!std::strcmp(a,"--spawn-table"))         opt.printSpawn    = true;
+        else if(!std::strcmp(a,"--autopilot"))           opt.autopilot     = true;
+        else if(!std::strcmp(a,"--beam-width") && hasVal) opt.beam.width   = std::atoi(argv[++i]);
+        else if(!std::strcmp(a,"--beam-depth") && hasVal) opt.beam.depth   = std::atoi(argv[++i]);
+        else if(!std::strcmp(a,"--beam-step") && hasVal)  opt.beam.step    = std::atoi(argv[++i]);
+        else if(!std::strcmp(a,"--verbose"))             opt.verbose       = true;
+        else return false;
+    }
+    return opt.policy=="reflex" || opt.policy=="idle";
+}
+
+// Replays episode 0 of the farm (same seed and stream) frame by frame.
+static int DumpFrames(const CliOptions& opt){
+    Framebuffer fb; fb.Resize(W_WIDTH, W_HEIGHT);
+    SoftBackend sb(fb);
+    std::vector<int> top5;
+    World w; w.tune = opt.farm.tune; w.spawn = opt.farm.spawn;
+    ResetWorld(w, opt.farm.seed, 0);
+    w.state = GameState::PLAYING;
+    uint32_t every = opt.dumpEvery ? opt.dumpEvery : 1, written = 0;
+    bool died = false;
+    while(!died && w.ticks < opt.farm.maxTicks){
+        if(opt.farm.policy) ApplyInput(w, opt.farm.policy(w));
+        died = UpdateGame(w, DT);
+        if(died || w.ticks % every == 0){
+            RenderScene(sb, w, 0, top5);
+            char path[512];
+            std::snprintf(path, sizeof(path), "%s/frame_%06u.ppm", opt.dumpDir.c_str(), w.ticks);
+            if(!WritePPM(fb, path)){ std::fprintf(stderr, "cannot write %s\n", path); return 1; }
+            written++;
+        }
+    }
+    std::printf("wrote %u frames of episode 0 (score %d) to %s\n", written, w.score, opt.dumpDir.c_str());
+    return 0;
+}
+
+// Episode 0 again, every tick rendered and handed to the Y4M encoder;
+// Submit waits for a free slot, so no frame is dropped.
+static int CaptureEpisode(const CliOptions& opt){
+    Framebuffer fb; fb.Resize(W_WIDTH, W_HEIGHT);
+    SoftBackend sb(fb);
+    std::vector<int> top5;
+    CaptureWriter cap;
+    if(!cap.Start(opt.capturePath.c_str(), W_WIDTH, W_HEIGHT, FPS)){
+        std::fprintf(stderr, "cannot write %s\n", opt.capturePath.c_str());
+        return 1;
+    }
+    World w; w.tune = opt.farm.tune; w.spawn = opt.farm.spawn;
+    ResetWorld(w, opt.farm.seed, 0);
+    w.state = GameState::PLAYING;
+    auto t0 = std::chrono::steady_clock::now();
+    bool died = false;
+    while(!died && w.ticks < opt.farm.maxTicks){
+        if(opt.farm.policy) ApplyInput(w, opt.farm.policy(w));
+        died = UpdateGame(w, DT);
+        RenderScene(sb, w, 0, top5);
+        cap.Submit(fb, 1, true);
+    }
+    cap.Stop();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    const CaptureStats& st = cap.Stats();
+    if(st.failed){ std::fprintf(stderr, "write to %s failed\n", opt.capturePath.c_str()); return 1; }
+    std::printf("captured %llu frames of episode 0 (score %d) to %s, %.1f MB in %.3f s (%.1fx real time)\n",
+                (unsigned long long)st.written.load(), w.score, opt.capturePath.c_str(), st.bytes / 1e6, sec,
+                sec > 0 ? w.ticks / sec / FPS : 0.0);
+    return 0;
+}
+
+// Same episodes as the farm, run on one thread with the inputs recorded.
+static int RecordEpisodes(const CliOptions& opt){
+    World w; w.tune = opt.farm.tune; w.spawn = opt.farm.spawn;
+    InputRecorder rec;
+    size_t bytes = 0;
+    uint32_t written = 0;
+    for(uint32_t e=0;e<opt.farm.episodes;e++){
+        ResetWorld(w, opt.farm.seed, e);
+        w.state = GameState::PLAYING;
+        rec.Begin(w, opt.farm.seed, e);
+        bool died = false;
+        while(!died && w.ticks < opt.farm.maxTicks){
+            if(opt.farm.policy) rec.Apply(w, opt.farm.policy(w));
+            died = UpdateGame(w, DT);
+        }
+        if(!died) continue;           // timeouts have no final score to check
+        const RunRecording& r = rec.Finish(w);
+        if(!AppendRecording(opt.recordPath.c_str(), r)){ std::fprintf(stderr, "cannot write %s\n", opt.recordPath.c_str()); return 1; }
+        bytes += r.data.size();
+        written++;
+        if(opt.verbose) std::printf("episode %u score %d events %u (%zu bytes)\n", e, r.score, r.events, r.data.size());
+    }
+    std::printf("recorded %u of %u episodes to %s, %zu event bytes\n", written, opt.farm.episodes, opt.recordPath.c_str(), bytes);
+    return 0;
+}
+
+static int ReplayFile(const CliOptions& opt){
+    std::vector<RunRecording> runs;
+    size_t older = 0, otherTable = 0, torn = 0;
+    if(!LoadRecordings(opt.replayPath.c_str(), runs, &older, &torn)){
+        std::fprintf(stderr, "cannot read %s (missing or corrupt)\n", opt.replayPath.c_str());
+        if(runs.empty()) return 2;
+    }
+    if(torn) std::fprintf(stderr, "warning: %s ends in an incomplete record (%zu bytes, interrupted write); "
+                                  "replaying the %zu runs before it\n", opt.replayPath.c_str(), torn, runs.size());
+    if(older) std::printf("skipped %zu runs recorded before spawn tables (format v1)\n", older);
+    World w; w.spawn = opt.farm.spawn;
+    uint64_t ticks = 0;
+    size_t bad = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for(size_t i=0;i<runs.size();i++){
+        const RunRecording& r = runs[i];
+        if(r.spawnId != w.spawn->id){ otherTable++; continue; }
+        // the game generated these on a worker; the same chunks come out inline
+        SpawnFeed feed(r.fairStream ? r.ticks / STREAM_CHUNK_TICKS + 2 : 0);
+        if(r.fairStream){
+            StreamGenerator gen;
+            gen.Reset(r.seed, r.tune, w.spawn);
+            FillFeed(gen, feed, r.ticks + 1);
+            w.feed = &feed;
+        }
+        ReplayResult res = ReplayRun(w, r);
+        w.feed = nullptr;
+        ticks += res.ticks;
+        if(!res.match){
+            bad++;
+            std::printf("run %zu seed %llu: recorded score %d ticks %u %s, replay %d ticks %u %s\n",
+                        i, (unsigned long long)r.seed, r.score, r.ticks, ObTypeName(r.killer),
+                        res.score, res.ticks, res.died ? ObTypeName(res.killer) : "no death");
+        }
+        else if(opt.verbose) std::printf("run %zu score %d ok\n", i, res.score);
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if(otherTable) std::printf("skipped %zu runs recorded with another spawn table (use --spawn)\n", otherTable);
+    std::printf("replayed %zu runs, %llu ticks in %.3f s (%.1f Mticks/s), %zu mismatched\n",
+                runs.size() - otherTable, (unsigned long long)ticks, sec, sec > 0 ? ticks / sec / 1e6 : 0.0, bad);
+    return bad ? 1 : 0;
+}
+
+// Episodes in order, each tick decided by a fresh beam search.
+static int RunAutopilot(const CliOptions& opt){
+    TaskPool pool(opt.farm.threads);
+    Autopilot ap(opt.beam, pool);
+    World w; w.tune = opt.farm.tune; w.spawn = opt.farm.spawn;
+    FarmReport report;
+    report.threads = pool.Threads();
+    report.runs.reserve(opt.farm.episodes);
+    auto t0 = std::chrono::steady_clock::now();
+    for(uint32_t e=0;e<opt.farm.episodes;e++){
+        ResetWorld(w, opt.farm.seed, e);
+        w.state = GameState::PLAYING;
+        bool died = false;
+        while(!died && w.ticks < opt.farm.maxTicks){
+            ApplyInput(w, ap.Decide(w));
+            died = UpdateGame(w, DT);
+        }
+        report.runs.push_back(EpisodeResult{ w.score, w.ticks, w.killer, died });
+        if(opt.verbose){
+            const AutopilotStats& st = ap.Stats();
+            std::printf("episode %u score %d ticks %u %s  (%.2f M nodes/s so far)\n", e, w.score, w.ticks,
+                        died ? ObTypeName(w.killer) : "timeout", st.seconds > 0 ? st.nodes / st.seconds / 1e6 : 0.0);
+            std::fflush(stdout);
+        }
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    SummarizeRuns(report, opt.bucket);
+
+    const AutopilotStats& st = ap.Stats();
+    std::printf("policy    beam width %d depth %d step %d (%d ticks ahead)\n",
+                opt.beam.width, opt.beam.depth, opt.beam.step, opt.beam.depth * opt.beam.step);
+    PrintFarmReport(stdout, opt.farm, report);
+    double sec = st.seconds > 0 ? st.seconds : 1e-9;
+    std::printf("search    %llu decisions, %llu nodes, %llu sim ticks in %.3f s\n",
+                (unsigned long long)st.decisions, (unsigned long long)st.nodes, (unsigned long long)st.ticks, st.seconds);
+    std::printf("          %.2f M nodes/s, %.1f M ticks/s, %.1f us/decision, %llu decisions with no way out\n",
+                st.nodes / sec / 1e6, st.ticks / sec / 1e6, st.decisions ? sec * 1e6 / st.decisions : 0.0,
+                (unsigned long long)st.doomed);
+    return 0;
+}
+
+int main(int argc, char** argv){
+    CliOptions opt;
+    if(!ParseArgs(argc, argv, opt)){ PrintUsage(); return 2; }
+    if(opt.policy=="reflex") opt.farm.policy = ReflexPolicy;
+    if(!opt.spawnPath.empty()){
+        if(!LoadSpawnTable(opt.spawnPath.c_str(), opt.spawn)) return 2;
+        opt.farm.spawn = &opt.spawn;
+    }
+    if(opt.printSpawn){ PrintSpawnTable(stdout, *opt.farm.spawn); return 0; }
+    if(opt.autopilot) return RunAutopilot(opt);
+    if(!opt.dumpDir.empty()) return DumpFrames(opt);
+    if(!opt.capturePath.empty()) return CaptureEpisode(opt);
+    if(!opt.replayPath.empty()) return ReplayFile(opt);
+    if(!opt.recordPath.empty()) return RecordEpisodes(opt);
+
+    FarmReport report;
+    RunFarm(opt.farm, report, opt.bucket);
+
+    if(opt.verbose){
+        for(size_t e=0;e<report.runs.size();e++){
+            const EpisodeResult& r = report.runs[e];
+            std::printf("episode %zu score %d ticks %u %s\n", e, r.score, r.ticks,
+                        r.died ? ObTypeName(r.killer) : "timeout");
+        }
+    }
+    std::printf("policy    %s\n", opt.policy.c_str());
+    PrintFarmReport(stdout, opt.farm, report);
+    return 0;
+}
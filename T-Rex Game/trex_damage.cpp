@@ -0,0 +1,144 @@
+// ------------------------------------------------------------------
+// File: trex_damage.cpp
+// Display list recording, frame diff and damage merging
+// ------------------------------------------------------------------
+#include "trex_damage.h"
+#include "trex_glyphs.h"
+#include "trex_fb.h"
+#include <algorithm>
+
+// ---------------- Recording --------------------------
+static uint64_t Mix(uint64_t h, uint64_t v){
+    h ^= v + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+static uint64_t HashCmd(const DrawCmd& d, const wchar_t* s){
+    uint64_t h = Mix(Mix(Mix(d.kind, (uint64_t)d.c), (uint64_t)(uint32_t)d.size * 2 + d.bold),
+                     ((uint64_t)(uint32_t)d.l << 32) | (uint32_t)d.t);
+    h = Mix(h, ((uint64_t)(uint32_t)d.r << 32) | (uint32_t)d.b);
+    for(uint32_t i=0;i<d.textLen;i++) h = Mix(h, (uint64_t)s[i]);
+    return h;
+}
+
+void DisplayList::FillRect(int l, int t, int r, int b, Color c){
+    DrawCmd d{ DrawCmd::Fill, false, 0, l, t, r, b, c, 0, 0, IRect{ l, t, r, b }, 0, nullptr };
+    d.hash = HashCmd(d, nullptr);
+    cmds.push_back(d);
+}
+
+void DisplayList::FrameRect(int l, int t, int r, int b, Color c){
+    DrawCmd d{ DrawCmd::Frame, false, 0, l, t, r, b, c, 0, 0, IRect{ l, t, r, b }, 0, nullptr };
+    d.hash = HashCmd(d, nullptr);
+    cmds.push_back(d);
+}
+
+void DisplayList::Text(int x, int y, const wchar_t* s, int len, Color c, int size, bool bold){
+    DrawCmd d{ DrawCmd::Text, bold, size, x, y, 0, 0, c, (uint32_t)text.size(), (uint32_t)len,
+               TextBounds(x, y, len, size, bold), 0, nullptr };
+    d.hash = HashCmd(d, s);
+    text.insert(text.end(), s, s + len);
+    cmds.push_back(d);
+}
+
+void DisplayList::FillSquares(const float* x, const float* y, size_t n, int size, Color c){
+    if(!n) return;
+    DrawCmd d{ DrawCmd::Squares, false, size, 0, 0, 0, 0, c, (uint32_t)sqX.size(), 0, IRect{ 0, 0, 0, 0 }, 0, nullptr };
+    d.hash = HashCmd(d, nullptr);             // positions are mixed in below
+    d.textLen = (uint32_t)n;
+    int l = (int)x[0], t = (int)y[0], r = l, b = t;
+    for(size_t i=0;i<n;i++){
+        int px = (int)x[i], py = (int)y[i];
+        l = std::min(l, px); r = std::max(r, px);
+        t = std::min(t, py); b = std::max(b, py);
+        d.hash = Mix(d.hash, ((uint64_t)(uint32_t)px << 32) | (uint32_t)py);
+    }
+    d.bounds = IRect{ l, t, r + size, b + size };
+    sqX.insert(sqX.end(), x, x + n);
+    sqY.insert(sqY.end(), y, y + n);
+    cmds.push_back(d);
+}
+
+void DisplayList::Layer(const Framebuffer& strip, int x, int y, int w, int scroll){
+    DrawCmd d{ DrawCmd::Layer, false, scroll, x, y, x + w, y + strip.h, 0, 0, 0, IRect{ x, y, x + w, y + strip.h }, 0, &strip };
+    d.hash = Mix(HashCmd(d, nullptr), (uint64_t)(uintptr_t)&strip);
+    cmds.push_back(d);
+}
+
+void DisplayList::Sprite(const Framebuffer& img, int x, int y){
+    DrawCmd d{ DrawCmd::Sprite, false, 0, x, y, x + img.w, y + img.h, 0, 0, 0, IRect{ x, y, x + img.w, y + img.h }, 0, &img };
+    d.hash = Mix(HashCmd(d, nullptr), (uint64_t)(uintptr_t)&img);
+    cmds.push_back(d);
+}
+
+void DisplayList::Replay(DrawBackend& b, const IRect& clip) const {
+    for(const auto &d: cmds){
+        if(!Overlaps(d.bounds, clip)) continue;
+        switch(d.kind){
+            case DrawCmd::Fill:  b.FillRect(d.l, d.t, d.r, d.b, d.c); break;
+            case DrawCmd::Frame: b.FrameRect(d.l, d.t, d.r, d.b, d.c); break;
+            case DrawCmd::Text:  b.Text(d.l, d.t, text.data() + d.textOff, (int)d.textLen, d.c, d.size, d.bold); break;
+            case DrawCmd::Squares: b.FillSquares(sqX.data() + d.textOff, sqY.data() + d.textOff, d.textLen, d.size, d.c); break;
+            case DrawCmd::Layer: b.Layer(*d.strip, d.l, d.t, d.r - d.l, d.size); break;
+            case DrawCmd::Sprite: b.Sprite(*d.strip, d.l, d.t); break;
+        }
+    }
+}
+
+// ---------------- Diff -------------------------------
+static bool ByHash(const std::pair<uint64_t, IRect>& a, const std::pair<uint64_t, IRect>& b){ return a.first < b.first; }
+
+const std::vector<IRect>& DamageTracker::Update(const DisplayList& cur, const IRect& screen){
+    cur_.clear();
+    for(const auto &d: cur.cmds) cur_.push_back(Entry(d.hash, d.bounds));
+    std::sort(cur_.begin(), cur_.end(), ByHash);
+
+    damage_.clear();
+    if(full_){
+        damage_.push_back(screen);
+        full_ = false;
+    } else {
+        // Multiset difference of the two sorted lists: unmatched entries
+        // on either side are things that moved, appeared or went away.
+        size_t i = 0, j = 0;
+        while(i < prev_.size() || j < cur_.size()){
+            if(j == cur_.size() || (i < prev_.size() && prev_[i].first < cur_[j].first)){ damage_.push_back(prev_[i++].second); }
+            else if(i == prev_.size() || cur_[j].first < prev_[i].first){ damage_.push_back(cur_[j++].second); }
+            else { i++; j++; }
+        }
+        for(auto &r: damage_) r = Intersection(r, screen);
+        damage_.erase(std::remove_if(damage_.begin(), damage_.end(), [](const IRect& r){ return r.Empty(); }), damage_.end());
+        MergeRects(damage_);
+    }
+    prev_.swap(cur_);
+    return damage_;
+}
+
+long long DamageTracker::DamageArea() const {
+    long long a = 0;
+    for(const auto &r: damage_) a += r.Area();
+    return a;
+}
+
+// ---------------- Merge ------------------------------
+void MergeRects(std::vector<IRect>& v, size_t maxRects){
+    bool merged = true;
+    while(merged){
+        merged = false;
+        for(size_t i=0;i<v.size() && !merged;i++){
+            for(size_t j=i+1;j<v.size();j++){
+                IRect u = Union(v[i], v[j]);
+                // Join when they overlap or when the union costs no more
+                // pixels than painting both separately.
+                if(Overlaps(v[i], v[j]) || u.Area() <= v[i].Area() + v[j].Area()){
+                    v[i] = u; v.erase(v.begin() + j); merged = true; break;
+                }
+            }
+        }
+    }
+    if(v.size() > maxRects){
+        IRect all = v[0];
+        for(const auto &r: v) all = Union(all, r);
+        v.clear(); v.push_back(all);
+    }
+}
@@ -0,0 +1,80 @@
+// ------------------------------------------------------------------
+// File: trex_damage.h
+// Dirty-rectangle tracking for the software renderer
+// ------------------------------------------------------------------
+// RenderScene() draws into a DisplayList instead of pixels. The list is
+// diffed against last frame's: any command that appeared, vanished or
+// changed contributes its old/new bounds to the damage. Only those
+// rectangles are re-rasterised (replaying the list clipped to each) and
+// presented. A static menu or game-over screen damages nothing.
+// ------------------------------------------------------------------
+#ifndef TREX_DAMAGE_H
+#define TREX_DAMAGE_H
+
+#include "trex_draw.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+struct DrawCmd {
+    enum Kind : uint8_t { Fill, Frame, Text, Squares, Layer, Sprite };
+    Kind     kind;
+    bool     bold;
+    int      size;                // font size, square side, or layer scroll
+    int      l, t, r, b;          // rect, or x/y in l/t for text
+    Color    c;
+    uint32_t textOff, textLen;    // into DisplayList::text (squares: sqX/sqY)
+    IRect    bounds;              // every pixel this command may touch
+    uint64_t hash;                // identity for the frame-to-frame diff
+    const Framebuffer* strip;     // Layer strip / Sprite image
+};
+
+class DisplayList : public DrawBackend {
+public:
+    std::vector<DrawCmd> cmds;
+    std::vector<wchar_t> text;
+    std::vector<float>   sqX, sqY;
+
+    void BeginFrame() override { cmds.clear(); text.clear(); sqX.clear(); sqY.clear(); }
+    void FillRect(int l, int t, int r, int b, Color c) override;
+    void FrameRect(int l, int t, int r, int b, Color c) override;
+    void Text(int x, int y, const wchar_t* s, int len, Color c, int size, bool bold) override;
+    void EndFrame() override {}
+    // One command for the whole batch; its bounds are the union, so a
+    // moving cloud of particles damages the box around it.
+    void FillSquares(const float* x, const float* y, size_t n, int size, Color c) override;
+    // The strip is identified by address: a layer that scrolls damages
+    // its whole band, a still one nothing.
+    void Layer(const Framebuffer& strip, int x, int y, int w, int scroll) override;
+    // Identified by image and position, so a sprite damages its old and
+    // new boxes only when it moves.
+    void Sprite(const Framebuffer& img, int x, int y) override;
+
+    // Issue every command intersecting `clip` to `b` (no Begin/EndFrame)
+    void Replay(DrawBackend& b, const IRect& clip) const;
+};
+
+class DamageTracker {
+public:
+    // Diff `cur` against the previous list, remember `cur`, return the
+    // merged damage clipped to `screen`.
+    const std::vector<IRect>& Update(const DisplayList& cur, const IRect& screen);
+
+    // Next Update() damages the whole screen (first frame, resize, ...)
+    void Invalidate(){ full_ = true; }
+
+    const std::vector<IRect>& Damage() const { return damage_; }
+    long long DamageArea() const;
+
+private:
+    typedef std::pair<uint64_t, IRect> Entry;
+    std::vector<Entry> prev_, cur_;
+    std::vector<IRect> damage_;
+    bool full_ = true;
+};
+
+// Merge overlapping / cheaply-joinable rectangles; past maxRects
+// everything collapses to one bounding box.
+void MergeRects(std::vector<IRect>& v, size_t maxRects = 16);
+
+#endif
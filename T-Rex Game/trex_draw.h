@@ -0,0 +1,154 @@
+// ------------------------------------------------------------------
+// File: trex_draw.h
+// Drawing backend interface + cached brush/font resources
+// ------------------------------------------------------------------
+//  - DrawBackend: the handful of primitives RenderScene() needs
+//  - Layer(): a band copied out of a pre-rendered wrap-around strip
+//    (trex_parallax.h); counted as one fill
+//  - Sprite(): a small pre-rendered image with transparent pixels,
+//    drawn once per object that uses it; counted as one fill
+//  - ResourceCache: creates a brush/font the first time a key is seen
+//    and hands the same object back every frame after that
+//  - CountingBackend: no pixels, just counts draw calls and cache
+//    creations per frame (runs anywhere, used by trex_bench); a
+//    FillSquares batch counts as one fill
+// ------------------------------------------------------------------
+#ifndef TREX_DRAW_H
+#define TREX_DRAW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Colors are COLORREF layout (0x00BBGGRR) so the GDI backend can pass
+// them straight through.
+typedef uint32_t Color;
+
+struct Framebuffer;   // trex_fb.h
+static inline Color MakeColor(int r, int g, int b){
+    return (Color)((uint32_t)(r & 0xFF) | ((uint32_t)(g & 0xFF) << 8) | ((uint32_t)(b & 0xFF) << 16));
+}
+
+// Integer rectangle, [l,r) x [t,b) like a Win32 RECT.
+struct IRect {
+    int l, t, r, b;
+    bool Empty() const { return l >= r || t >= b; }
+    long long Area() const { return Empty() ? 0 : (long long)(r - l) * (b - t); }
+};
+static inline bool Overlaps(const IRect& a, const IRect& b){
+    return a.l < b.r && b.l < a.r && a.t < b.b && b.t < a.b;
+}
+static inline IRect Union(const IRect& a, const IRect& b){
+    if(a.Empty()) return b;
+    if(b.Empty()) return a;
+    return IRect{ a.l < b.l ? a.l : b.l, a.t < b.t ? a.t : b.t, a.r > b.r ? a.r : b.r, a.b > b.b ? a.b : b.b };
+}
+static inline IRect Intersection(const IRect& a, const IRect& b){
+    return IRect{ a.l > b.l ? a.l : b.l, a.t > b.t ? a.t : b.t, a.r < b.r ? a.r : b.r, a.b < b.b ? a.b : b.b };
+}
+
+class DrawBackend {
+public:
+    virtual ~DrawBackend() {}
+    virtual void BeginFrame() = 0;
+    virtual void FillRect(int l, int t, int r, int b, Color c) = 0;
+    virtual void FrameRect(int l, int t, int r, int b, Color c) = 0;   // 1px outline
+    virtual void Text(int x, int y, const wchar_t* s, int len, Color c, int size, bool bold) = 0;
+    virtual void EndFrame() = 0;
+
+    // [x, x+w) x [y, y+strip.h) from `strip`, column x+i showing strip
+    // column (scroll+i) mod strip.w. The strip must outlive the frame.
+    virtual void Layer(const Framebuffer& strip, int x, int y, int w, int scroll) = 0;
+
+    // `img` with its top-left at (x, y); pixels with alpha 0 are left
+    // as they are. The image must outlive the frame.
+    virtual void Sprite(const Framebuffer& img, int x, int y) = 0;
+
+    // n size x size squares with top-left (x[i], y[i]), truncated like
+    // the scene's other float rects. One call per batch, so particles
+    // cost backends that can batch a single draw call.
+    virtual void FillSquares(const float* x, const float* y, size_t n, int size, Color c){
+        for(size_t i=0;i<n;i++){
+            int l = (int)x[i], t = (int)y[i];
+            FillRect(l, t, l + size, t + size, c);
+        }
+    }
+};
+
+// Keys for the two resource kinds RenderScene uses.
+static inline uint64_t BrushKey(Color c){ return (uint64_t)c; }
+static inline uint64_t FontKey(int size, bool bold){ return ((uint64_t)(uint32_t)size << 1) | (bold ? 1u : 0u); }
+
+// A frame uses about a dozen distinct keys, so a flat vector beats a map.
+template<class H>
+class ResourceCache {
+public:
+    typedef H    (*CreateFn)(uint64_t key);
+    typedef void (*DestroyFn)(H h);
+
+    ResourceCache(CreateFn create, DestroyFn destroy) : create_(create), destroy_(destroy) {}
+    ~ResourceCache(){ Clear(); }
+
+    H Get(uint64_t key){
+        for(const auto &e: entries_) if(e.first == key) return e.second;
+        H h = create_(key);
+        entries_.push_back(std::make_pair(key, h));
+        created_++;
+        return h;
+    }
+    void Clear(){
+        for(const auto &e: entries_) destroy_(e.second);
+        entries_.clear();
+    }
+    size_t   size()    const { return entries_.size(); }
+    uint64_t created() const { return created_; }       // lifetime total
+
+private:
+    ResourceCache(const ResourceCache&);
+    ResourceCache& operator=(const ResourceCache&);
+
+    CreateFn  create_;
+    DestroyFn destroy_;
+    std::vector<std::pair<uint64_t, H> > entries_;
+    uint64_t  created_ = 0;
+};
+
+// Stand‑in for the GDI backend: same cache logic, dummy handles.
+class CountingBackend : public DrawBackend {
+public:
+    struct FrameStats { uint32_t fills, frames, texts, created; };
+
+    CountingBackend() : brushes_(MakeHandle, DropHandle), fonts_(MakeHandle, DropHandle) {}
+
+    void BeginFrame() override {
+        cur_ = FrameStats{0,0,0,0};
+        base_ = brushes_.created() + fonts_.created();
+    }
+    void FillRect(int, int, int, int, Color c) override { brushes_.Get(BrushKey(c)); cur_.fills++; }
+    void FrameRect(int, int, int, int, Color c) override { brushes_.Get(BrushKey(c)); cur_.frames++; }
+    void Text(int, int, const wchar_t*, int, Color, int size, bool bold) override {
+        fonts_.Get(FontKey(size, bold)); cur_.texts++;
+    }
+    void FillSquares(const float*, const float*, size_t, int, Color c) override { brushes_.Get(BrushKey(c)); cur_.fills++; }
+    void Layer(const Framebuffer&, int, int, int, int) override { cur_.fills++; }
+    void Sprite(const Framebuffer&, int, int) override { cur_.fills++; }
+    void EndFrame() override {
+        cur_.created = (uint32_t)(brushes_.created() + fonts_.created() - base_);
+        last_ = cur_;
+    }
+
+    const FrameStats& Last() const { return last_; }
+    size_t Brushes() const { return brushes_.size(); }
+    size_t Fonts()   const { return fonts_.size(); }
+
+private:
+    static int  MakeHandle(uint64_t){ return 1; }
+    static void DropHandle(int){}
+
+    ResourceCache<int> brushes_, fonts_;
+    FrameStats cur_{}, last_{};
+    uint64_t   base_ = 0;
+};
+
+#endif
@@ -0,0 +1,130 @@
+// ------------------------------------------------------------------
+// File: trex_farm.cpp
+// Parallel episode runner and score-distribution report
+// ------------------------------------------------------------------
+#include "trex_farm.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+static const uint32_t FARM_CHUNK = 64;   // episodes claimed per grab
+
+void Histogram::Add(int v){
+    if(v < 0) v = 0;
+    size_t i = (size_t)(v / bucket);
+    if(i >= bins.size()) bins.resize(i + 1, 0);
+    bins[i]++;
+}
+
+// Each worker claims chunks of episode indices; results land in their
+// own slots so nothing is shared except the chunk counter.
+static void FarmWorker(const FarmConfig& cfg, std::atomic<uint32_t>& next, std::vector<EpisodeResult>& runs){
+    World w;
+    w.tune = cfg.tune;
+    w.spawn = cfg.spawn;
+    InputFn policy = cfg.policy;     // private copy, policies may carry state
+    for(;;){
+        uint32_t begin = next.fetch_add(FARM_CHUNK);
+        if(begin >= cfg.episodes) break;
+        uint32_t end = std::min(cfg.episodes, begin + FARM_CHUNK);
+        for(uint32_t i=begin;i<end;i++){
+            runs[i] = RunEpisode(w, cfg.seed, i, policy, cfg.maxTicks);
+        }
+    }
+}
+
+void RunFarm(const FarmConfig& cfg, FarmReport& out, int scoreBucket){
+    unsigned n = cfg.threads ? cfg.threads : std::thread::hardware_concurrency();
+    if(n == 0) n = 1;
+    unsigned chunks = (cfg.episodes + FARM_CHUNK - 1) / FARM_CHUNK;
+    if(n > chunks) n = chunks ? chunks : 1;
+
+    out = FarmReport();
+    out.threads = n;
+    out.runs.assign(cfg.episodes, EpisodeResult{});
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::atomic<uint32_t> next{0};
+    std::vector<std::thread> pool;
+    for(unsigned t=1;t<n;t++) pool.emplace_back(FarmWorker, std::cref(cfg), std::ref(next), std::ref(out.runs));
+    FarmWorker(cfg, next, out.runs);   // calling thread works too
+    for(auto &th: pool) th.join();
+    out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    SummarizeRuns(out, scoreBucket);
+}
+
+void SummarizeRuns(FarmReport& out, int scoreBucket){
+    out.frames = 0; out.timeouts = 0;
+    for(auto &d: out.deaths) d = 0;
+    out.scoreHist = Histogram(); out.secondsHist = Histogram();
+    out.scoreHist.bucket = scoreBucket > 0 ? scoreBucket : 100;
+    out.secondsHist.bucket = 1;
+    for(const auto &r: out.runs){
+        out.frames += r.ticks;
+        if(r.died) out.deaths[(int)r.killer]++;
+        else out.timeouts++;
+        out.scoreHist.Add(r.score);
+        out.secondsHist.Add((int)(r.ticks / FPS));
+    }
+}
+
+int Percentile(const std::vector<int>& sorted, double p){
+    if(sorted.empty()) return 0;
+    size_t rank = (size_t)std::ceil(p / 100.0 * (double)sorted.size());
+    if(rank < 1) rank = 1;
+    if(rank > sorted.size()) rank = sorted.size();
+    return sorted[rank - 1];
+}
+
+static void PrintPercentiles(std::FILE* f, const char* label, std::vector<int>& v){
+    std::sort(v.begin(), v.end());
+    double mean = 0.0; for(int x: v) mean += x;
+    if(!v.empty()) mean /= (double)v.size();
+    std::fprintf(f, "%-9s mean %.1f  min %d  p1 %d  p5 %d  p25 %d  p50 %d  p75 %d  p95 %d  p99 %d  max %d\n",
+                 label, mean, v.empty()?0:v.front(),
+                 Percentile(v,1), Percentile(v,5), Percentile(v,25), Percentile(v,50),
+                 Percentile(v,75), Percentile(v,95), Percentile(v,99), v.empty()?0:v.back());
+}
+
+static void PrintHistogram(std::FILE* f, const char* title, const char* unit, const Histogram& h){
+    uint32_t peak = 0; for(uint32_t c: h.bins) peak = std::max(peak, c);
+    std::fprintf(f, "%s\n", title);
+    for(size_t i=0;i<h.bins.size();i++){
+        if(!h.bins[i]) continue;
+        int bar = peak ? (int)((uint64_t)h.bins[i] * 50 / peak) : 0;
+        std::fprintf(f, "  %6d-%-6d%-2s %8u |", (int)i*h.bucket, (int)(i+1)*h.bucket - 1, unit, h.bins[i]);
+        for(int b=0;b<bar;b++) std::fputc('#', f);
+        std::fputc('\n', f);
+    }
+}
+
+void PrintFarmReport(std::FILE* f, const FarmConfig& cfg, const FarmReport& r){
+    size_t n = r.runs.size();
+    std::fprintf(f, "episodes  %zu on %u threads, seed %llu, streams 0..%zu\n", n, r.threads,
+                 (unsigned long long)cfg.seed, n ? n - 1 : 0);
+    std::fprintf(f, "tuning    base %.1f  +%.3f/pt cap %.1f  gap [%.3f, %.3f] -%.5f/pt floor [%.3f, %.3f]\n",
+                 cfg.tune.baseSpd, cfg.tune.speedPerScore, cfg.tune.speedCap, cfg.tune.gapMin, cfg.tune.gapMax,
+                 cfg.tune.gapShrink, cfg.tune.gapMinFloor, cfg.tune.gapMaxFloor);
+    std::fprintf(f, "spawn     table %08x%s, %d tiers\n", cfg.spawn->id,
+                 cfg.spawn == &DEFAULT_SPAWN_TABLE ? " (built in)" : "", cfg.spawn->tierCount);
+    std::fprintf(f, "frames    %llu in %.3f s (%.2f M frames/s, %.0f episodes/s)\n",
+                 (unsigned long long)r.frames, r.seconds,
+                 r.seconds > 0 ? r.frames / r.seconds / 1e6 : 0.0, r.seconds > 0 ? n / r.seconds : 0.0);
+
+    std::vector<int> scores, secs;
+    scores.reserve(n); secs.reserve(n);
+    for(const auto &e: r.runs){ scores.push_back(e.score); secs.push_back((int)(e.ticks / FPS)); }
+    PrintPercentiles(f, "score", scores);
+    PrintPercentiles(f, "survived", secs);
+
+    std::fprintf(f, "cause of death\n");
+    for(int t=0;t<OBTYPE_COUNT;t++){
+        std::fprintf(f, "  %-13s %8u  %5.1f%%\n", ObTypeName((ObType)t), r.deaths[t], n ? 100.0 * r.deaths[t] / n : 0.0);
+    }
+    std::fprintf(f, "  %-13s %8u  %5.1f%%\n", "timeout", r.timeouts, n ? 100.0 * r.timeouts / n : 0.0);
+
+    PrintHistogram(f, "score histogram", "", r.scoreHist);
+    PrintHistogram(f, "survival histogram (seconds)", "s", r.secondsHist);
+}
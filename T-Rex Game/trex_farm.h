@@ -0,0 +1,56 @@
+// ------------------------------------------------------------------
+// File: trex_farm.h
+// Multi-core episode farm: run many headless T-Rex episodes and
+// summarise score / survival time / cause of death
+// ------------------------------------------------------------------
+// Episode i always uses RNG stream i of the base seed, so a report is
+// identical no matter how many worker threads produced it.
+// ------------------------------------------------------------------
+#ifndef TREX_FARM_H
+#define TREX_FARM_H
+
+#include "trex_sim.h"
+#include <cstdio>
+#include <vector>
+
+struct FarmConfig {
+    uint32_t episodes = 1000;
+    uint64_t seed     = 1;
+    uint32_t maxTicks = FPS * 60 * 10;  // ten minutes of game time
+    unsigned threads  = 0;              // 0 = one per hardware thread
+    Tuning   tune;
+    const SpawnTable* spawn = &DEFAULT_SPAWN_TABLE;
+    InputFn  policy;                    // empty = never press anything
+};
+
+struct Histogram {
+    int bucket = 1;                     // width of one bin
+    std::vector<uint32_t> bins;         // bins[i] counts [i*bucket, (i+1)*bucket)
+
+    void Add(int v);
+};
+
+struct FarmReport {
+    std::vector<EpisodeResult> runs;    // indexed by episode
+    double   seconds  = 0.0;            // wall time of the whole farm
+    unsigned threads  = 0;
+    uint64_t frames   = 0;
+    uint32_t timeouts = 0;              // episodes that hit maxTicks alive
+    uint32_t deaths[OBTYPE_COUNT] = {};
+    Histogram scoreHist;
+    Histogram secondsHist;              // survival time, whole seconds
+};
+
+// Runs cfg.episodes episodes on cfg.threads workers and fills `out`.
+void RunFarm(const FarmConfig& cfg, FarmReport& out, int scoreBucket = 100);
+
+// Recomputes frames/timeouts/deaths/histograms from out.runs; for
+// reports built from episodes run some other way.
+void SummarizeRuns(FarmReport& out, int scoreBucket = 100);
+
+// p in [0,100]; nearest-rank on the sorted values
+int Percentile(const std::vector<int>& sorted, double p);
+
+void PrintFarmReport(std::FILE* f, const FarmConfig& cfg, const FarmReport& r);
+
+#endif
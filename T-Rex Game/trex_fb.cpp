@@ -0,0 +1,176 @@
+// ------------------------------------------------------------------
+// File: trex_fb.cpp
+// Software rasteriser: span fills, 5x7 bitmap text, PPM output
+// ------------------------------------------------------------------
+#include "trex_fb.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// ----------------- Spans -----------------------------
+void FillSpanRect(Framebuffer& fb, int l, int t, int r, int b, uint32_t pixel){
+    l = std::max(l, 0); t = std::max(t, 0);
+    r = std::min(r, fb.w); b = std::min(b, fb.h);
+    if(l >= r || t >= b) return;
+    for(int y=t;y<b;y++){
+        uint32_t* row = fb.Row(y);
+        std::fill(row + l, row + r, pixel);
+    }
+}
+
+uint64_t BlitWrapped(Framebuffer& fb, const IRect& clip, const Framebuffer& strip, int x, int y, int w, int scroll){
+    if(strip.w <= 0 || strip.h <= 0) return 0;
+    IRect v = Intersection(Intersection(IRect{ x, y, x + w, y + strip.h }, clip), IRect{ 0, 0, fb.w, fb.h });
+    if(v.Empty()) return 0;
+    int start = (scroll + (v.l - x)) % strip.w;
+    if(start < 0) start += strip.w;
+    for(int yy=v.t;yy<v.b;yy++){
+        const uint32_t* src = strip.Row(yy - y);
+        uint32_t* dst = fb.Row(yy) + v.l;
+        int left = v.r - v.l, s = start;
+        while(left > 0){
+            int n = std::min(left, strip.w - s);
+            std::memcpy(dst, src + s, (size_t)n * sizeof(uint32_t));
+            dst += n; left -= n; s = 0;
+        }
+    }
+    return (uint64_t)v.Area();
+}
+
+uint64_t BlitSprite(Framebuffer& fb, const IRect& clip, const Framebuffer& img, int x, int y){
+    IRect v = Intersection(Intersection(IRect{ x, y, x + img.w, y + img.h }, clip), IRect{ 0, 0, fb.w, fb.h });
+    if(v.Empty()) return 0;
+    uint64_t n = 0;
+    for(int yy=v.t;yy<v.b;yy++){
+        const uint32_t* src = img.Row(yy - y) + (v.l - x);
+        uint32_t* dst = fb.Row(yy) + v.l;
+        // opaque runs are copied whole
+        for(int i=0, e=v.r-v.l; i<e;){
+            while(i < e && !(src[i] >> 24)) i++;
+            int s = i;
+            while(i < e && (src[i] >> 24)) i++;
+            std::memcpy(dst + s, src + s, (size_t)(i - s) * sizeof(uint32_t));
+            n += (uint64_t)(i - s);
+        }
+    }
+    return n;
+}
+
+void SpriteRects(const Framebuffer& img, std::vector<SpriteRect>& out){
+    out.clear();
+    std::vector<size_t> open, next;          // rects that reach the row above
+    for(int y=0;y<img.h;y++){
+        const uint32_t* row = img.Row(y);
+        next.clear();
+        for(int x=0;x<img.w;){
+            uint32_t p = row[x];
+            int e = x + 1;
+            while(e < img.w && row[e] == p) e++;
+            if(p >> 24){
+                Color c = PixelToColor(p);
+                size_t k = out.size();
+                for(size_t o: open){
+                    const SpriteRect& s = out[o];
+                    if(s.r.l == x && s.r.r == e && s.c == c){ k = o; break; }
+                }
+                if(k == out.size()) out.push_back(SpriteRect{ IRect{ x, y, e, y }, c });
+                out[k].r.b = y + 1;
+                next.push_back(k);
+            }
+            x = e;
+        }
+        open.swap(next);
+    }
+}
+
+void SoftBackend::Span(int l, int t, int r, int b, uint32_t p){
+    IRect v = Intersection(IRect{ l, t, r, b }, Intersection(clip_, IRect{ 0, 0, fb_.w, fb_.h }));
+    if(v.Empty()) return;
+    FillSpanRect(fb_, v.l, v.t, v.r, v.b, p);
+    pixels_ += (uint64_t)v.Area();
+}
+
+void SoftBackend::FillRect(int l, int t, int r, int b, Color c){
+    Span(l, t, r, b, ColorToPixel(c));
+}
+
+// Same as GDI FrameRect: a 1px border just inside [l,r) x [t,b)
+void SoftBackend::FrameRect(int l, int t, int r, int b, Color c){
+    if(l >= r || t >= b) return;
+    uint32_t p = ColorToPixel(c);
+    Span(l, t, r, t + 1, p);
+    Span(l, b - 1, r, b, p);
+    Span(l, t, l + 1, b, p);
+    Span(r - 1, t, r, b, p);
+}
+
+void SoftBackend::Layer(const Framebuffer& strip, int x, int y, int w, int scroll){
+    pixels_ += BlitWrapped(fb_, clip_, strip, x, y, w, scroll);
+}
+
+void SoftBackend::Sprite(const Framebuffer& img, int x, int y){
+    pixels_ += BlitSprite(fb_, clip_, img, x, y);
+}
+
+// Particles: thousands of tiny squares, so no per-square Span() call;
+// the clip is hoisted and fully visible squares skip the clamping.
+void SoftBackend::FillSquares(const float* x, const float* y, size_t n, int size, Color c){
+    if(size <= 0) return;
+    uint32_t p = ColorToPixel(c);
+    IRect lim = Intersection(clip_, IRect{ 0, 0, fb_.w, fb_.h });
+    if(lim.Empty()) return;
+    uint64_t touched = 0;
+    for(size_t i=0;i<n;i++){
+        int l = (int)x[i], t = (int)y[i], r = l + size, b = t + size;
+        if(l < lim.l || t < lim.t || r > lim.r || b > lim.b){
+            l = std::max(l, lim.l); t = std::max(t, lim.t);
+            r = std::min(r, lim.r); b = std::min(b, lim.b);
+            if(l >= r || t >= b) continue;
+        }
+        for(int yy=t;yy<b;yy++){
+            uint32_t* row = fb_.Row(yy);
+            for(int xx=l;xx<r;xx++) row[xx] = p;
+        }
+        touched += (uint64_t)(r - l) * (uint64_t)(b - t);
+    }
+    pixels_ += touched;
+}
+
+// ----------------- Text ------------------------------
+// Glyphs come pre-rasterised from the atlas; each one is a masked copy.
+void SoftBackend::Text(int x, int y, const wchar_t* s, int len, Color c, int size, bool bold){
+    const GlyphAtlas& a = glyphs_.Get(size, bold);
+    uint32_t p = ColorToPixel(c);
+    int top = TextTop(y, size);
+    IRect lim = Intersection(clip_, IRect{ 0, 0, fb_.w, fb_.h });
+    for(int i=0;i<len;i++){
+        int gx = x + i * a.cellW;
+        IRect v = Intersection(IRect{ gx, top, gx + a.cellW, top + a.cellH }, lim);
+        if(v.Empty()) continue;
+        int g = GlyphIndex(s[i]);
+        for(int yy=v.t;yy<v.b;yy++){
+            const uint8_t* m = a.Row(g, yy - top) + (v.l - gx);
+            uint32_t* row = fb_.Row(yy) + v.l;
+            for(int xx=0;xx<v.r-v.l;xx++) row[xx] = m[xx] ? p : row[xx];
+        }
+        pixels_ += (uint64_t)v.Area();
+    }
+}
+
+// ----------------- Output ----------------------------
+bool WritePPM(const Framebuffer& fb, const char* path){
+    std::FILE* f = std::fopen(path, "wb");
+    if(!f) return false;
+    std::fprintf(f, "P6\n%d %d\n255\n", fb.w, fb.h);
+    std::vector<uint8_t> line((size_t)fb.w * 3);
+    for(int y=0;y<fb.h;y++){
+        const uint32_t* row = fb.Row(y);
+        for(int x=0;x<fb.w;x++){
+            line[x*3+0] = (uint8_t)(row[x] >> 16);
+            line[x*3+1] = (uint8_t)(row[x] >> 8);
+            line[x*3+2] = (uint8_t)(row[x]);
+        }
+        std::fwrite(line.data(), 1, line.size(), f);
+    }
+    return std::fclose(f) == 0;
+}
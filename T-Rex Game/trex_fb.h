@@ -0,0 +1,96 @@
+// ------------------------------------------------------------------
+// File: trex_fb.h
+// Portable 32-bit software framebuffer + DrawBackend that fills it
+// ------------------------------------------------------------------
+//  - Framebuffer: top-down BGRA pixels (the 32bpp DIB layout), so the
+//    Win32 front end can present it with a single SetDIBitsToDevice
+//  - SoftBackend: clipped span fills for rectangles/frames; text is
+//    copied from per-size glyph atlases (trex_glyphs.h); particle
+//    squares are plotted straight into the rows; background layers
+//    are row copies out of their strips; sprites skip their
+//    transparent pixels; no OS calls
+//  - WritePPM: dump a frame for headless inspection on Linux
+// ------------------------------------------------------------------
+#ifndef TREX_FB_H
+#define TREX_FB_H
+
+#include "trex_draw.h"
+#include "trex_glyphs.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Framebuffer {
+    int w = 0, h = 0;
+    std::vector<uint32_t> px;           // 0xAARRGGBB, row-major, top row first
+
+    void Resize(int width, int height){ w = width; h = height; px.assign((size_t)w * h, 0xFF000000u); }
+    // Sprite images start fully transparent (alpha 0) instead
+    void ResizeClear(int width, int height){ w = width; h = height; px.assign((size_t)w * h, 0u); }
+    uint32_t*       Row(int y)       { return px.data() + (size_t)y * w; }
+    const uint32_t* Row(int y) const { return px.data() + (size_t)y * w; }
+};
+
+// COLORREF (0x00BBGGRR) -> opaque BGRA pixel (0xFFRRGGBB)
+static inline uint32_t ColorToPixel(Color c){
+    return 0xFF000000u | ((c & 0xFFu) << 16) | (c & 0xFF00u) | ((c >> 16) & 0xFFu);
+}
+
+// Opaque BGRA pixel -> COLORREF
+static inline Color PixelToColor(uint32_t p){
+    return (Color)(((p >> 16) & 0xFFu) | (p & 0xFF00u) | ((p & 0xFFu) << 16));
+}
+
+// Fill [l,r) x [t,b) clipped to the buffer.
+void FillSpanRect(Framebuffer& fb, int l, int t, int r, int b, uint32_t pixel);
+
+// Copy [x, x+w) x [y, y+strip.h) from a wrap-around strip, clipped to
+// `clip` and the buffer: column x+i takes strip column (scroll+i) mod
+// strip.w. Returns the pixels written.
+uint64_t BlitWrapped(Framebuffer& fb, const IRect& clip, const Framebuffer& strip, int x, int y, int w, int scroll);
+
+// Copy the opaque pixels of `img` to (x, y), clipped like BlitWrapped.
+// Returns the pixels written.
+uint64_t BlitSprite(Framebuffer& fb, const IRect& clip, const Framebuffer& img, int x, int y);
+
+// A sprite as same-colored rectangles: each row's runs, with a run
+// carried down while the rows below repeat it. For backends that can
+// only fill (GDI); a cloud comes out as 4 rectangles.
+struct SpriteRect { IRect r; Color c; };
+void SpriteRects(const Framebuffer& img, std::vector<SpriteRect>& out);
+
+class SoftBackend : public DrawBackend {
+public:
+    explicit SoftBackend(Framebuffer& fb) : fb_(fb) { ResetClip(); }
+
+    // Everything drawn is clipped to this rectangle (damage repaint).
+    void SetClip(const IRect& r){ clip_ = r; }
+    void ResetClip(){ clip_ = IRect{ 0, 0, 1 << 30, 1 << 30 }; }
+
+    // Pixels written since the last ResetPixels()
+    uint64_t Pixels() const { return pixels_; }
+    void     ResetPixels(){ pixels_ = 0; }
+
+    GlyphCache& Glyphs(){ return glyphs_; }
+
+    void BeginFrame() override {}
+    void FillRect(int l, int t, int r, int b, Color c) override;
+    void FrameRect(int l, int t, int r, int b, Color c) override;
+    void Text(int x, int y, const wchar_t* s, int len, Color c, int size, bool bold) override;
+    void EndFrame() override {}
+    void FillSquares(const float* x, const float* y, size_t n, int size, Color c) override;
+    void Layer(const Framebuffer& strip, int x, int y, int w, int scroll) override;
+    void Sprite(const Framebuffer& img, int x, int y) override;
+
+private:
+    void Span(int l, int t, int r, int b, uint32_t p);
+
+    Framebuffer& fb_;
+    IRect        clip_;
+    uint64_t     pixels_ = 0;
+    GlyphCache   glyphs_;
+};
+
+bool WritePPM(const Framebuffer& fb, const char* path);
+
+#endif
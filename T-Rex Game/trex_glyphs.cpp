@@ -0,0 +1,165 @@
+// ------------------------------------------------------------------
+// File: trex_glyphs.cpp
+// Built-in 5x7 font and per-size glyph atlases
+// ------------------------------------------------------------------
+#include "trex_glyphs.h"
+#include <algorithm>
+
+// 5x7 glyphs for ASCII 32..126, one byte per row, bit 4 = leftmost column.
+static const uint8_t FONT5X7[95][7] = {
+    { 0x00,0x00,0x00,0x00,0x00,0x00,0x00 }, // ' '
+    { 0x04,0x04,0x04,0x04,0x04,0x00,0x04 }, // '!'
+    { 0x0A,0x0A,0x0A,0x00,0x00,0x00,0x00 }, // '"'
+    { 0x0A,0x0A,0x1F,0x0A,0x1F,0x0A,0x0A }, // '#'
+    { 0x04,0x0F,0x14,0x0E,0x05,0x1E,0x04 }, // '$'
+    { 0x18,0x19,0x02,0x04,0x08,0x13,0x03 }, // '%'
+    { 0x0C,0x12,0x14,0x08,0x15,0x12,0x0D }, // '&'
+    { 0x04,0x04,0x08,0x00,0x00,0x00,0x00 }, // '''
+    { 0x02,0x04,0x08,0x08,0x08,0x04,0x02 }, // '('
+    { 0x08,0x04,0x02,0x02,0x02,0x04,0x08 }, // ')'
+    { 0x00,0x04,0x15,0x0E,0x15,0x04,0x00 }, // '*'
+    { 0x00,0x04,0x04,0x1F,0x04,0x04,0x00 }, // '+'
+    { 0x00,0x00,0x00,0x00,0x0C,0x04,0x08 }, // ','
+    { 0x00,0x00,0x00,0x1F,0x00,0x00,0x00 }, // '-'
+    { 0x00,0x00,0x00,0x00,0x00,0x0C,0x0C }, // '.'
+    { 0x00,0x01,0x02,0x04,0x08,0x10,0x00 }, // '/'
+    { 0x0E,0x11,0x13,0x15,0x19,0x11,0x0E }, // '0'
+    { 0x04,0x0C,0x04,0x04,0x04,0x04,0x0E }, // '1'
+    { 0x0E,0x11,0x01,0x02,0x04,0x08,0x1F }, // '2'
+    { 0x1F,0x02,0x04,0x02,0x01,0x11,0x0E }, // '3'
+    { 0x02,0x06,0x0A,0x12,0x1F,0x02,0x02 }, // '4'
+    { 0x1F,0x10,0x1E,0x01,0x01,0x11,0x0E }, // '5'
+    { 0x06,0x08,0x10,0x1E,0x11,0x11,0x0E }, // '6'
+    { 0x1F,0x01,0x02,0x04,0x08,0x08,0x08 }, // '7'
+    { 0x0E,0x11,0x11,0x0E,0x11,0x11,0x0E }, // '8'
+    { 0x0E,0x11,0x11,0x0F,0x01,0x02,0x0C }, // '9'
+    { 0x00,0x0C,0x0C,0x00,0x0C,0x0C,0x00 }, // ':'
+    { 0x00,0x0C,0x0C,0x00,0x0C,0x04,0x08 }, // ';'
+    { 0x02,0x04,0x08,0x10,0x08,0x04,0x02 }, // '<'
+    { 0x00,0x00,0x1F,0x00,0x1F,0x00,0x00 }, // '='
+    { 0x08,0x04,0x02,0x01,0x02,0x04,0x08 }, // '>'
+    { 0x0E,0x11,0x01,0x02,0x04,0x00,0x04 }, // '?'
+    { 0x0E,0x11,0x01,0x0D,0x15,0x15,0x0E }, // '@'
+    { 0x0E,0x11,0x11,0x1F,0x11,0x11,0x11 }, // 'A'
+    { 0x1E,0x11,0x11,0x1E,0x11,0x11,0x1E }, // 'B'
+    { 0x0E,0x11,0x10,0x10,0x10,0x11,0x0E }, // 'C'
+    { 0x1C,0x12,0x11,0x11,0x11,0x12,0x1C }, // 'D'
+    { 0x1F,0x10,0x10,0x1E,0x10,0x10,0x1F }, // 'E'
+    { 0x1F,0x10,0x10,0x1E,0x10,0x10,0x10 }, // 'F'
+    { 0x0E,0x11,0x10,0x17,0x11,0x11,0x0F }, // 'G'
+    { 0x11,0x11,0x11,0x1F,0x11,0x11,0x11 }, // 'H'
+    { 0x0E,0x04,0x04,0x04,0x04,0x04,0x0E }, // 'I'
+    { 0x07,0x02,0x02,0x02,0x02,0x12,0x0C }, // 'J'
+    { 0x11,0x12,0x14,0x18,0x14,0x12,0x11 }, // 'K'
+    { 0x10,0x10,0x10,0x10,0x10,0x10,0x1F }, // 'L'
+    { 0x11,0x1B,0x15,0x15,0x11,0x11,0x11 }, // 'M'
+    { 0x11,0x11,0x19,0x15,0x13,0x11,0x11 }, // 'N'
+    { 0x0E,0x11,0x11,0x11,0x11,0x11,0x0E }, // 'O'
+    { 0x1E,0x11,0x11,0x1E,0x10,0x10,0x10 }, // 'P'
+    { 0x0E,0x11,0x11,0x11,0x15,0x12,0x0D }, // 'Q'
+    { 0x1E,0x11,0x11,0x1E,0x14,0x12,0x11 }, // 'R'
+    { 0x0F,0x10,0x10,0x0E,0x01,0x01,0x1E }, // 'S'
+    { 0x1F,0x04,0x04,0x04,0x04,0x04,0x04 }, // 'T'
+    { 0x11,0x11,0x11,0x11,0x11,0x11,0x0E }, // 'U'
+    { 0x11,0x11,0x11,0x11,0x11,0x0A,0x04 }, // 'V'
+    { 0x11,0x11,0x11,0x15,0x15,0x15,0x0A }, // 'W'
+    { 0x11,0x11,0x0A,0x04,0x0A,0x11,0x11 }, // 'X'
+    { 0x11,0x11,0x11,0x0A,0x04,0x04,0x04 }, // 'Y'
+    { 0x1F,0x01,0x02,0x04,0x08,0x10,0x1F }, // 'Z'
+    { 0x0E,0x08,0x08,0x08,0x08,0x08,0x0E }, // '['
+    { 0x00,0x10,0x08,0x04,0x02,0x01,0x00 }, // '\\'
+    { 0x0E,0x02,0x02,0x02,0x02,0x02,0x0E }, // ']'
+    { 0x04,0x0A,0x11,0x00,0x00,0x00,0x00 }, // '^'
+    { 0x00,0x00,0x00,0x00,0x00,0x00,0x1F }, // '_'
+    { 0x08,0x04,0x02,0x00,0x00,0x00,0x00 }, // '`'
+    { 0x00,0x00,0x0E,0x01,0x0F,0x11,0x0F }, // 'a'
+    { 0x10,0x10,0x16,0x19,0x11,0x11,0x1E }, // 'b'
+    { 0x00,0x00,0x0E,0x10,0x10,0x11,0x0E }, // 'c'
+    { 0x01,0x01,0x0D,0x13,0x11,0x11,0x0F }, // 'd'
+    { 0x00,0x00,0x0E,0x11,0x1F,0x10,0x0E }, // 'e'
+    { 0x06,0x09,0x08,0x1C,0x08,0x08,0x08 }, // 'f'
+    { 0x00,0x0F,0x11,0x11,0x0F,0x01,0x0E }, // 'g'
+    { 0x10,0x10,0x16,0x19,0x11,0x11,0x11 }, // 'h'
+    { 0x04,0x00,0x0C,0x04,0x04,0x04,0x0E }, // 'i'
+    { 0x02,0x00,0x06,0x02,0x02,0x12,0x0C }, // 'j'
+    { 0x10,0x10,0x12,0x14,0x18,0x14,0x12 }, // 'k'
+    { 0x0C,0x04,0x04,0x04,0x04,0x04,0x0E }, // 'l'
+    { 0x00,0x00,0x1A,0x15,0x15,0x11,0x11 }, // 'm'
+    { 0x00,0x00,0x16,0x19,0x11,0x11,0x11 }, // 'n'
+    { 0x00,0x00,0x0E,0x11,0x11,0x11,0x0E }, // 'o'
+    { 0x00,0x00,0x1E,0x11,0x1E,0x10,0x10 }, // 'p'
+    { 0x00,0x00,0x0D,0x13,0x0F,0x01,0x01 }, // 'q'
+    { 0x00,0x00,0x16,0x19,0x10,0x10,0x10 }, // 'r'
+    { 0x00,0x00,0x0E,0x10,0x0E,0x01,0x1E }, // 's'
+    { 0x08,0x08,0x1C,0x08,0x08,0x09,0x06 }, // 't'
+    { 0x00,0x00,0x11,0x11,0x11,0x13,0x0D }, // 'u'
+    { 0x00,0x00,0x11,0x11,0x11,0x0A,0x04 }, // 'v'
+    { 0x00,0x00,0x11,0x11,0x15,0x15,0x0A }, // 'w'
+    { 0x00,0x00,0x11,0x0A,0x04,0x0A,0x11 }, // 'x'
+    { 0x00,0x00,0x11,0x11,0x0F,0x01,0x0E }, // 'y'
+    { 0x00,0x00,0x1F,0x02,0x04,0x08,0x1F }, // 'z'
+    { 0x02,0x04,0x04,0x08,0x04,0x04,0x02 }, // '{'
+    { 0x04,0x04,0x04,0x04,0x04,0x04,0x04 }, // '|'
+    { 0x08,0x04,0x04,0x02,0x04,0x04,0x08 }, // '}'
+    { 0x00,0x00,0x08,0x15,0x02,0x00,0x00 }, // '~'
+};
+
+
+static const int GLYPH_W = 5, GLYPH_H = 7, GLYPH_ADV = 6;
+
+// The menu strings use a few typographic dashes; everything else
+// outside ASCII shows as '?'.
+int GlyphIndex(wchar_t ch){
+    if(ch == 0x2010 || ch == 0x2011 || ch == 0x2013 || ch == 0x2014) ch = L'-';
+    if(ch < 32 || ch > 126) ch = L'?';
+    return (int)ch - 32;
+}
+
+int FontScale(int size){ return std::max(1, (size + 4) / 9); }
+
+int TextWidth(const wchar_t*, int len, int size){ return len * GLYPH_ADV * FontScale(size); }
+
+int TextTop(int y, int size){ return y + std::max(0, (size - GLYPH_H * FontScale(size)) / 2); }  // roughly centre in the GDI cell
+
+IRect TextBounds(int x, int y, int len, int size, bool bold){
+    int k = FontScale(size), top = TextTop(y, size);
+    return IRect{ x, top, x + len * GLYPH_ADV * k + (bold ? 1 : 0), top + GLYPH_H * k };
+}
+
+// ----------------- Atlas -----------------------------
+// Each 5x7 bit is blown up to a k x k block; bold smears every run one
+// pixel to the right (still inside the 6k advance).
+void GlyphAtlas::Build(int fontSize, bool fontBold){
+    size = fontSize; bold = fontBold;
+    int k = FontScale(size);
+    cellW = GLYPH_ADV * k; cellH = GLYPH_H * k;
+    stride = cellW * GLYPH_COUNT;
+    mask.assign((size_t)stride * cellH, 0);
+    for(int g=0;g<GLYPH_COUNT;g++){
+        for(int row=0;row<GLYPH_H;row++){
+            uint8_t bits = FONT5X7[g][row];
+            for(int col=0;col<GLYPH_W;col++){
+                if(!(bits & (0x10 >> col))) continue;
+                int l = col * k, r = (col + 1) * k + (bold ? 1 : 0);
+                for(int yy=row*k;yy<(row+1)*k;yy++){
+                    uint8_t* m = mask.data() + (size_t)yy * stride + g * cellW;
+                    for(int xx=l;xx<r && xx<cellW;xx++) m[xx] = 0xFF;
+                }
+            }
+        }
+    }
+}
+
+const GlyphAtlas& GlyphCache::Get(int size, bool bold){
+    for(const auto &a: atlases_) if(a.size == size && a.bold == bold) return a;
+    atlases_.push_back(GlyphAtlas());
+    atlases_.back().Build(size, bold);
+    built_++;
+    return atlases_.back();
+}
+
+void GlyphCache::Prebuild(const FontSpec* fonts, int count){
+    // reserve first so references handed out later stay valid
+    atlases_.reserve(atlases_.size() + (size_t)count);
+    for(int i=0;i<count;i++) Get(fonts[i].size, fonts[i].bold);
+}
@@ -0,0 +1,54 @@
+// ------------------------------------------------------------------
+// File: trex_glyphs.h
+// Pre-rasterised glyph atlases for the software renderer's text
+// ------------------------------------------------------------------
+//  - one GlyphAtlas per (font size, bold), built once: every printable
+//    ASCII glyph as an 8-bit mask, laid out side by side
+//  - text drawing is then a masked copy per glyph, no per-frame raster
+//  - metrics (TextBounds) are shared with the damage tracker
+// ------------------------------------------------------------------
+#ifndef TREX_GLYPHS_H
+#define TREX_GLYPHS_H
+
+#include "trex_draw.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+static const int GLYPH_COUNT = 95;           // ASCII 32..126
+
+struct FontSpec { int size; bool bold; };
+
+struct GlyphAtlas {
+    int  size = 0;
+    bool bold = false;
+    int  cellW = 0, cellH = 0;               // one glyph cell == advance
+    int  stride = 0;                         // cellW * GLYPH_COUNT
+    std::vector<uint8_t> mask;               // 0 or 0xFF
+
+    void Build(int fontSize, bool fontBold);
+    const uint8_t* Row(int glyph, int y) const { return mask.data() + (size_t)y * stride + (size_t)glyph * cellW; }
+};
+
+class GlyphCache {
+public:
+    // Atlas for this font, built on first use
+    const GlyphAtlas& Get(int size, bool bold);
+    // Build a known set up front (at startup) so frames never build one
+    void Prebuild(const FontSpec* fonts, int count);
+    uint32_t Built() const { return built_; }
+
+private:
+    std::vector<GlyphAtlas> atlases_;
+    uint32_t built_ = 0;
+};
+
+int   GlyphIndex(wchar_t ch);
+// Pixel scale of the built-in font for a GDI-style font height.
+int   FontScale(int size);
+int   TextWidth(const wchar_t* s, int len, int size);
+int   TextTop(int y, int size);
+// Every pixel Text() may touch for this string
+IRect TextBounds(int x, int y, int len, int size, bool bold);
+
+#endif
@@ -0,0 +1,117 @@
+// ------------------------------------------------------------------
+// File: trex_net.cpp
+// UdpLink
+// ------------------------------------------------------------------
+#include "trex_net.h"
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600       // inet_pton; MinGW hides it below Vista
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int    socklen_t;
+typedef SOCKET NativeSocket;
+static bool NetInit(){ WSADATA d; return WSAStartup(MAKEWORD(2, 2), &d) == 0; }
+static void CloseSocket(intptr_t s){ closesocket((SOCKET)s); }
+static bool SetNonBlocking(intptr_t s){ u_long on = 1; return ioctlsocket((SOCKET)s, FIONBIO, &on) == 0; }
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int NativeSocket;
+static bool NetInit(){ return true; }
+static void CloseSocket(intptr_t s){ close((int)s); }
+static bool SetNonBlocking(intptr_t s){ return fcntl((int)s, F_SETFL, fcntl((int)s, F_GETFL, 0) | O_NONBLOCK) == 0; }
+#endif
+
+static_assert(sizeof(sockaddr_in) <= 16, "peer_ holds a sockaddr_in");
+
+static uint64_t NowUs(){
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool UdpLink::Open(uint16_t localPort, const char* peerHost, uint16_t peerPort){
+    Close();
+    if(!NetInit()) return false;
+    intptr_t s = (intptr_t)socket(AF_INET, SOCK_DGRAM, 0);
+    if(s < 0) return false;
+    sockaddr_in me;
+    std::memset(&me, 0, sizeof(me));
+    me.sin_family = AF_INET;
+    me.sin_addr.s_addr = htonl(INADDR_ANY);
+    me.sin_port = htons(localPort);
+    sockaddr_in peer;
+    std::memset(&peer, 0, sizeof(peer));
+    peer.sin_family = AF_INET;
+    peer.sin_port = htons(peerPort);
+    if(bind((NativeSocket)s, (const sockaddr*)&me, sizeof(me)) != 0 || !SetNonBlocking(s) ||
+       inet_pton(AF_INET, peerHost, &peer.sin_addr) != 1){
+        CloseSocket(s);
+        return false;
+    }
+    std::memcpy(peer_, &peer, sizeof(peer));
+    sock_ = s;
+    return true;
+}
+
+void UdpLink::Close(){
+    if(sock_ >= 0) CloseSocket(sock_);
+    sock_ = -1;
+    heldCount_ = 0;
+}
+
+void UdpLink::SetImpairment(const NetImpairment& imp){
+    imp_ = imp;
+    impaired_ = imp.latencyMs > 0 || imp.jitterMs > 0 || imp.loss > 0.0f;
+    rng_.seed(imp.seed, 7);
+}
+
+bool UdpLink::SendNow(const void* data, size_t n){
+    sent_++;
+    return sendto((NativeSocket)sock_, (const char*)data, (int)n, 0, (const sockaddr*)peer_, sizeof(sockaddr_in)) == (int)n;
+}
+
+bool UdpLink::Send(const void* data, size_t n){
+    if(sock_ < 0 || n > (size_t)MAX_DATAGRAM) return false;
+    Pump();
+    if(!impaired_) return SendNow(data, n);
+    if(rng_.uniform(0.0f, 1.0f) < imp_.loss){ dropped_++; return true; }
+    if(heldCount_ == MAX_HELD){ dropped_++; return true; }   // a full queue drops, like a router
+    int delay = imp_.latencyMs + (imp_.jitterMs ? rng_.range(-imp_.jitterMs, imp_.jitterMs) : 0);
+    Held& h = held_[heldCount_++];
+    h.due = NowUs() + (uint64_t)(delay > 0 ? delay : 0) * 1000ull;
+    h.n = (int)n;
+    std::memcpy(h.data, data, n);
+    return true;
+}
+
+void UdpLink::Pump(){
+    if(!heldCount_) return;
+    uint64_t now = NowUs();
+    for(int i=0;i<heldCount_;){
+        if(held_[i].due > now){ i++; continue; }
+        SendNow(held_[i].data, (size_t)held_[i].n);
+        held_[i] = held_[--heldCount_];           // order is jitter's business
+    }
+}
+
+int UdpLink::Receive(void* buf, size_t cap){
+    if(sock_ < 0) return -1;
+    Pump();
+    const sockaddr_in* peer = (const sockaddr_in*)peer_;
+    for(;;){
+        sockaddr_in from;
+        socklen_t len = sizeof(from);
+        int n = (int)recvfrom((NativeSocket)sock_, (char*)buf, (int)cap, 0, (sockaddr*)&from, &len);
+        if(n < 0) return -1;
+        if(from.sin_port != peer->sin_port) continue;      // not our peer
+        received_++;
+        return n;
+    }
+}
@@ -0,0 +1,68 @@
+// ------------------------------------------------------------------
+// File: trex_net.h
+// Non-blocking UDP link to one peer, with injectable impairment
+// ------------------------------------------------------------------
+//  - UdpLink binds a local port and exchanges datagrams with one fixed
+//    peer address; Receive() never blocks
+//  - NetImpairment holds outgoing datagrams back by latency +- jitter
+//    (which also reorders them) and drops a fraction, so rollback can
+//    be exercised on loopback
+//  - POSIX sockets, or Winsock on _WIN32
+// ------------------------------------------------------------------
+#ifndef TREX_NET_H
+#define TREX_NET_H
+
+#include "trex_sim.h"
+#include <cstddef>
+#include <cstdint>
+
+struct NetImpairment {
+    int      latencyMs = 0;       // one way
+    int      jitterMs  = 0;       // +- uniform
+    float    loss      = 0.0f;    // 0..1
+    uint64_t seed      = 1;
+};
+
+class UdpLink {
+public:
+    static const int MAX_DATAGRAM = 128;
+    static const int MAX_HELD     = 256;
+
+    UdpLink() {}
+    ~UdpLink(){ Close(); }
+    UdpLink(const UdpLink&) = delete;
+    UdpLink& operator=(const UdpLink&) = delete;
+
+    bool Open(uint16_t localPort, const char* peerHost, uint16_t peerPort);
+    void Close();
+    void SetImpairment(const NetImpairment& imp);
+
+    // False if the datagram was too large or the send failed. Under
+    // impairment it is queued (or dropped) and true is returned.
+    bool Send(const void* data, size_t n);
+    // Bytes of the next datagram from the peer, or -1 if none waiting.
+    int  Receive(void* buf, size_t cap);
+    // Puts held datagrams whose time has come on the wire; Send and
+    // Receive call it too.
+    void Pump();
+
+    uint64_t Sent() const { return sent_; }
+    uint64_t Dropped() const { return dropped_; }
+    uint64_t Received() const { return received_; }
+
+private:
+    bool SendNow(const void* data, size_t n);
+
+    struct Held { uint64_t due; int n; uint8_t data[MAX_DATAGRAM]; };
+
+    intptr_t sock_ = -1;
+    uint8_t  peer_[16] = {};      // sockaddr_in
+    NetImpairment imp_;
+    bool     impaired_ = false;
+    Pcg32    rng_;
+    Held     held_[MAX_HELD];
+    int      heldCount_ = 0;
+    uint64_t sent_ = 0, dropped_ = 0, received_ = 0;
+};
+
+#endif
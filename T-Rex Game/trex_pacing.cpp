@@ -0,0 +1,126 @@
+// ------------------------------------------------------------------
+// File: trex_pacing.cpp
+// FramePacer accumulator + PacingHist
+// ------------------------------------------------------------------
+#include "trex_pacing.h"
+#include "trex_bits.h"
+#include <chrono>
+#include <cmath>
+
+uint64_t SteadyClock::Now(){
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------------- Histogram --------------------------
+int PacingHist::Index(uint64_t us){
+    if(us < 2 * SUB) return (int)us;
+    int e = HighBit(us);                           // >= 8
+    int i = 2 * SUB + (e - 8) * SUB + (int)((us >> (e - 7)) - SUB);
+    return i < BINS ? i : BINS - 1;
+}
+
+uint64_t PacingHist::Lower(int i){
+    if(i < 2 * SUB) return (uint64_t)i;
+    int e = 8 + (i - 2 * SUB) / SUB;
+    uint64_t m = (uint64_t)(SUB + (i - 2 * SUB) % SUB);
+    return m << (e - 7);
+}
+
+void PacingHist::Add(uint64_t us){
+    // single writer (the game thread); relaxed is enough for readers
+    bins_[Index(us)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(us, std::memory_order_relaxed);
+    if(us > max_.load(std::memory_order_relaxed)) max_.store(us, std::memory_order_relaxed);
+}
+
+void PacingHist::Reset(){
+    for(auto &b: bins_) b.store(0, std::memory_order_relaxed);
+    count_ = 0; sum_ = 0; max_ = 0;
+}
+
+HistSummary PacingHist::Summary() const {
+    HistSummary s{ 0, 0.0, 0, 0, 0, 0 };
+    // bins are read one by one, so count from them rather than count_
+    uint64_t total = 0;
+    for(const auto &b: bins_) total += b.load(std::memory_order_relaxed);
+    s.count = total;
+    if(!total) return s;
+    s.mean = (double)sum_.load(std::memory_order_relaxed) / (double)count_.load(std::memory_order_relaxed);
+    s.max  = max_.load(std::memory_order_relaxed);
+    const double ps[3] = { 50.0, 90.0, 99.0 };
+    uint64_t* out[3] = { &s.p50, &s.p90, &s.p99 };
+    uint64_t seen = 0; int k = 0;
+    for(int i=0;i<BINS && k<3;i++){
+        seen += bins_[i].load(std::memory_order_relaxed);
+        while(k < 3 && seen >= (uint64_t)std::ceil(ps[k] / 100.0 * (double)total)){ *out[k] = Lower(i); k++; }
+    }
+    return s;
+}
+
+void PacingHist::Export(std::FILE* f, const char* name) const {
+    for(int i=0;i<BINS;i++){
+        uint64_t c = bins_[i].load(std::memory_order_relaxed);
+        if(c) std::fprintf(f, "%s,%llu,%llu\n", name, (unsigned long long)Lower(i), (unsigned long long)c);
+    }
+}
+
+// ---------------- Stats ------------------------------
+void PacingStats::Reset(){
+    interval.Reset(); render.Reset();
+    for(auto &s: steps) s = 0;
+    frames = 0; clamped = 0;
+}
+
+static void ExportSummary(std::FILE* f, const char* name, const HistSummary& s){
+    std::fprintf(f, "# %-8s n %llu  mean %.0f us  p50 %llu  p90 %llu  p99 %llu  max %llu us\n", name,
+                 (unsigned long long)s.count, s.mean, (unsigned long long)s.p50, (unsigned long long)s.p90,
+                 (unsigned long long)s.p99, (unsigned long long)s.max);
+}
+
+void PacingStats::Export(std::FILE* f, bool bins) const {
+    std::fprintf(f, "# frames %llu, clamped intervals %llu\n",
+                 (unsigned long long)frames.load(), (unsigned long long)clamped.load());
+    ExportSummary(f, "interval", interval.Summary());
+    ExportSummary(f, "render", render.Summary());
+    std::fprintf(f, "# steps/frame");
+    for(int i=0;i<=PACING_MAX_STEPS;i++)
+        std::fprintf(f, "  %d%s:%llu", i, i == PACING_MAX_STEPS ? "+" : "", (unsigned long long)steps[i].load());
+    std::fputc('\n', f);
+    if(!bins) return;
+    std::fprintf(f, "hist,lower_us,count\n");
+    interval.Export(f, "interval");
+    render.Export(f, "render");
+}
+
+// ---------------- Pacer ------------------------------
+void FramePacer::Reset(){
+    prev_ = clock_.Now();
+    acc_ = 0.0;
+}
+
+int FramePacer::Advance(){
+    uint64_t now = clock_.Now();
+    uint64_t ticks = now - prev_;
+    prev_ = now;
+    stats_.interval.Add(ToMicros(ticks));
+    stats_.frames.fetch_add(1, std::memory_order_relaxed);
+
+    double dt = (double)ticks / (double)clock_.Frequency();
+    // clamp dt to avoid huge jumps
+    if(dt > maxDt_){ dt = maxDt_; stats_.clamped.fetch_add(1, std::memory_order_relaxed); }
+    acc_ += dt;
+    int n = 0;
+    while(acc_ >= step_){ acc_ -= step_; n++; }
+    stats_.steps[n < PACING_MAX_STEPS ? n : PACING_MAX_STEPS].fetch_add(1, std::memory_order_relaxed);
+    return n;
+}
+
+void FramePacer::Mark(uint64_t steps){
+    uint64_t now = clock_.Now();
+    stats_.interval.Add(ToMicros(now - prev_));
+    prev_ = now;
+    stats_.frames.fetch_add(1, std::memory_order_relaxed);
+    stats_.steps[steps < PACING_MAX_STEPS ? steps : PACING_MAX_STEPS].fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,120 @@
+// ------------------------------------------------------------------
+// File: trex_pacing.h
+// Fixed-step frame pacing with timing histograms
+// ------------------------------------------------------------------
+//  - Clock: where time comes from (QueryPerformanceCounter in the game,
+//    steady_clock for tools, FakeClock for deterministic checks)
+//  - FramePacer: a fixed-step accumulator (clamp at 0.08 s, fixed DT
+//    steps) plus records of frame interval, update steps per frame and
+//    render cost. The game's UI thread only Mark()s frames; its steps
+//    run on the sim thread (trex_simthread.h)
+//  - PacingHist: log-bucketed microsecond histogram of relaxed atomics,
+//    so another thread can snapshot/export it while frames are recorded
+// ------------------------------------------------------------------
+#ifndef TREX_PACING_H
+#define TREX_PACING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+class Clock {
+public:
+    virtual ~Clock() {}
+    virtual uint64_t Now() = 0;                  // ticks
+    virtual uint64_t Frequency() const = 0;      // ticks per second
+};
+
+// std::chrono::steady_clock in nanoseconds
+class SteadyClock : public Clock {
+public:
+    uint64_t Now() override;
+    uint64_t Frequency() const override { return 1000000000ull; }
+};
+
+// Only moves when told to.
+class FakeClock : public Clock {
+public:
+    explicit FakeClock(uint64_t freq = 1000000000ull) : freq_(freq) {}
+    uint64_t Now() override { return now_; }
+    uint64_t Frequency() const override { return freq_; }
+    void Advance(uint64_t ticks){ now_ += ticks; }
+    void AdvanceSeconds(double s){ now_ += (uint64_t)(s * (double)freq_ + 0.5); }
+
+private:
+    uint64_t now_ = 0, freq_;
+};
+
+struct HistSummary {
+    uint64_t count;
+    double   mean;                 // microseconds
+    uint64_t p50, p90, p99, max;   // microseconds (bin lower bounds, max exact)
+};
+
+// Microsecond histogram, < 1% bucket error.
+class PacingHist {
+public:
+    static const int SUB  = 128;
+    static const int BINS = 2 * SUB + 32 * SUB;
+
+    void Add(uint64_t us);
+    void Reset();
+    HistSummary Summary() const;
+    // "name,lower_us,count" for every non-empty bin
+    void Export(std::FILE* f, const char* name) const;
+
+    static int      Index(uint64_t us);
+    static uint64_t Lower(int i);
+
+private:
+    std::atomic<uint64_t> bins_[BINS] = {};
+    std::atomic<uint64_t> count_{0}, sum_{0}, max_{0};
+};
+
+static const int PACING_MAX_STEPS = 8;    // the last bucket means ">= 8"
+
+struct PacingStats {
+    PacingHist interval;           // time between Advance() calls
+    PacingHist render;             // RenderStart() .. RenderEnd()
+    std::atomic<uint64_t> steps[PACING_MAX_STEPS + 1] = {};   // frames by update steps run
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> clamped{0};   // intervals longer than the clamp (time dropped)
+
+    void Reset();
+    void Export(std::FILE* f, bool bins = true) const;   // summary lines (#) + CSV bins
+};
+
+class FramePacer {
+public:
+    explicit FramePacer(Clock& clock, double step, double maxDt = 0.08)
+        : clock_(clock), step_(step), maxDt_(maxDt) {}
+
+    // Start timing from now (window creation, after a pause).
+    void Reset();
+    // Call once per timer tick; returns how many fixed steps to run.
+    int  Advance();
+    // For a frame whose steps ran elsewhere (a sim thread): records the
+    // interval and the steps the frame showed; the accumulator is unused.
+    void Mark(uint64_t steps);
+    void RenderStart(){ renderStart_ = clock_.Now(); }
+    void RenderEnd()  { stats_.render.Add(ToMicros(clock_.Now() - renderStart_)); }
+
+    double Accumulated() const { return acc_; }
+    PacingStats&       Stats()       { return stats_; }
+    const PacingStats& Stats() const { return stats_; }
+
+private:
+    uint64_t ToMicros(uint64_t ticks) const {
+        uint64_t f = clock_.Frequency();
+        return ticks / f * 1000000ull + ticks % f * 1000000ull / f;
+    }
+
+    Clock&   clock_;
+    double   step_, maxDt_;
+    double   acc_ = 0.0;
+    uint64_t prev_ = 0, renderStart_ = 0;
+    PacingStats stats_;
+};
+
+#endif
@@ -0,0 +1,152 @@
+// ------------------------------------------------------------------
+// File: trex_palette.cpp
+// Night ramp, LUT construction and the remap kernels (AVX2 / SSE2 / scalar)
+// ------------------------------------------------------------------
+#include "trex_palette.h"
+#include <cmath>
+
+#if !defined(TREX_SIMD_SCALAR) && defined(__AVX2__)
+  #define TREX_PAL_AVX2 1
+  #include <immintrin.h>
+#elif !defined(TREX_SIMD_SCALAR) && (defined(__SSE2__) || defined(_M_X64))
+  #define TREX_PAL_SSE2 1
+  #include <emmintrin.h>
+#endif
+
+const char* PaletteKernelName(){
+#if defined(TREX_PAL_AVX2)
+    return "avx2";
+#elif defined(TREX_PAL_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+// ---------------- Cycle ------------------------------
+// Per period: day, fade in, night, fade out (ending at the period's end)
+float NightAmount(int score){
+    if(score < NIGHT_START) return 0.0f;
+    int s = score % NIGHT_PERIOD;
+    if(s < NIGHT_START) return 0.0f;
+    if(s < NIGHT_START + NIGHT_FADE) return (float)(s - NIGHT_START) / NIGHT_FADE;
+    if(s < NIGHT_PERIOD - NIGHT_FADE) return 1.0f;
+    return (float)(NIGHT_PERIOD - s) / NIGHT_FADE;
+}
+
+// ---------------- LUT --------------------------------
+void PaletteLut::Identity(){
+    for(uint32_t v=0;v<256;v++){ r[v] = v << 16; g[v] = v << 8; b[v] = v; }
+}
+
+// Each channel runs from its NIGHT_FROM_BLACK value (v = 0) down to its
+// NIGHT_FROM_WHITE value (v = 255): light gray sky turns navy, the dark
+// dino and obstacles turn pale.
+void PaletteLut::Night(float t){
+    const int hi[3] = { (int)(NIGHT_FROM_BLACK & 0xFF), (int)((NIGHT_FROM_BLACK >> 8) & 0xFF), (int)((NIGHT_FROM_BLACK >> 16) & 0xFF) };
+    const int lo[3] = { (int)(NIGHT_FROM_WHITE & 0xFF), (int)((NIGHT_FROM_WHITE >> 8) & 0xFF), (int)((NIGHT_FROM_WHITE >> 16) & 0xFF) };
+    uint32_t* tab[3] = { r, g, b };
+    const int shift[3] = { 16, 8, 0 };
+    for(int c=0;c<3;c++){
+        for(int v=0;v<256;v++){
+            float night = (float)hi[c] + (float)(lo[c] - hi[c]) * (float)v / 255.0f;
+            int out = (int)std::lround((float)v + (night - (float)v) * t);
+            out = out < 0 ? 0 : (out > 255 ? 255 : out);
+            tab[c][v] = (uint32_t)out << shift[c];
+        }
+    }
+}
+
+bool DayNight::Update(int score){
+    int level = (int)std::lround(NightAmount(score) * NIGHT_LEVELS);
+    if(level == level_) return false;
+    level_ = level;
+    if(level_ == 0) lut_.Identity();
+    else lut_.Night((float)level_ / NIGHT_LEVELS);
+    return true;
+}
+
+// ---------------- Remap ------------------------------
+// Flat sky and ground make long runs of one pixel value, so the last
+// lookup is remembered and uniform blocks are stored without a lookup.
+static void RemapRowScalar(const PaletteLut& lut, const uint32_t* s, uint32_t* d, int n,
+                           uint32_t& lastIn, uint32_t& lastOut){
+    for(int i=0;i<n;i++){
+        uint32_t p = s[i];
+        if(p != lastIn){ lastIn = p; lastOut = lut.MapPixel(p); }
+        d[i] = lastOut;
+    }
+}
+
+#if defined(TREX_PAL_AVX2)
+static inline int BitCount8(int m){
+    m = (m & 0x55) + ((m >> 1) & 0x55);
+    m = (m & 0x33) + ((m >> 2) & 0x33);
+    return (m & 0x0F) + (m >> 4);
+}
+#endif
+
+static void RemapRow(const PaletteLut& lut, const uint32_t* s, uint32_t* d, int n,
+                     uint32_t& lastIn, uint32_t& lastOut){
+    int i = 0;
+#if defined(TREX_PAL_AVX2)
+    // Gathers are slow on many cores (a 4K scene ran below scalar on
+    // some), so they are kept for blocks where the value changes often.
+    // An edge block needs a lookup per change, at most 3, and goes
+    // through the scalar run cache instead.
+    const __m256i mask = _mm256_set1_epi32(0xFF), alpha = _mm256_set1_epi32((int)0xFF000000u);
+    const __m256i prev = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6);
+    for(; i + 8 <= n; i += 8){
+        __m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+        uint32_t p = s[i];
+        if(_mm256_movemask_epi8(_mm256_cmpeq_epi32(v, _mm256_set1_epi32((int)p))) == -1){
+            if(p != lastIn){ lastIn = p; lastOut = lut.MapPixel(p); }
+            _mm256_storeu_si256((__m256i*)(d + i), _mm256_set1_epi32((int)lastOut));
+            continue;
+        }
+        // lanes 1..7 against the lane before; lane 0 against the cache
+        int same = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, _mm256_permutevar8x32_epi32(v, prev))));
+        if(BitCount8(~same & 0xFE) + (p != lastIn) <= 3){
+            RemapRowScalar(lut, s + i, d + i, 8, lastIn, lastOut);
+            continue;
+        }
+        __m256i ob = _mm256_i32gather_epi32((const int*)lut.b, _mm256_and_si256(v, mask), 4);
+        __m256i og = _mm256_i32gather_epi32((const int*)lut.g, _mm256_and_si256(_mm256_srli_epi32(v, 8), mask), 4);
+        __m256i orr = _mm256_i32gather_epi32((const int*)lut.r, _mm256_and_si256(_mm256_srli_epi32(v, 16), mask), 4);
+        __m256i o = _mm256_or_si256(_mm256_or_si256(ob, og), _mm256_or_si256(orr, alpha));
+        _mm256_storeu_si256((__m256i*)(d + i), o);
+    }
+#elif defined(TREX_PAL_SSE2)
+    // no gather: only the uniform blocks are vectorised
+    for(; i + 4 <= n; i += 4){
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+        uint32_t p = s[i];
+        if(_mm_movemask_epi8(_mm_cmpeq_epi32(v, _mm_set1_epi32((int)p))) == 0xFFFF){
+            if(p != lastIn){ lastIn = p; lastOut = lut.MapPixel(p); }
+            _mm_storeu_si128((__m128i*)(d + i), _mm_set1_epi32((int)lastOut));
+            continue;
+        }
+        RemapRowScalar(lut, s + i, d + i, 4, lastIn, lastOut);
+    }
+#endif
+    RemapRowScalar(lut, s + i, d + i, n - i, lastIn, lastOut);
+}
+
+static bool ClipRemap(const Framebuffer& src, const Framebuffer& dst, IRect& r){
+    r = Intersection(r, IRect{ 0, 0, src.w < dst.w ? src.w : dst.w, src.h < dst.h ? src.h : dst.h });
+    return !r.Empty();
+}
+
+void RemapRect(const PaletteLut& lut, const Framebuffer& src, Framebuffer& dst, const IRect& rect){
+    IRect r = rect;
+    if(!ClipRemap(src, dst, r)) return;
+    uint32_t lastIn = ~src.Row(r.t)[r.l], lastOut = 0;
+    for(int y=r.t;y<r.b;y++) RemapRow(lut, src.Row(y) + r.l, dst.Row(y) + r.l, r.r - r.l, lastIn, lastOut);
+}
+
+void RemapRectScalar(const PaletteLut& lut, const Framebuffer& src, Framebuffer& dst, const IRect& rect){
+    IRect r = rect;
+    if(!ClipRemap(src, dst, r)) return;
+    uint32_t lastIn = ~src.Row(r.t)[r.l], lastOut = 0;
+    for(int y=r.t;y<r.b;y++) RemapRowScalar(lut, src.Row(y) + r.l, dst.Row(y) + r.l, r.r - r.l, lastIn, lastOut);
+}
@@ -0,0 +1,82 @@
+// ------------------------------------------------------------------
+// File: trex_palette.h
+// Day/night cycle: score-driven color remap through per-channel LUTs
+// ------------------------------------------------------------------
+//  - the scene is always drawn in its day colors (COL_* stay fixed, so
+//    the display list diff and the GDI brush cache never see a fade)
+//  - NightAmount(score) gives the night weight; DayNight quantises it to
+//    NIGHT_LEVELS steps and rebuilds a PaletteLut only when the step
+//    changes. A LUT is three 256-entry tables, one per channel, holding
+//    the output byte already shifted into place
+//  - RemapRect() runs a framebuffer rectangle through the LUT into a
+//    second buffer (AVX2 gather, SSE2 or scalar; uniform runs of pixels
+//    take one lookup). The front end remaps the whole frame only on the
+//    frames where the step changes, otherwise just the damaged
+//    rectangles, so a fade costs at most one full-frame pass per frame
+//  - at step 0 the LUT is the identity and the day buffer is presented
+//    as is
+// ------------------------------------------------------------------
+#ifndef TREX_PALETTE_H
+#define TREX_PALETTE_H
+
+#include "trex_draw.h"
+#include "trex_fb.h"
+#include <cstdint>
+
+// One day + one night per NIGHT_PERIOD points; night starts at
+// NIGHT_START into each period and fades in/out over NIGHT_FADE points
+// (the score runs at 60 points/s).
+static const int NIGHT_PERIOD = 1400;
+static const int NIGHT_START  = 700;
+static const int NIGHT_FADE   = 90;
+static const int NIGHT_LEVELS = 32;    // fade steps, i.e. LUT rebuilds per fade
+
+// Night ends of the ramp: what pure black and pure white turn into
+static const Color NIGHT_FROM_BLACK = MakeColor(235, 238, 245);
+static const Color NIGHT_FROM_WHITE = MakeColor(16, 20, 36);
+
+// 0 = day, 1 = full night
+float NightAmount(int score);
+
+struct PaletteLut {
+    uint32_t r[256], g[256], b[256];   // pre-shifted: r[v] = v' << 16, ...
+
+    void Identity();
+    // Blend between the identity (t = 0) and the night ramp (t = 1)
+    void Night(float t);
+
+    uint32_t MapPixel(uint32_t p) const {
+        return 0xFF000000u | r[(p >> 16) & 0xFFu] | g[(p >> 8) & 0xFFu] | b[p & 0xFFu];
+    }
+    Color MapColor(Color c) const {
+        uint32_t p = MapPixel(ColorToPixel(c));
+        return MakeColor((p >> 16) & 0xFF, (p >> 8) & 0xFF, p & 0xFF);
+    }
+};
+
+// dst = lut(src) over r (clipped to both buffers; src may be dst).
+void RemapRect(const PaletteLut& lut, const Framebuffer& src, Framebuffer& dst, const IRect& r);
+void RemapRectScalar(const PaletteLut& lut, const Framebuffer& src, Framebuffer& dst, const IRect& r);
+
+// Name of the kernel RemapRect() compiled to ("avx2", "sse2", "scalar")
+const char* PaletteKernelName();
+
+class DayNight {
+public:
+    DayNight(){ Reset(); }
+
+    void Reset(){ level_ = 0; lut_.Identity(); }
+    // Moves to the step for `score`; true if the LUT changed, in which
+    // case everything presented must be remapped again.
+    bool Update(int score);
+
+    int  Level() const { return level_; }
+    bool IsDay() const { return level_ == 0; }
+    const PaletteLut& Lut() const { return lut_; }
+
+private:
+    int        level_;
+    PaletteLut lut_;
+};
+
+#endif
@@ -0,0 +1,21 @@
+// ------------------------------------------------------------------
+// File: trex_parallax.cpp
+// Layer strips: setup and scroll offsets
+// ------------------------------------------------------------------
+#include "trex_parallax.h"
+#include <algorithm>
+#include <cmath>
+
+void ParallaxLayer::Begin(int period, int height, int top, float rate, Color bg){
+    strip_.Resize(period, height);
+    std::fill(strip_.px.begin(), strip_.px.end(), ColorToPixel(bg));
+    top_ = top;
+    rate_ = rate;
+}
+
+int ParallaxLayer::Offset(double distance) const {
+    if(strip_.w <= 0) return 0;
+    double s = std::floor(distance * (double)rate_);
+    double m = std::fmod(s, (double)strip_.w);
+    return (int)(m < 0.0 ? m + strip_.w : m);
+}
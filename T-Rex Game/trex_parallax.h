@@ -0,0 +1,52 @@
+// ------------------------------------------------------------------
+// File: trex_parallax.h
+// Pre-rendered wrap-around background strips, one blit per layer
+// ------------------------------------------------------------------
+//  - a ParallaxLayer is painted once into a `period` x `height` strip
+//    (shapes crossing the seam are painted on both sides, so the strip
+//    tiles seamlessly) and drawn every frame with a single
+//    DrawBackend::Layer() call at a scroll offset
+//  - the cost of a frame's background is then the band's area, however
+//    many shapes the strip holds
+//  - nothing here knows about T-Rex: a layer is pixels, a screen row and
+//    a scroll rate; trex_render.cpp builds the ground's pebble band
+// ------------------------------------------------------------------
+#ifndef TREX_PARALLAX_H
+#define TREX_PARALLAX_H
+
+#include "trex_draw.h"
+#include "trex_fb.h"
+#include <cstdint>
+
+class ParallaxLayer {
+public:
+    // Clears the strip to `bg`; top = screen row of its first line,
+    // rate = strip pixels scrolled per unit of distance.
+    void Begin(int period, int height, int top, float rate, Color bg);
+
+    // paint(b, dx) draws the layer's shapes shifted by dx; it is called
+    // for dx = -period, 0 and +period so anything crossing an edge wraps.
+    template<class F>
+    void Paint(F paint){
+        SoftBackend sb(strip_);
+        for(int k=-1;k<=1;k++) paint(static_cast<DrawBackend&>(sb), k * strip_.w);
+    }
+
+    // Strip column shown at screen x = 0 after scrolling `distance`
+    int Offset(double distance) const;
+
+    // One Layer() call covering [0, width) x [top, top + height)
+    void Draw(DrawBackend& b, double distance, int width) const {
+        b.Layer(strip_, 0, top_, width, Offset(distance));
+    }
+
+    const Framebuffer& Strip() const { return strip_; }
+    int Top() const { return top_; }
+
+private:
+    Framebuffer strip_;
+    int         top_ = 0;
+    float       rate_ = 1.0f;
+};
+
+#endif
@@ -0,0 +1,171 @@
+// ------------------------------------------------------------------
+// File: trex_particles.cpp
+// Particle pools, effect emitters and the integration kernels
+// ------------------------------------------------------------------
+#include "trex_particles.h"
+#include <cmath>
+
+#if !defined(TREX_SIMD_SCALAR) && defined(__AVX__)
+  #define TREX_FX_AVX 1
+  #include <immintrin.h>
+#elif !defined(TREX_SIMD_SCALAR) && (defined(__SSE2__) || defined(_M_X64))
+  #define TREX_FX_SSE2 1
+  #include <emmintrin.h>
+#endif
+
+const char* ParticleKernelName(){
+#if defined(TREX_FX_AVX)
+    return "avx";
+#elif defined(TREX_FX_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+// ---------------- Storage ----------------------------
+ParticleSystem::ParticleSystem(size_t capacityPerKind) : cap_(capacityPerKind) {
+    for(auto &p: pools_){
+        p.x.resize(cap_); p.y.resize(cap_); p.vx.resize(cap_); p.vy.resize(cap_); p.life.resize(cap_);
+    }
+    rng_.seed(0x5041525449434cULL);
+}
+
+void ParticleSystem::Clear(){
+    for(auto &p: pools_) p.n = 0;
+}
+
+bool ParticleSystem::Emit(ParticleKind k, float x, float y, float vx, float vy, float life){
+    ParticlePool& p = pools_[k];
+    if(p.n == cap_){ dropped_++; return false; }
+    size_t i = p.n++;
+    p.x[i] = x; p.y[i] = y; p.vx[i] = vx; p.vy[i] = vy; p.life[i] = life;
+    return true;
+}
+
+size_t ParticleSystem::Live() const {
+    size_t n = 0;
+    for(const auto &p: pools_) n += p.n;
+    return n;
+}
+
+// ---------------- Effects ----------------------------
+void ParticleSystem::Dust(float x, float y, int count, float drift){
+    for(int i=0;i<count;i++)
+        Emit(PK_DUST, x + rng_.uniform(-18.0f, 18.0f), y - 3.0f,
+             drift + rng_.uniform(-60.0f, 60.0f), rng_.uniform(-110.0f, -30.0f), rng_.uniform(0.25f, 0.5f));
+}
+
+void ParticleSystem::Debris(const RectF& at, int count){
+    for(int i=0;i<count;i++)
+        Emit(PK_DEBRIS, at.x + rng_.uniform(0.0f, at.w), at.y + rng_.uniform(0.0f, at.h),
+             rng_.uniform(-240.0f, 200.0f), rng_.uniform(-620.0f, -180.0f), rng_.uniform(0.6f, 1.2f));
+}
+
+void ParticleSystem::Feathers(const RectF& at, int count){
+    for(int i=0;i<count;i++)
+        Emit(PK_FEATHER, at.x + rng_.uniform(0.0f, at.w), at.y + rng_.uniform(0.0f, at.h),
+             rng_.uniform(-160.0f, 160.0f), rng_.uniform(-260.0f, -40.0f), rng_.uniform(1.5f, 2.5f));
+}
+
+void ParticleSystem::Observe(const World& w){
+    const Dino& d = w.dino;
+    if(w.ticks < lastTicks_){                  // ResetWorld: a new run
+        Clear();
+        wasOnGround_ = d.onGround; wasState_ = w.state;
+    }
+    lastTicks_ = w.ticks;
+
+    float feetX = d.x + 22.0f, groundY = (float)(W_HEIGHT - GROUND_H);
+    if(wasOnGround_ && !d.onGround) Dust(feetX, groundY, 6, -0.3f * w.worldSpd);
+    if(!wasOnGround_ && d.onGround) Dust(feetX, groundY, 14, -0.5f * w.worldSpd);
+
+    if(wasState_ == GameState::PLAYING && w.state == GameState::GAMEOVER){
+        // the killer is the first obstacle still touching the dino
+        RectF box = d.bbox(), at = box;
+        for(const auto &o: w.obs){
+            RectF r{ o.x, o.y, o.w, o.h };
+            if(Intersect(box, r)){ at = r; break; }
+        }
+        Debris(at, 24);
+        if(w.killer == ObType::BirdLow || w.killer == ObType::BirdHigh) Feathers(at, 18);
+    }
+    wasOnGround_ = d.onGround;
+    wasState_ = w.state;
+}
+
+// ---------------- Update -----------------------------
+// vx, vy *= k; vy += g dt; x += vx dt; y += vy dt; life -= dt
+static void IntegrateScalar(ParticlePool& p, size_t from, float g, float k, float dt){
+    float* x = p.x.data(); float* y = p.y.data(); float* vx = p.vx.data(); float* vy = p.vy.data();
+    float* life = p.life.data();
+    for(size_t i=from;i<p.n;i++){
+        vx[i] *= k;
+        vy[i] = vy[i] * k + g * dt;
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        life[i] -= dt;
+    }
+}
+
+static void Integrate(ParticlePool& p, float g, float k, float dt){
+    size_t n = p.n, i = 0;
+    float* x = p.x.data(); float* y = p.y.data(); float* vx = p.vx.data(); float* vy = p.vy.data();
+    float* life = p.life.data();
+#if defined(TREX_FX_AVX)
+    __m256 vk = _mm256_set1_ps(k), vg = _mm256_set1_ps(g * dt), vdt = _mm256_set1_ps(dt);
+    for(; i + 8 <= n; i += 8){
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(vx + i), vk);
+        __m256 b = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(vy + i), vk), vg);
+        _mm256_storeu_ps(vx + i, a);
+        _mm256_storeu_ps(vy + i, b);
+        _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(a, vdt)));
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(b, vdt)));
+        _mm256_storeu_ps(life + i, _mm256_sub_ps(_mm256_loadu_ps(life + i), vdt));
+    }
+#elif defined(TREX_FX_SSE2)
+    __m128 vk = _mm_set1_ps(k), vg = _mm_set1_ps(g * dt), vdt = _mm_set1_ps(dt);
+    for(; i + 4 <= n; i += 4){
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(vx + i), vk);
+        __m128 b = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(vy + i), vk), vg);
+        _mm_storeu_ps(vx + i, a);
+        _mm_storeu_ps(vy + i, b);
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(a, vdt)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(b, vdt)));
+        _mm_storeu_ps(life + i, _mm_sub_ps(_mm_loadu_ps(life + i), vdt));
+    }
+#endif
+    IntegrateScalar(p, i, g, k, dt);
+}
+
+void ParticleSystem::Compact(ParticlePool& p, float floorY){
+    size_t n = p.n, out = 0;
+    float* x = p.x.data(); float* y = p.y.data(); float* vx = p.vx.data(); float* vy = p.vy.data();
+    float* life = p.life.data();
+    // skip the run of survivors that would be copied onto themselves
+    while(out < n && life[out] > 0.0f && y[out] < floorY) out++;
+    for(size_t i=out+1;i<n;i++){
+        if(!(life[i] > 0.0f && y[i] < floorY)) continue;
+        x[out] = x[i]; y[out] = y[i]; vx[out] = vx[i]; vy[out] = vy[i]; life[out] = life[i];
+        out++;
+    }
+    p.n = out;
+}
+
+void ParticleSystem::Update(float dt, float floorY){
+    for(int k=0;k<PK_COUNT;k++){
+        ParticlePool& p = pools_[k];
+        if(!p.n) continue;
+        Integrate(p, PARTICLE_LOOKS[k].gravity, std::pow(PARTICLE_LOOKS[k].drag, dt), dt);
+        Compact(p, floorY);
+    }
+}
+
+void ParticleSystem::UpdateScalar(float dt, float floorY){
+    for(int k=0;k<PK_COUNT;k++){
+        ParticlePool& p = pools_[k];
+        if(!p.n) continue;
+        IntegrateScalar(p, 0, PARTICLE_LOOKS[k].gravity, std::pow(PARTICLE_LOOKS[k].drag, dt), dt);
+        Compact(p, floorY);
+    }
+}
@@ -0,0 +1,88 @@
+// ------------------------------------------------------------------
+// File: trex_particles.h
+// Cosmetic particles: landing dust, impact debris, bird feathers
+// ------------------------------------------------------------------
+//  - one structure-of-arrays pool per kind (x/y/vx/vy/life lanes);
+//    gravity, drag and size are per kind, so the integration kernel
+//    has no per-particle branches and runs 8 (AVX) or 4 (SSE2) wide
+//  - Update() integrates every pool, then drops expired particles in a
+//    single in-place compaction pass per pool
+//  - pools are sized in the constructor; a full pool drops new
+//    particles instead of growing, so play never allocates
+//  - purely visual: Observe() watches a World and never writes to it,
+//    and the particles draw from their own RNG, so runs, replays and
+//    rollback stay bit-identical with or without effects
+//  - drawn by RenderScene (trex_render.h) with one FillSquares batch
+//    per kind
+// ------------------------------------------------------------------
+#ifndef TREX_PARTICLES_H
+#define TREX_PARTICLES_H
+
+#include "trex_sim.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum ParticleKind : uint8_t { PK_DUST, PK_DEBRIS, PK_FEATHER, PK_COUNT };
+
+struct ParticleLook {
+    float gravity;    // px/s^2
+    float drag;       // velocity kept per second (1 = none)
+    int   size;       // square side, px
+};
+
+static const ParticleLook PARTICLE_LOOKS[PK_COUNT] = {
+    { 300.0f,  0.15f, 3 },     // dust: puffs up, settles fast
+    { GRAVITY, 0.60f, 4 },     // debris: falls like the dino does
+    { 120.0f,  0.05f, 3 },     // feathers: drift down slowly
+};
+
+struct ParticlePool {
+    std::vector<float> x, y, vx, vy, life;   // life: seconds left
+    size_t n = 0;                            // live; lanes are sized to capacity
+};
+
+class ParticleSystem {
+public:
+    explicit ParticleSystem(size_t capacityPerKind = 4096);
+
+    void Clear();
+    // Adds one particle; false (and nothing added) if the pool is full.
+    bool Emit(ParticleKind k, float x, float y, float vx, float vy, float life);
+
+    // Effects, positioned in World coordinates
+    void Dust(float x, float y, int count, float drift);
+    void Debris(const RectF& at, int count);
+    void Feathers(const RectF& at, int count);
+
+    // Call once per fixed step after UpdateGame: emits dust when the dino
+    // leaves or touches the ground, and debris (plus feathers for birds)
+    // the step a run ends. A restarted World is picked up by its ticks.
+    void Observe(const World& w);
+
+    // Integrate dt, then compact. Particles die when their life runs out
+    // or they fall below floorY.
+    void Update(float dt, float floorY = (float)(W_HEIGHT - GROUND_H));
+    void UpdateScalar(float dt, float floorY = (float)(W_HEIGHT - GROUND_H));
+
+    const ParticlePool& Pool(ParticleKind k) const { return pools_[k]; }
+    size_t Live() const;
+    size_t Capacity() const { return cap_; }
+    uint64_t Dropped() const { return dropped_; }
+
+private:
+    void Compact(ParticlePool& p, float floorY);
+
+    ParticlePool pools_[PK_COUNT];
+    size_t   cap_;
+    Pcg32    rng_;
+    uint64_t dropped_ = 0;
+    bool     wasOnGround_ = true;
+    GameState wasState_ = GameState::MENU;
+    uint32_t lastTicks_ = 0;
+};
+
+// Name of the kernel set Update() compiled to ("avx", "sse2", "scalar")
+const char* ParticleKernelName();
+
+#endif
@@ -0,0 +1,163 @@
+// ------------------------------------------------------------------
+// File: trex_persist.cpp
+// Score file formats + ScoreWriter worker
+// ------------------------------------------------------------------
+#include "trex_persist.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+  #include <io.h>
+#else
+  #include <unistd.h>
+#endif
+
+// How long the worker lets events pile up before it looks again; a push
+// also wakes it straight away.
+static const std::chrono::milliseconds WRITE_WINDOW(250);
+
+// ---------------- Formats ----------------------------
+int LoadHighScore(const std::string& path){
+    std::ifstream f(path);
+    int hs=0; if(f) f>>hs; return hs;
+}
+
+std::vector<int> LoadTop5(const std::string& path){
+    std::vector<int> v; std::ifstream f(path);
+    int s; while(f>>s) v.push_back(s);
+    std::sort(v.begin(), v.end(), std::greater<int>());
+    if(v.size()>5) v.resize(5);
+    v.reserve(5);                   // InsertTop5 never has to grow it
+    return v;
+}
+
+// One insertion step instead of push + sort + trim: a full list never
+// reallocates, so recording a game over doesn't touch the heap.
+void InsertTop5(std::vector<int>& top5, int score){
+    if(top5.size() < 5) top5.push_back(score);
+    else if(score > top5.back()) top5.back() = score;
+    else return;
+    for(size_t i=top5.size()-1;i>0 && top5[i] > top5[i-1];i--) std::swap(top5[i], top5[i-1]);
+}
+
+// ---------------- Durable writes ---------------------
+static bool SyncFile(FILE* f){
+    if(std::fflush(f) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+// rename() won't replace an existing file on Windows
+static bool ReplaceWith(const std::string& from, const std::string& to){
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+bool WriteFileAtomic(const std::string& path, const std::string& data){
+    std::string tmp = path + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if(!f) return false;
+    bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = SyncFile(f) && ok;
+    ok = (std::fclose(f) == 0) && ok;
+    if(!ok){ std::remove(tmp.c_str()); return false; }
+    return ReplaceWith(tmp, path);
+}
+
+static bool AppendSynced(const std::string& path, const char* mode, const void* data, size_t n){
+    FILE* f = std::fopen(path.c_str(), mode);
+    if(!f) return false;
+    bool ok = std::fwrite(data, 1, n, f) == n;
+    ok = SyncFile(f) && ok;
+    return (std::fclose(f) == 0) && ok;
+}
+
+static void FormatTime(std::time_t t, char* buf, size_t n){
+    std::tm tm{};
+#ifdef _WIN32
+    localtime_s(&tm, &t);
+#else
+    localtime_r(&t, &tm);
+#endif
+    std::strftime(buf, n, "%Y-%m-%d %H:%M:%S", &tm);
+}
+
+// ---------------- ScoreWriter ------------------------
+void ScoreWriter::Start(int highScore, const std::vector<int>& top5){
+    if(worker_.joinable()) return;
+    highScore_ = highScore;
+    top5_ = top5;
+    stop_ = false;
+    worker_ = std::thread(&ScoreWriter::Run, this);
+}
+
+bool ScoreWriter::Push(int score, RunRecording* rec){
+    if(!queue_.TryPush(ScoreEvent{ score, std::time(nullptr), rec })){
+        delete rec;
+        dropped_++;
+        return false;
+    }
+    wake_.notify_one();
+    return true;
+}
+
+void ScoreWriter::Stop(){
+    if(!worker_.joinable()) return;
+    { std::lock_guard<std::mutex> lk(wakeMutex_); stop_ = true; }
+    wake_.notify_one();
+    worker_.join();
+}
+
+void ScoreWriter::Run(){
+    std::vector<ScoreEvent> batch;
+    for(;;){
+        {
+            // Push doesn't take the mutex, so a wakeup can be missed; the
+            // timeout bounds that to one window.
+            std::unique_lock<std::mutex> lk(wakeMutex_);
+            wake_.wait_for(lk, WRITE_WINDOW, [this]{ return stop_.load() || !queue_.Empty(); });
+        }
+        ScoreEvent e;
+        while(queue_.TryPop(e)) batch.push_back(e);
+        if(!batch.empty()) WriteBatch(batch);
+        if(stop_ && queue_.Empty()) break;
+    }
+}
+
+void ScoreWriter::WriteBatch(std::vector<ScoreEvent>& batch){
+    bool newHigh = false;
+    std::string log;
+    std::vector<uint8_t> recs;
+    for(const auto &e: batch){
+        if(e.score > highScore_){ highScore_ = e.score; newHigh = true; }
+        InsertTop5(top5_, e.score);
+        char when[64]; FormatTime(e.when, when, sizeof(when));
+        log += when; log += ", "; log += std::to_string(e.score); log += "\n";
+        if(e.rec){ EncodeRecording(*e.rec, recs); delete e.rec; }
+    }
+    batch.clear();
+
+    uint32_t bad = 0;
+    if(newHigh && !WriteFileAtomic(files_.highScore, std::to_string(highScore_))) bad++;
+    std::string top;
+    for(int s: top5_){ top += std::to_string(s); top += "\n"; }
+    if(!WriteFileAtomic(files_.top5, top)) bad++;
+    if(!AppendSynced(files_.runLog, "a", log.data(), log.size())) bad++;
+    if(!files_.recordings.empty() && !recs.empty() &&
+       !AppendSynced(files_.recordings, "ab", recs.data(), recs.size())) bad++;
+    failed_ += bad;
+    batches_++;
+}
@@ -0,0 +1,82 @@
+// ------------------------------------------------------------------
+// File: trex_persist.h
+// Score files and the background writer that keeps them up to date
+// ------------------------------------------------------------------
+//  - the game thread only pushes a ScoreEvent into a lock-free queue;
+//    it keeps its own high score / top 5 in memory for drawing
+//  - a worker thread drains the queue in batches, rewrites
+//    trex_highscore.dat / trex_top5.txt via temp file + rename (never a
+//    half-written file), and appends trex_runs.log / trex_runs.rec
+//  - Stop() (or the destructor) writes whatever is still queued
+// ------------------------------------------------------------------
+#ifndef TREX_PERSIST_H
+#define TREX_PERSIST_H
+
+#include "trex_replay.h"
+#include "trex_spsc.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ScoreFiles {
+    std::string highScore  = "trex_highscore.dat";
+    std::string top5       = "trex_top5.txt";
+    std::string runLog     = "trex_runs.log";
+    std::string recordings = "trex_runs.rec";   // empty = don't keep
+};
+
+int              LoadHighScore(const std::string& path);
+std::vector<int> LoadTop5(const std::string& path);
+// Insert a score into a best-first list capped at 5 entries.
+void             InsertTop5(std::vector<int>& top5, int score);
+
+// Write `data` to path.tmp, flush it to disk, then rename over path.
+bool WriteFileAtomic(const std::string& path, const std::string& data);
+
+struct ScoreEvent {
+    int           score;
+    std::time_t   when;     // game-over time, stamped on the game thread
+    RunRecording* rec;      // owned by the writer once pushed; may be null
+};
+
+class ScoreWriter {
+public:
+    explicit ScoreWriter(const ScoreFiles& files = ScoreFiles()) : files_(files) {}
+    ~ScoreWriter(){ Stop(); }
+
+    // Starting values (what the game loaded); the worker owns copies.
+    void Start(int highScore, const std::vector<int>& top5);
+    // Never blocks. False (and the event dropped) only if the queue is full.
+    bool Push(int score, RunRecording* rec = nullptr);
+    // Drain, write and join. Safe to call twice.
+    void Stop();
+
+    uint32_t Batches() const { return batches_.load(); }
+    uint32_t Dropped() const { return dropped_.load(); }
+    uint32_t Failed()  const { return failed_.load(); }   // file writes that failed
+
+private:
+    ScoreWriter(const ScoreWriter&);
+    ScoreWriter& operator=(const ScoreWriter&);
+
+    void Run();
+    void WriteBatch(std::vector<ScoreEvent>& batch);
+
+    ScoreFiles       files_;
+    int              highScore_ = 0;
+    std::vector<int> top5_;
+
+    SpscQueue<ScoreEvent, 64> queue_;
+    std::thread             worker_;
+    std::mutex              wakeMutex_;
+    std::condition_variable wake_;
+    std::atomic<bool>       stop_{false};
+    std::atomic<uint32_t>   batches_{0}, dropped_{0}, failed_{0};
+};
+
+#endif
@@ -0,0 +1,65 @@
+// ------------------------------------------------------------------
+// File: trex_pool.cpp
+// TaskPool
+// ------------------------------------------------------------------
+#include "trex_pool.h"
+
+TaskPool::TaskPool(unsigned threads){
+    unsigned n = threads ? threads : std::thread::hardware_concurrency();
+    if(n == 0) n = 1;
+    for(unsigned t=1;t<n;t++) workers_.emplace_back(&TaskPool::Worker, this);
+}
+
+TaskPool::~TaskPool(){
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for(auto &th: workers_) th.join();
+}
+
+// Claim indices until the batch runs out.
+void TaskPool::Drain(){
+    for(;;){
+        size_t i = next_.fetch_add(1, std::memory_order_relaxed);
+        if(i >= count_) break;
+        (*job_)(i);
+    }
+}
+
+void TaskPool::Worker(){
+    uint64_t seen = 0;
+    for(;;){
+        {
+            std::unique_lock<std::mutex> lk(mu_);
+            wake_.wait(lk, [&]{ return stop_ || batch_ != seen; });
+            if(stop_) return;
+            seen = batch_;
+        }
+        Drain();
+        std::lock_guard<std::mutex> lk(mu_);
+        if(--busy_ == 0) done_.notify_one();
+    }
+}
+
+void TaskPool::For(size_t n, const std::function<void(size_t)>& f){
+    if(n == 0) return;
+    if(workers_.empty() || n == 1){
+        for(size_t i=0;i<n;i++) f(i);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        job_ = &f; count_ = n;
+        next_.store(0, std::memory_order_relaxed);
+        busy_ = (unsigned)workers_.size();
+        batch_++;
+    }
+    wake_.notify_all();
+    Drain();
+    // workers may still be finishing an item (or not have woken yet)
+    std::unique_lock<std::mutex> lk(mu_);
+    done_.wait(lk, [&]{ return busy_ == 0; });
+    job_ = nullptr;
+}
@@ -0,0 +1,50 @@
+// ------------------------------------------------------------------
+// File: trex_pool.h
+// Persistent worker threads for short fork/join parallel loops
+// ------------------------------------------------------------------
+//  - TaskPool::For(n, f) calls f(i) for every i in [0, n) across the
+//    workers and the calling thread, and returns when all are done
+//  - meant for many small batches per second (a search level, a
+//    frame's jobs): threads are started once and sleep between batches
+//  - one batch at a time; For() is not reentrant
+// ------------------------------------------------------------------
+#ifndef TREX_POOL_H
+#define TREX_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskPool {
+public:
+    // 0 = one per hardware thread; the caller counts as one of them.
+    explicit TaskPool(unsigned threads = 0);
+    ~TaskPool();
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    void For(size_t n, const std::function<void(size_t)>& f);
+    unsigned Threads() const { return (unsigned)workers_.size() + 1; }
+
+private:
+    void Worker();
+    void Drain();
+
+    std::vector<std::thread> workers_;
+    std::mutex               mu_;
+    std::condition_variable  wake_, done_;
+    uint64_t                 batch_ = 0;      // bumped per For(), under mu_
+    unsigned                 busy_ = 0;       // workers still in the batch
+    bool                     stop_ = false;
+
+    const std::function<void(size_t)>* job_ = nullptr;
+    size_t                   count_ = 0;
+    std::atomic<size_t>      next_{0};
+};
+
+#endif
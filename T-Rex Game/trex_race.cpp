@@ -0,0 +1,131 @@
+// ------------------------------------------------------------------
+// File: trex_race.cpp
+// Two-process T-Rex race over UDP with rollback (one side per process)
+// ------------------------------------------------------------------
+// Each process plays one dino with a bot at 60 fps (FramePacer on the
+// steady clock) and exchanges inputs with the other over UDP; both
+// simulate both dinos (trex_rollback.cpp). The frame loop is RaceLink
+// (trex_racelink.h), the same one the game's --race mode runs, so this
+// is its headless test harness. Latency, jitter and loss can
+// be injected on the sending side. After --frames frames each side
+// waits until every input is confirmed and prints the final state; the
+// two printouts (scores and checksum) must be identical.
+//
+//   trex_race --player 0 --port 7000 --peer-port 7001 --latency 40 --jitter 15 &
+//   trex_race --player 1 --port 7001 --peer-port 7000 --latency 40 --jitter 15
+//
+// Usage: trex_race --player 0|1 --port P --peer-port Q [--host 127.0.0.1]
+//                  [--seed S] [--frames N] [--delay D] [--bot reflex|random]
+//                  [--latency MS] [--jitter MS] [--loss F] [--verbose]
+// Build (Linux): g++ -O2 -std=c++14 -o trex_race trex_race.cpp trex_racelink.cpp
+//                    trex_rollback.cpp trex_net.cpp trex_sim.cpp trex_spawn.cpp
+//                    trex_pacing.cpp
+// ------------------------------------------------------------------
+#include "trex_racelink.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+struct RaceOptions {
+    RaceConfig race;
+    uint32_t frames = 1800;           // 30 s
+    std::string bot = "reflex";
+    bool     verbose = false;
+};
+
+static void PrintUsage(){
+    std::printf("usage: trex_race --player 0|1 --port P --peer-port Q [--host 127.0.0.1]\n"
+                "                 [--seed S] [--frames N] [--delay D] [--bot reflex|random]\n"
+                "                 [--latency MS] [--jitter MS] [--loss F] [--verbose]\n");
+}
+
+static bool ParseArgs(int argc, char** argv, RaceOptions& o){
+    for(int i=1;i<argc;i++){
+        if(ParseRaceArg(argc, argv, i, o.race)) continue;
+        const char* a = argv[i];
+        bool hasVal = i + 1 < argc;
+        if(!std::strcmp(a,"--frames") && hasVal)         o.frames = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if(!std::strcmp(a,"--bot") && hasVal)       o.bot = argv[++i];
+        else if(!std::strcmp(a,"--verbose"))             o.verbose = true;
+        else return false;
+    }
+    return RaceConfigValid(o.race) && (o.bot == "reflex" || o.bot == "random");
+}
+
+// The random bot taps jump and holds duck in bursts, so the peer's
+// "no jump, same duck" guess is often wrong.
+static uint8_t BotInput(const RaceOptions& o, const World& w, Pcg32& rng, int& duckLeft){
+    if(o.bot == "reflex"){
+        TickInput in = ReflexPolicy(w);
+        return (uint8_t)((in.jump ? RB_JUMP : 0) | (in.duck ? RB_DUCK : 0));
+    }
+    uint8_t in = 0;
+    if(duckLeft > 0){ duckLeft--; in |= RB_DUCK; }
+    else if(rng.range(0, 99) < 2) duckLeft = rng.range(5, 30);
+    if(rng.range(0, 99) < 3) in |= RB_JUMP;
+    return in;
+}
+
+int main(int argc, char** argv){
+    RaceOptions o;
+    if(!ParseArgs(argc, argv, o)){ PrintUsage(); return 2; }
+
+    SteadyClock clock;
+    RaceLink link(clock);
+    if(!link.Open(o.race)){
+        std::fprintf(stderr, "cannot open UDP port %u\n", (unsigned)o.race.port);
+        return 1;
+    }
+    const RollbackSession& s = link.Session();
+    FramePacer pacer(clock, DT);
+    Pcg32 botRng; botRng.seed(o.race.seed, 100 + (uint64_t)o.race.player);
+    int duckLeft = 0;
+
+    uint64_t doneAt = 0;
+    const uint64_t ms = clock.Frequency() / 1000;
+    pacer.Reset();
+    for(;;){
+        int moved = link.Pump(pacer.Advance(), o.frames,
+                              [&](const World& w){ return BotInput(o, w, botRng, duckLeft); });
+
+        uint64_t now = clock.Now();
+        if(s.ConfirmedFrame() >= o.frames){
+            if(!doneAt) doneAt = now;
+            if(now - doneAt > 1000 * ms) break;               // let the peer confirm too
+        }
+        else if(link.SinceProgress() > 5000 * ms){
+            std::fprintf(stderr, "no progress for 5 s (frame %u, confirmed %u); is the peer running?\n",
+                         s.Frame(), s.ConfirmedFrame());
+            return 1;
+        }
+        if(o.verbose && moved && s.Frame() % 300 == 0)
+            std::printf("frame %u confirmed %u rollbacks %llu\n", s.Frame(), s.ConfirmedFrame(),
+                        (unsigned long long)s.Stats().rollbacks);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    const RaceConfig& c = link.Config();
+    const RollbackStats& st = s.Stats();
+    const RaceSnapshot& fin = s.ConfirmedSnapshot();
+    HistSummary rs = st.resimUs.Summary();
+    std::printf("race      player %d, seed %llu, bot %s, delay %d, latency %d+-%d ms, loss %.0f%%\n",
+                c.player, (unsigned long long)c.seed, o.bot.c_str(), c.delay,
+                c.net.latencyMs, c.net.jitterMs, c.net.loss * 100.0);
+    std::printf("frames    %llu, stalled polls %llu, packets sent %llu dropped %llu received %llu\n",
+                (unsigned long long)st.frames, (unsigned long long)st.stalls, (unsigned long long)link.Link().Sent(),
+                (unsigned long long)link.Link().Dropped(), (unsigned long long)link.Link().Received());
+    std::printf("rollback  %llu rollbacks, %llu frames re-simulated (max %u), %llu mispredicted inputs\n",
+                (unsigned long long)st.rollbacks, (unsigned long long)st.resimFrames, st.maxResim,
+                (unsigned long long)st.mispredicted);
+    std::printf("resim     p50 %llu us  p99 %llu us  max %llu us\n",
+                (unsigned long long)rs.p50, (unsigned long long)rs.p99, (unsigned long long)rs.max);
+    std::printf("checks    %llu compared, %llu desyncs\n", (unsigned long long)st.checks, (unsigned long long)st.desyncs);
+    std::printf("final     frame %u  p0 %d %s  p1 %d %s  checksum %08x\n", fin.frame,
+                fin.p[0].score, fin.p[0].state == GameState::PLAYING ? "alive" : ObTypeName(fin.p[0].killer),
+                fin.p[1].score, fin.p[1].state == GameState::PLAYING ? "alive" : ObTypeName(fin.p[1].killer),
+                WorldChecksum(fin.p[0]) * 31u + WorldChecksum(fin.p[1]));
+    return st.desyncs ? 1 : 0;
+}
@@ -0,0 +1,60 @@
+// ------------------------------------------------------------------
+// File: trex_racelink.cpp
+// RaceLink: option parsing, packets in and out
+// ------------------------------------------------------------------
+#include "trex_racelink.h"
+#include <cstdlib>
+#include <cstring>
+
+bool ParseRaceArg(int argc, char** argv, int& i, RaceConfig& c){
+    const char* a = argv[i];
+    if(i + 1 >= argc) return false;
+    if(!std::strcmp(a,"--player"))         c.player = std::atoi(argv[++i]);
+    else if(!std::strcmp(a,"--port"))      c.port = (uint16_t)std::atoi(argv[++i]);
+    else if(!std::strcmp(a,"--peer-port")) c.peerPort = (uint16_t)std::atoi(argv[++i]);
+    else if(!std::strcmp(a,"--host"))      c.host = argv[++i];
+    else if(!std::strcmp(a,"--seed"))      c.seed = std::strtoull(argv[++i], nullptr, 10);
+    else if(!std::strcmp(a,"--delay"))     c.delay = std::atoi(argv[++i]);
+    else if(!std::strcmp(a,"--latency"))   c.net.latencyMs = std::atoi(argv[++i]);
+    else if(!std::strcmp(a,"--jitter"))    c.net.jitterMs = std::atoi(argv[++i]);
+    else if(!std::strcmp(a,"--loss"))      c.net.loss = std::strtof(argv[++i], nullptr);
+    else return false;
+    return true;
+}
+
+bool RaceConfigValid(const RaceConfig& c){
+    return (c.player == 0 || c.player == 1) && c.port && c.peerPort &&
+           c.delay >= 0 && c.delay <= RB_MAX_PREDICT / 2;
+}
+
+bool RaceLink::Open(const RaceConfig& c){
+    if(!RaceConfigValid(c)) return false;
+    cfg_ = c;
+    cfg_.net.seed = c.seed * 2 + (uint64_t)c.player;
+    if(!link_.Open(c.port, c.host.c_str(), c.peerPort)) return false;
+    link_.SetImpairment(cfg_.net);
+    session_->Start(c.seed, c.player, c.delay);
+    lastSend_ = 0;
+    lastProgress_ = clock_.Now();
+    return true;
+}
+
+void RaceLink::Receive(){
+    uint8_t buf[UdpLink::MAX_DATAGRAM];
+    int n;
+    while((n = link_.Receive(buf, sizeof(buf))) >= 0){
+        if(n == (int)sizeof(RacePacket)){ std::memcpy(&pkt_, buf, sizeof(pkt_)); session_->OnPacket(pkt_); }
+    }
+}
+
+// A frame's inputs go out at once; otherwise resend every 10 ms, which
+// also carries acks and checksums after the race is over
+void RaceLink::Send(bool moved){
+    uint64_t now = clock_.Now();
+    if(moved || now - lastSend_ > clock_.Frequency() / 100){
+        session_->MakePacket(pkt_);
+        link_.Send(&pkt_, sizeof(pkt_));
+        lastSend_ = now;
+    }
+    if(moved) lastProgress_ = now;
+}
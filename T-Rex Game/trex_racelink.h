@@ -0,0 +1,82 @@
+// ------------------------------------------------------------------
+// File: trex_racelink.h
+// One side of a networked race: RollbackSession driven over a UdpLink
+// ------------------------------------------------------------------
+//  - RaceLink owns the session and the socket and runs the per-frame
+//    loop both front ends share: take the peer's packets, advance the
+//    frames the pacer handed out (never past RB_MAX_PREDICT ahead of
+//    the peer), send our inputs
+//  - the local input of each frame comes from a callback given the
+//    local player's World: a bot in trex_race, the keyboard in the game
+//  - ParseRaceArg reads the options both accept (--player/--port/...)
+// ------------------------------------------------------------------
+#ifndef TREX_RACELINK_H
+#define TREX_RACELINK_H
+
+#include "trex_rollback.h"
+#include "trex_net.h"
+#include "trex_pacing.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct RaceConfig {
+    int      player = -1;             // 0 or 1
+    uint16_t port = 0, peerPort = 0;
+    std::string host = "127.0.0.1";
+    uint64_t seed = 1;                // both sides must agree
+    int      delay = 0;               // input delay, frames
+    NetImpairment net;                // sending side only
+};
+
+// If argv[i] is a race option, stores it, steps i past its value and
+// returns true.
+bool ParseRaceArg(int argc, char** argv, int& i, RaceConfig& c);
+bool RaceConfigValid(const RaceConfig& c);
+
+class RaceLink {
+public:
+    explicit RaceLink(Clock& clock) : clock_(clock), session_(new RollbackSession()) {}
+
+    // Binds the port and starts the session at frame 0. False if the
+    // port could not be opened or the config is invalid.
+    bool Open(const RaceConfig& c);
+
+    // One UI frame: reads waiting packets, runs up to `steps` frames
+    // (none past lastFrame), each with input(localWorld) as the local
+    // input, then sends. Returns the frames advanced.
+    template<class F>
+    int Pump(int steps, uint32_t lastFrame, F input){
+        Receive();
+        int moved = 0;
+        for(int i=0;i<steps && session_->Frame() < lastFrame;i++){
+            if(!session_->CanAdvance()){ session_->Advance(); break; }   // counts the stall
+            session_->AddLocalInput(input(session_->State().p[session_->LocalPlayer()]));
+            session_->Advance();
+            moved++;
+        }
+        Send(moved > 0);
+        return moved;
+    }
+
+    const RollbackSession& Session() const { return *session_; }
+    const UdpLink& Link() const { return link_; }
+    const RaceConfig& Config() const { return cfg_; }
+    // Nothing from the peer yet: it is not running, or not reachable
+    bool Waiting() const { return link_.Received() == 0; }
+    // Clock ticks since a frame was last advanced
+    uint64_t SinceProgress() const { return clock_.Now() - lastProgress_; }
+
+private:
+    void Receive();
+    void Send(bool moved);
+
+    Clock&      clock_;
+    RaceConfig  cfg_;
+    UdpLink     link_;
+    std::unique_ptr<RollbackSession> session_;   // ~100 KB of history
+    RacePacket  pkt_;
+    uint64_t    lastSend_ = 0, lastProgress_ = 0;
+};
+
+#endif
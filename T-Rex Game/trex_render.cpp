@@ -0,0 +1,243 @@
+// ------------------------------------------------------------------
+// File: trex_render.cpp
+// T-Rex scene drawing (backend-agnostic)
+// ------------------------------------------------------------------
+#include "trex_render.h"
+#include <cwchar>
+
+// ----------------- Rendering helpers -----------------
+static void FillRectF(DrawBackend& b, const RectF&r, Color c){
+    b.FillRect((int)r.x, (int)r.y, (int)(r.x+r.w), (int)(r.y+r.h), c);
+}
+
+static void DrawDino(DrawBackend& b, const Dino& d){
+    RectF r = d.bbox();
+    // Body
+    FillRectF(b, RectF{ r.x, r.y, r.w, r.h }, COL_DINO);
+    // Head/neck simple shape when standing
+    if(!d.duck){
+        FillRectF(b, RectF{ r.x + r.w - 10, r.y - 16, 14, 16 }, COL_DINO);
+        // eye
+        b.FillRect((int)(r.x + r.w - 4), (int)(r.y - 10), (int)(r.x + r.w - 1), (int)(r.y - 7), COL_WHITE);
+    }
+    if(d.blink>0){ // hit flash overlay
+        b.FrameRect((int)r.x-2, (int)r.y-2, (int)(r.x+r.w+2), (int)(r.y+r.h+2), COL_HIT);
+    }
+}
+
+// Retired obstacles linger at the ring's head until the ones ahead of
+// them go; they are not drawn.
+static bool ObstacleDrawn(const Obstacle& o){ return o.x + o.w >= -8; }
+
+static void DrawRival(DrawBackend& b, const Dino& d){
+    RectF r = d.bbox();
+    b.FrameRect((int)r.x, (int)r.y, (int)(r.x + r.w), (int)(r.y + r.h), COL_UI);
+    if(!d.duck) b.FrameRect((int)(r.x + r.w - 10), (int)(r.y - 16), (int)(r.x + r.w + 4), (int)r.y, COL_UI);
+}
+
+static void DrawCactus(DrawBackend& b, const Obstacle&o){ FillRectF(b, RectF{o.x,o.y,o.w,o.h}, COL_OBS); }
+
+static void DrawBird(DrawBackend& b, const Obstacle&o){
+    // body
+    FillRectF(b, RectF{o.x, o.y + 6, o.w, o.h - 12}, COL_BIRD);
+    // wings animate up/down
+    int wing = (o.anim / 8) % 2; // toggle every few frames
+    if(wing==0){ // wings up
+        b.FillRect((int)o.x, (int)o.y, (int)(o.x+o.w/2), (int)(o.y+6), COL_BIRD);
+        b.FillRect((int)(o.x+o.w/2), (int)o.y, (int)(o.x+o.w), (int)(o.y+6), COL_BIRD);
+    } else { // wings down
+        b.FillRect((int)o.x, (int)(o.y+o.h-6), (int)(o.x+o.w/2), (int)(o.y+o.h), COL_BIRD);
+        b.FillRect((int)(o.x+o.w/2), (int)(o.y+o.h-6), (int)(o.x+o.w), (int)(o.y+o.h), COL_BIRD);
+    }
+}
+
+static void DrawBoulder(DrawBackend& b, const Obstacle&o){
+    // Approximate circle with rectangle + frame to stand out
+    FillRectF(b, RectF{o.x, o.y, o.w, o.h}, COL_OBS);
+    b.FrameRect((int)o.x, (int)o.y, (int)(o.x+o.w), (int)(o.y+o.h), COL_CLOUD);
+}
+
+static void DrawCloud(DrawBackend& b, const Cloud&c){
+    b.FillRect((int)c.x, (int)c.y, (int)(c.x+38), (int)(c.y+18), COL_CLOUD);
+    b.FillRect((int)(c.x+16), (int)(c.y-8), (int)(c.x+56), (int)(c.y+12), COL_CLOUD);
+    b.FillRect((int)(c.x+30), (int)(c.y+4), (int)(c.x+76), (int)(c.y+22), COL_CLOUD);
+}
+
+// ---------------- Background layers ------------------
+// Every cloud is the same shape, so it is rasterised once into a
+// sprite and each live cloud is one Sprite() call. The ground's pebbles
+// sit in a thin band just under the horizon; that band is the only
+// part of the ground that changes as it scrolls, so it is the only
+// part the damage tracker repaints.
+static const int   CLOUD_W      = 76;          // DrawCloud spans x..x+76, y-8..y+22
+static const int   CLOUD_H      = 30;
+static const int   CLOUD_TOP    = 8;
+static const int   LAYER_PERIOD = 2 * W_WIDTH;
+static const int   PEBBLE_TOP   = 4;           // band rows, from the top of the ground
+static const int   PEBBLE_H     = 10;
+static const int   GROUND_PEBBLES = 90;
+static const Color COL_PEBBLE   = MakeColor(96, 96, 96);
+
+SceneLayers::SceneLayers(){
+    cloud.ResizeClear(CLOUD_W, CLOUD_H);
+    SoftBackend sb(cloud);
+    DrawCloud(sb, Cloud{ 0.0f, (float)CLOUD_TOP, 0.0f });
+
+    Pcg32 rng; rng.seed(0x5C1E5);
+    struct Pebble { int x, y, w, h; } pebbles[GROUND_PEBBLES];
+    for(auto &p: pebbles) p = Pebble{ rng.range(0, LAYER_PERIOD - 1), rng.range(0, PEBBLE_H - 2), rng.range(2, 6), rng.range(1, 2) };
+    ground.Begin(LAYER_PERIOD, PEBBLE_H, W_HEIGHT - GROUND_H + PEBBLE_TOP, 1.0f, COL_GROUND);
+    ground.Paint([&](DrawBackend& b, int dx){
+        for(const auto &p: pebbles) b.FillRect(p.x + dx, p.y, p.x + dx + p.w, p.y + p.h, COL_PEBBLE);
+    });
+}
+
+const SceneLayers& SceneBackground(){
+    static const SceneLayers layers;
+    return layers;
+}
+
+static void DrawParticles(DrawBackend& b, const ParticleSystem& fx){
+    for(int k=0;k<PK_COUNT;k++){
+        const ParticlePool& p = fx.Pool((ParticleKind)k);
+        if(p.n) b.FillSquares(p.x.data(), p.y.data(), p.n, PARTICLE_LOOKS[k].size, COL_PARTICLE[k]);
+    }
+}
+
+// Every (size, bold) pair RenderScene draws with; front ends build their
+// glyph atlases / fonts for these up front.
+const FontSpec SCENE_FONTS[] = {
+    { 18, true }, { 18, false }, { 28, true }, { 22, true },
+    { 30, true }, { 20, false }, { 20, true },
+};
+const int SCENE_FONT_COUNT = (int)(sizeof(SCENE_FONTS) / sizeof(SCENE_FONTS[0]));
+
+// Fixed stack buffer for the HUD lines: no heap, no locale.
+struct TextLine {
+    wchar_t s[64];
+    int n = 0;
+
+    TextLine& Add(const wchar_t* t){
+        while(*t && n < 63) s[n++] = *t++;
+        return *this;
+    }
+    TextLine& Add(int v){
+        wchar_t tmp[12]; int k = 0;
+        unsigned u = v < 0 ? 0u - (unsigned)v : (unsigned)v;
+        do { tmp[k++] = (wchar_t)(L'0' + u % 10); u /= 10; } while(u);
+        if(v < 0 && n < 63) s[n++] = L'-';
+        while(k && n < 63) s[n++] = tmp[--k];
+        return *this;
+    }
+};
+
+static void DrawTextSimple(DrawBackend& b, int x, int y, const wchar_t* s, Color col=COL_TEXT, int size=18, bool bold=false){
+    b.Text(x, y, s, (int)std::wcslen(s), col, size, bold);
+}
+static void DrawTextSimple(DrawBackend& b, int x, int y, const TextLine& t, Color col=COL_TEXT, int size=18, bool bold=false){
+    b.Text(x, y, t.s, t.n, col, size, bold);
+}
+
+static void DrawTop5(DrawBackend& b, const std::vector<int>& top5){
+    DrawTextSimple(b, 26, 118, L"Top 5:", COL_TEXT, 18, true);
+    for(size_t i=0;i<top5.size();++i){
+        TextLine t; t.Add((int)i+1).Add(L". ").Add(top5[i]);
+        DrawTextSimple(b, 26, 140+(int)i*20, t, COL_TEXT, 18, false);
+    }
+}
+
+size_t DrawnEntities(const World& w){
+    size_t n = 1 + w.clouds.size();         // the dino, one sprite per cloud
+    for(const auto &o: w.obs) n += ObstacleDrawn(o);
+    return n;
+}
+
+// Replaces the menu / game-over text in race mode
+static void DrawRaceStatus(DrawBackend& b, const World& w, const RaceView& race){
+    const World& rival = *race.rival;
+    if(race.waiting){
+        DrawTextSimple(b, 26, 18, L"Waiting for the other player...", COL_TEXT, 22, true);
+        return;
+    }
+    bool over = w.state != GameState::PLAYING, rivalOver = rival.state != GameState::PLAYING;
+    if(!over){
+        if(rivalOver) DrawTextSimple(b, 26, 18, L"Rival crashed — keep going", COL_UI, 20, true);
+        return;
+    }
+    if(!rivalOver){
+        DrawTextSimple(b, 26, 18, L"Crashed", COL_GAMEOVER, 30, true);
+        DrawTextSimple(b, 26, 54, L"Your rival is still running...", COL_TEXT, 20, false);
+        return;
+    }
+    const wchar_t* result = w.score > rival.score ? L"You win!" : w.score < rival.score ? L"You lose" : L"Draw";
+    DrawTextSimple(b, 26, 18, result, w.score >= rival.score ? COL_UI : COL_GAMEOVER, 30, true);
+    TextLine run; run.Add(L"You: ").Add(w.score).Add(L"    Rival: ").Add(rival.score);
+    DrawTextSimple(b, 26, 54, run, COL_TEXT, 20, true);
+    DrawTextSimple(b, 26, 82, L"ESC to quit", COL_TEXT, 20, false);
+}
+
+// ---------------------- Paint ------------------------
+void RenderScene(DrawBackend& b, const World& w, int highScore, const std::vector<int>& top5,
+                 const ParticleSystem* fx, const RaceView* race){
+    b.BeginFrame();
+    const SceneLayers& bg = SceneBackground();
+    b.FillRect(0, 0, W_WIDTH, W_HEIGHT - GROUND_H, COL_BG);
+
+    // Clouds
+    for(const auto &c: w.clouds) b.Sprite(bg.cloud, (int)c.x, (int)c.y - CLOUD_TOP);
+
+    // Ground: flat fill around the pebble band, which scrolls by
+    // World::distance
+    int band = bg.ground.Top();
+    b.FillRect(0, W_HEIGHT - GROUND_H, W_WIDTH, band, COL_GROUND);
+    bg.ground.Draw(b, w.distance, W_WIDTH);
+    b.FillRect(0, band + bg.ground.Strip().h, W_WIDTH, W_HEIGHT, COL_GROUND);
+
+    // Obstacles
+    for(const auto &o: w.obs){
+        if(!ObstacleDrawn(o)) continue;
+        switch(o.type){
+            case ObType::CactusSmall:
+            case ObType::CactusLarge:
+            case ObType::CactusDouble: DrawCactus(b,o); break;
+            case ObType::BirdLow:
+            case ObType::BirdHigh:     DrawBird(b,o);   break;
+            case ObType::Boulder:      DrawBoulder(b,o);break;
+        }
+    }
+
+    // Dino, and the rival's over it
+    DrawDino(b, w.dino);
+    if(race) DrawRival(b, race->rival->dino);
+
+    // Particles
+    if(fx) DrawParticles(b, *fx);
+
+    // UI text
+    TextLine hud; hud.Add(L"Score: ").Add(w.score);
+    if(race) hud.Add(L"   Rival: ").Add(race->rival->score);
+    else     hud.Add(L"    High: ").Add(highScore);
+    DrawTextSimple(b, W_WIDTH-300, 14, hud, COL_UI, 18, true);
+
+    if(race){
+        DrawRaceStatus(b, w, *race);
+    }
+    else if(w.state==GameState::MENU){
+        DrawTextSimple(b, 26, 18, L"T‑Rex — Win32 Edition", COL_TEXT, 28, true);
+        DrawTextSimple(b, 26, 52, L"SPACE/UP or Left‑Click: Jump    DOWN: Duck    R: Restart", COL_TEXT, 18, false);
+        DrawTextSimple(b, 26, 78, L"Press SPACE to start", COL_BLACK, 22, true);
+
+        DrawTop5(b, top5);
+    }
+    else if(w.state==GameState::GAMEOVER){
+        DrawTextSimple(b, 26, 18, L"Game Over", COL_GAMEOVER, 30, true);
+        DrawTextSimple(b, 26, 54, L"Press R to retry", COL_TEXT, 20, false);
+        TextLine run; run.Add(L"Run: ").Add(w.score).Add(L"    High: ").Add(highScore);
+        DrawTextSimple(b, 26, 82, run, COL_TEXT, 20, true);
+
+        DrawTop5(b, top5);
+        // subtle hint if new high
+        if(w.score==highScore){ DrawTextSimple(b, 26, 140+(int)top5.size()*20 + 8, L"NEW HIGH SCORE!", COL_UI, 20, true);}
+    }
+    b.EndFrame();
+}
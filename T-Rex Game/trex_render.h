@@ -0,0 +1,63 @@
+// ------------------------------------------------------------------
+// File: trex_render.h
+// Scene drawing for T-Rex, written against DrawBackend (trex_draw.h)
+// ------------------------------------------------------------------
+#ifndef TREX_RENDER_H
+#define TREX_RENDER_H
+
+#include "trex_sim.h"
+#include "trex_draw.h"
+#include "trex_glyphs.h"
+#include "trex_particles.h"
+#include "trex_parallax.h"
+#include <vector>
+
+// Colors (COLORREF layout)
+static const Color COL_BG      = MakeColor(245, 245, 245);
+static const Color COL_GROUND  = MakeColor(60, 60, 60);
+static const Color COL_DINO    = MakeColor(48, 48, 48);
+static const Color COL_OBS     = MakeColor(30, 30, 30);
+static const Color COL_BIRD    = MakeColor(10, 10, 10);
+static const Color COL_TEXT    = MakeColor(10, 10, 10);
+static const Color COL_UI      = MakeColor(0, 120, 215);
+static const Color COL_CLOUD   = MakeColor(200, 200, 200);
+static const Color COL_WHITE   = MakeColor(255, 255, 255);
+static const Color COL_HIT     = MakeColor(255, 0, 0);
+static const Color COL_BLACK   = MakeColor(0, 0, 0);
+static const Color COL_GAMEOVER= MakeColor(200, 0, 0);
+static const Color COL_PARTICLE[PK_COUNT] = {
+    MakeColor(170, 160, 145),   // dust
+    MakeColor(30, 30, 30),      // debris, like the obstacles
+    MakeColor(110, 110, 110),   // feathers
+};
+
+// Fonts RenderScene uses, for building glyph atlases at startup
+extern const FontSpec SCENE_FONTS[];
+extern const int SCENE_FONT_COUNT;
+
+// Pre-rendered on first use: the cloud sprite (drawn once per
+// World::clouds entry) and the ground's pebble band, a wrap-around
+// strip scrolled by World::distance
+struct SceneLayers {
+    Framebuffer   cloud;
+    ParallaxLayer ground;
+    SceneLayers();
+};
+const SceneLayers& SceneBackground();
+
+// Dino, clouds and obstacles RenderScene issues draw calls for
+size_t DrawnEntities(const World& w);
+
+// Race mode (trex_racelink.h): the rival's dino drawn as an outline,
+// its score in the HUD, and the race result instead of the retry prompt
+struct RaceView {
+    const World* rival = nullptr;
+    bool waiting = false;             // nothing heard from the peer yet
+};
+
+// Whole frame: background, clouds, ground, obstacles, dino,
+// particles (one FillSquares batch per kind, if fx is given), HUD/menus.
+void RenderScene(DrawBackend& b, const World& w, int highScore, const std::vector<int>& top5,
+                 const ParticleSystem* fx = nullptr, const RaceView* race = nullptr);
+
+#endif
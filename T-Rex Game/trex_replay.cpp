@@ -0,0 +1,206 @@
+// ------------------------------------------------------------------
+// File: trex_replay.cpp
+// Input recording, replay and the .rec file format
+// ------------------------------------------------------------------
+#include "trex_replay.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+// ---------------- Recording --------------------------
+void InputRecorder::Begin(const World& w, uint64_t seed, uint64_t stream){
+    std::vector<uint8_t> buf;
+    buf.swap(rec_.data);
+    buf.clear();
+    if(buf.capacity() < REC_RESERVE) buf.reserve(REC_RESERVE);
+    rec_ = RunRecording();
+    rec_.data.swap(buf);
+    rec_.seed = seed; rec_.stream = stream;
+    rec_.tune = w.tune;
+    rec_.spawnId = w.spawn->id;
+    rec_.fairStream = w.feed != nullptr;
+    rec_.start = w.state;
+    lastTick_ = 0;
+}
+
+void InputRecorder::Log(uint32_t tick, InputKind k){
+    uint64_t v = ((uint64_t)(tick - lastTick_) << 2) | (uint64_t)k;
+    do {
+        uint8_t b = (uint8_t)(v & 0x7F); v >>= 7;
+        rec_.data.push_back(v ? (uint8_t)(b | 0x80) : b);
+    } while(v);
+    lastTick_ = tick;
+    rec_.events++;
+}
+
+void InputRecorder::Jump(World& w){
+    // DoJump only does something in MENU or on the ground
+    bool acts = w.state==GameState::MENU || (w.state==GameState::PLAYING && w.dino.onGround);
+    if(acts) Log(w.ticks, InputKind::Jump);
+    DoJump(w);
+}
+
+void InputRecorder::Duck(World& w, bool down){
+    bool acts = w.state==GameState::PLAYING && (down && w.dino.onGround) != w.dino.duck;
+    if(acts) Log(w.ticks, down ? InputKind::DuckDown : InputKind::DuckUp);
+    SetDuck(w, down);
+}
+
+void InputRecorder::Apply(World& w, const TickInput& in){
+    if(in.jump) Jump(w);
+    Duck(w, in.duck);
+}
+
+const RunRecording& InputRecorder::Finish(const World& w){
+    rec_.score = w.score;
+    rec_.ticks = w.ticks;
+    rec_.killer = w.killer;
+    return rec_;
+}
+
+// ---------------- Replay -----------------------------
+ReplayResult ReplayRun(World& w, const RunRecording& r, uint32_t maxTicks){
+    w.tune = r.tune;
+    ResetWorld(w, r.seed, r.stream);
+    w.state = r.start;
+
+    const uint8_t* p = r.data.data();
+    const uint8_t* end = p + r.data.size();
+    uint32_t nextTick = 0, left = r.events;
+    InputKind nextKind = InputKind::Jump;
+    auto decode = [&](){
+        uint64_t v = 0; int sh = 0;
+        while(p < end){
+            uint8_t b = *p++;
+            v |= (uint64_t)(b & 0x7F) << sh; sh += 7;
+            if(!(b & 0x80)) break;
+        }
+        nextTick += (uint32_t)(v >> 2);
+        nextKind = (InputKind)(v & 3);
+    };
+    if(left) decode();
+
+    bool died = false;
+    while(!died && w.ticks < maxTicks){
+        while(left && nextTick == w.ticks){
+            switch(nextKind){
+                case InputKind::Jump:     DoJump(w); break;
+                case InputKind::DuckDown: SetDuck(w, true); break;
+                case InputKind::DuckUp:   SetDuck(w, false); break;
+            }
+            if(--left) decode();
+        }
+        if(w.state != GameState::PLAYING) break;   // never started
+        died = UpdateGame(w, DT);
+    }
+    bool match = died && w.score==r.score && w.ticks==r.ticks && w.killer==r.killer;
+    return ReplayResult{ w.score, w.ticks, w.killer, died, match };
+}
+
+// ---------------- File format ------------------------
+// Per record, little endian:
+//   "TRXR" u8 version u8 start u8 killer u8 flags (1 = fair stream)
+//   u64 seed, u64 stream, 8 x f32 Tuning, u32 spawn table id
+//   i32 score, u32 ticks, u32 events, u32 bytes, event bytes
+// Version 1 (hard-coded spawn odds) had no table id; its runs cannot be
+// replayed any more but the records are still framed the same way.
+static const char     REC_MAGIC[4] = { 'T', 'R', 'X', 'R' };
+static const uint8_t  REC_VERSION  = 2;
+static const uint8_t  REC_FAIR_STREAM = 1;   // flags bit
+static const size_t   REC_HEADER   = 8 + 16 + 32 + 4 + 16;
+static const size_t   REC_HEADER_V1 = REC_HEADER - 4;
+
+static void Put(std::vector<uint8_t>& b, uint64_t v, int bytes){
+    for(int i=0;i<bytes;i++) b.push_back((uint8_t)(v >> (8 * i)));
+}
+static uint64_t Get(const uint8_t*& p, int bytes){
+    uint64_t v = 0;
+    for(int i=0;i<bytes;i++) v |= (uint64_t)p[i] << (8 * i);
+    p += bytes;
+    return v;
+}
+static uint32_t FloatBits(float f){ uint32_t u; std::memcpy(&u, &f, 4); return u; }
+static float    BitsFloat(uint32_t u){ float f; std::memcpy(&f, &u, 4); return f; }
+
+// Tuning fields in file order
+static float* TuneField(Tuning& t, int i){
+    float* f[8] = { &t.baseSpd, &t.speedPerScore, &t.speedCap, &t.gapMin,
+                    &t.gapMax, &t.gapShrink, &t.gapMinFloor, &t.gapMaxFloor };
+    return f[i];
+}
+
+void EncodeRecording(const RunRecording& r, std::vector<uint8_t>& b){
+    b.reserve(b.size() + REC_HEADER + r.data.size());
+    b.insert(b.end(), REC_MAGIC, REC_MAGIC + 4);
+    b.push_back(REC_VERSION); b.push_back((uint8_t)r.start); b.push_back((uint8_t)r.killer);
+    b.push_back(r.fairStream ? REC_FAIR_STREAM : 0);
+    Put(b, r.seed, 8); Put(b, r.stream, 8);
+    Tuning t = r.tune;
+    for(int i=0;i<8;i++) Put(b, FloatBits(*TuneField(t, i)), 4);
+    Put(b, r.spawnId, 4);
+    Put(b, (uint32_t)r.score, 4); Put(b, r.ticks, 4); Put(b, r.events, 4); Put(b, (uint32_t)r.data.size(), 4);
+    b.insert(b.end(), r.data.begin(), r.data.end());
+}
+
+bool AppendRecording(const char* path, const RunRecording& r){
+    std::vector<uint8_t> b;
+    EncodeRecording(r, b);
+    FILE* f = std::fopen(path, "ab");
+    if(!f) return false;
+    bool ok = std::fwrite(b.data(), 1, b.size(), f) == b.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+bool LoadRecordings(const char* path, std::vector<RunRecording>& out, size_t* older, size_t* tornBytes){
+    FILE* f = std::fopen(path, "rb");
+    if(!f) return false;
+    std::vector<uint8_t> buf;
+    uint8_t chunk[1 << 14];
+    size_t n;
+    while((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) buf.insert(buf.end(), chunk, chunk + n);
+    std::fclose(f);
+
+    const uint8_t* p = buf.data();
+    const uint8_t* end = p + buf.size();
+    if(older) *older = 0;
+    if(tornBytes) *tornBytes = 0;
+    // the rest of the file is an incomplete last record: keep what came before
+    auto torn = [&](const uint8_t* from){
+        if(tornBytes) *tornBytes = (size_t)(end - from);
+        return true;
+    };
+    while(p < end){
+        size_t left = (size_t)(end - p);
+        if(std::memcmp(p, REC_MAGIC, std::min<size_t>(left, 4))) return false;
+        if(left < REC_HEADER_V1) return torn(p);
+        if(p[4] == 1){
+            const uint8_t* q = p + REC_HEADER_V1 - 4;
+            uint32_t bytes = (uint32_t)Get(q, 4);
+            if((size_t)(end - q) < bytes) return torn(p);
+            p = q + bytes;
+            if(older) (*older)++;
+            continue;
+        }
+        if(p[4] != REC_VERSION) return false;
+        if(left < REC_HEADER) return torn(p);
+        const uint8_t* start = p;
+        RunRecording r;
+        r.start  = (GameState)p[5];
+        r.killer = (ObType)p[6];
+        r.fairStream = (p[7] & REC_FAIR_STREAM) != 0;
+        p += 8;
+        r.seed = Get(p, 8); r.stream = Get(p, 8);
+        for(int i=0;i<8;i++) *TuneField(r.tune, i) = BitsFloat((uint32_t)Get(p, 4));
+        r.spawnId = (uint32_t)Get(p, 4);
+        r.score  = (int32_t)Get(p, 4);
+        r.ticks  = (uint32_t)Get(p, 4);
+        r.events = (uint32_t)Get(p, 4);
+        uint32_t bytes = (uint32_t)Get(p, 4);
+        if((size_t)(end - p) < bytes) return torn(start);
+        r.data.assign(p, p + bytes);
+        p += bytes;
+        out.push_back(std::move(r));
+    }
+    return true;
+}
@@ -0,0 +1,91 @@
+// ------------------------------------------------------------------
+// File: trex_replay.h
+// Run recording (seed + input events) and headless replay
+// ------------------------------------------------------------------
+//  - a run is fully described by its seed/stream, Tuning, spawn table,
+//    start state and the DoJump/SetDuck calls keyed to World::ticks;
+//    the table is stored by id only, so replay needs the same one loaded
+//  - runs whose obstacles came from the validated stream (trex_stream.h)
+//    are flagged; the stream is rebuilt from the seed for replay
+//  - events are delta-encoded varints: (ticks since last << 2) | kind,
+//    so a typical run is a few hundred bytes
+//  - InputRecorder wraps DoJump/SetDuck and only logs calls that change
+//    the world (held-key auto-repeat mostly does nothing)
+//  - ReplayRun() re-simulates at full speed and compares the score;
+//    float results are only bit-exact for the same compiler flags
+//    (e.g. FMA contraction changes them)
+// ------------------------------------------------------------------
+#ifndef TREX_REPLAY_H
+#define TREX_REPLAY_H
+
+#include "trex_sim.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class InputKind : uint8_t { Jump, DuckDown, DuckUp };
+
+struct RunRecording {
+    uint64_t  seed = 0, stream = 0;
+    Tuning    tune;
+    uint32_t  spawnId = 0;              // SpawnTable::id in force
+    bool      fairStream = false;       // obstacles from a SpawnFeed
+    GameState start = GameState::MENU;  // 'R' restarts straight into PLAYING
+    int32_t   score = 0;                // as recorded at game over
+    uint32_t  ticks = 0;
+    ObType    killer{};
+    uint32_t  events = 0;
+    std::vector<uint8_t> data;          // varint event stream
+};
+
+// Event bytes an InputRecorder holds without growing: ~30k inputs
+static const size_t REC_RESERVE = 64 * 1024;
+
+class InputRecorder {
+public:
+    // Call right after ResetWorld(); w.state decides how replay starts.
+    // The event buffer keeps its capacity (at least REC_RESERVE), so
+    // logging inputs during play doesn't allocate.
+    void Begin(const World& w, uint64_t seed, uint64_t stream = 0);
+    // Same effect as DoJump / SetDuck, logged against w.ticks.
+    void Jump(World& w);
+    void Duck(World& w, bool down);
+    void Apply(World& w, const TickInput& in);
+    // Stamp the final score; the recording is complete after this.
+    const RunRecording& Finish(const World& w);
+
+    const RunRecording& Recording() const { return rec_; }
+
+private:
+    void Log(uint32_t tick, InputKind k);
+
+    RunRecording rec_;
+    uint32_t     lastTick_ = 0;
+};
+
+struct ReplayResult {
+    int      score;
+    uint32_t ticks;
+    ObType   killer;
+    bool     died;
+    bool     match;     // score, ticks and killer equal the recording
+};
+
+// Re-simulate a recording with w.spawn (check r.spawnId first) and
+// w.feed (fed from r.seed when r.fairStream); stops at death, maxTicks
+// or when the events run out with the game still in MENU.
+ReplayResult ReplayRun(World& w, const RunRecording& r, uint32_t maxTicks = 0xFFFFFFFFu);
+
+// Recordings are appended to one file, one framed record per run.
+bool AppendRecording(const char* path, const RunRecording& r);
+// One record in file format, appended to `out`.
+void EncodeRecording(const RunRecording& r, std::vector<uint8_t>& out);
+// Records from an older format version (different game rules) are
+// skipped and counted in `older`. A final record cut short (a write
+// interrupted by a crash or power loss) ends the file: the records before
+// it are returned and its length goes to `tornBytes`. False if the file
+// can't be read or a record is malformed.
+bool LoadRecordings(const char* path, std::vector<RunRecording>& out, size_t* older = nullptr,
+                    size_t* tornBytes = nullptr);
+
+#endif
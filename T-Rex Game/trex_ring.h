@@ -0,0 +1,90 @@
+// ------------------------------------------------------------------
+// File: trex_ring.h
+// Fixed-capacity FIFO ring buffer for spawn-ordered entities
+// ------------------------------------------------------------------
+//  - storage is allocated by reserve() (or a copy) and never again:
+//    push_back on a full ring fails instead of growing
+//  - push_back at the tail, pop_front at the head, both O(1); elements
+//    keep spawn order and are indexed 0..size()-1 from the oldest
+//  - capacity is rounded up to a power of two so indexing is a mask
+// ------------------------------------------------------------------
+#ifndef TREX_RING_H
+#define TREX_RING_H
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+template<class T>
+class Ring {
+public:
+    Ring() {}
+    explicit Ring(size_t capacity){ reserve(capacity); }
+
+    // Grow to at least `capacity` slots, keeping the contents. The only
+    // place a Ring allocates.
+    void reserve(size_t capacity){
+        size_t cap = 1;
+        while(cap < capacity) cap <<= 1;
+        if(cap <= slots_.size()) return;
+        std::vector<T> next(cap);
+        for(size_t i=0;i<count_;i++) next[i] = (*this)[i];
+        slots_.swap(next);
+        head_ = 0;
+    }
+
+    size_t capacity() const { return slots_.size(); }
+    size_t size()     const { return count_; }
+    bool   empty()    const { return count_ == 0; }
+    bool   full()     const { return count_ == slots_.size(); }
+    void   clear()          { head_ = 0; count_ = 0; }
+
+    // False (and nothing stored) when full.
+    bool push_back(const T& v){
+        if(full()) return false;
+        slots_[(head_ + count_) & (slots_.size() - 1)] = v;
+        count_++;
+        return true;
+    }
+    void pop_front(){ head_ = (head_ + 1) & (slots_.size() - 1); count_--; }
+
+    T&       operator[](size_t i)       { return slots_[(head_ + i) & (slots_.size() - 1)]; }
+    const T& operator[](size_t i) const { return slots_[(head_ + i) & (slots_.size() - 1)]; }
+    T&       front()       { return (*this)[0]; }
+    const T& front() const { return (*this)[0]; }
+    T&       back()        { return (*this)[count_ - 1]; }
+    const T& back()  const { return (*this)[count_ - 1]; }
+
+    template<class R, class E>
+    class Iter {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef E              value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef E*             pointer;
+        typedef E&             reference;
+
+        Iter(R* r, size_t i) : r_(r), i_(i) {}
+        E&    operator*()  const { return (*r_)[i_]; }
+        E*    operator->() const { return &(*r_)[i_]; }
+        Iter& operator++(){ i_++; return *this; }
+        bool  operator==(const Iter& o) const { return i_ == o.i_; }
+        bool  operator!=(const Iter& o) const { return i_ != o.i_; }
+    private:
+        R*     r_;
+        size_t i_;
+    };
+    typedef Iter<Ring, T>             iterator;
+    typedef Iter<const Ring, const T> const_iterator;
+
+    iterator       begin()       { return iterator(this, 0); }
+    iterator       end()         { return iterator(this, count_); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end()   const { return const_iterator(this, count_); }
+
+private:
+    std::vector<T> slots_;   // size() == capacity, power of two (or 0)
+    size_t head_ = 0, count_ = 0;
+};
+
+#endif
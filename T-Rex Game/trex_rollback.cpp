@@ -0,0 +1,218 @@
+// ------------------------------------------------------------------
+// File: trex_rollback.cpp
+// World snapshots, race stepping and the rollback session
+// ------------------------------------------------------------------
+#include "trex_rollback.h"
+#include <chrono>
+#include <cstring>
+
+// ---------------- Snapshots --------------------------
+void SaveWorld(const World& w, WorldSnapshot& s){
+    s.state = w.state; s.dino = w.dino; s.rng = w.rng; s.tune = w.tune; s.spawn = w.spawn; s.feed = w.feed;
+    s.worldSpd = w.worldSpd; s.spawnTimer = w.spawnTimer;
+    s.spawnGapMin = w.spawnGapMin; s.spawnGapMax = w.spawnGapMax; s.nextSpawnIn = w.nextSpawnIn;
+    s.distance = w.distance;
+    s.score = w.score; s.ticks = w.ticks; s.spawned = w.spawned; s.killer = w.killer;
+    s.obsCount = (uint32_t)w.obs.size();
+    s.cloudCount = (uint32_t)w.clouds.size();
+    for(uint32_t i=0;i<s.obsCount;i++) s.obs[i] = w.obs[i];
+    for(uint32_t i=0;i<s.cloudCount;i++) s.clouds[i] = w.clouds[i];
+}
+
+void LoadWorld(const WorldSnapshot& s, World& w){
+    w.state = s.state; w.dino = s.dino; w.rng = s.rng; w.tune = s.tune; w.spawn = s.spawn; w.feed = s.feed;
+    w.worldSpd = s.worldSpd; w.spawnTimer = s.spawnTimer;
+    w.spawnGapMin = s.spawnGapMin; w.spawnGapMax = s.spawnGapMax; w.nextSpawnIn = s.nextSpawnIn;
+    w.distance = s.distance;
+    w.score = s.score; w.ticks = s.ticks; w.spawned = s.spawned; w.killer = s.killer;
+    w.obs.clear();
+    w.clouds.clear();
+    for(uint32_t i=0;i<s.obsCount;i++) w.obs.push_back(s.obs[i]);
+    for(uint32_t i=0;i<s.cloudCount;i++) w.clouds.push_back(s.clouds[i]);
+}
+
+// FNV-1a over fields, not bytes: padding is never compared.
+static void Mix(uint32_t& h, const void* p, size_t n){
+    const uint8_t* b = (const uint8_t*)p;
+    for(size_t i=0;i<n;i++){ h ^= b[i]; h *= 16777619u; }
+}
+
+uint32_t WorldChecksum(const WorldSnapshot& s){
+    uint32_t h = 2166136261u;
+    uint8_t flags[3] = { (uint8_t)s.state, (uint8_t)s.dino.onGround, (uint8_t)s.dino.duck };
+    Mix(h, flags, 3);
+    Mix(h, &s.dino.y, 4); Mix(h, &s.dino.vy, 4);
+    Mix(h, &s.rng.state, 8);
+    Mix(h, &s.score, 4); Mix(h, &s.ticks, 4);
+    Mix(h, &s.obsCount, 4);
+    for(uint32_t i=0;i<s.obsCount;i++){ Mix(h, &s.obs[i].x, 4); Mix(h, &s.obs[i].type, sizeof(ObType)); }
+    return h;
+}
+
+// ---------------- Race -------------------------------
+void ResetRace(RaceState& r, uint64_t seed, const SpawnTable* spawn){
+    for(auto &w: r.p){
+        w.spawn = spawn;
+        ResetWorld(w, seed);
+        w.state = GameState::PLAYING;
+    }
+    r.frame = 0;
+}
+
+void StepRace(RaceState& r, const uint8_t in[2]){
+    for(int i=0;i<2;i++){
+        World& w = r.p[i];
+        if(w.state != GameState::PLAYING) continue;
+        ApplyInput(w, TickInput{ (in[i] & RB_JUMP) != 0, (in[i] & RB_DUCK) != 0 });
+        UpdateGame(w, DT);
+    }
+    r.frame++;
+}
+
+bool RaceOver(const RaceState& r){
+    return r.p[0].state != GameState::PLAYING && r.p[1].state != GameState::PLAYING;
+}
+
+void SaveRace(const RaceState& r, RaceSnapshot& s){
+    SaveWorld(r.p[0], s.p[0]); SaveWorld(r.p[1], s.p[1]);
+    s.frame = r.frame;
+}
+
+void LoadRace(const RaceSnapshot& s, RaceState& r){
+    LoadWorld(s.p[0], r.p[0]); LoadWorld(s.p[1], r.p[1]);
+    r.frame = s.frame;
+}
+
+// ---------------- Session ----------------------------
+void RollbackSession::Start(uint64_t seed, int localPlayer, int delay, const SpawnTable* spawn){
+    local_ = (uint8_t)(localPlayer & 1); remote_ = (uint8_t)(local_ ^ 1);
+    if(delay < 0) delay = 0;
+    if(delay > RB_MAX_PREDICT / 2) delay = RB_MAX_PREDICT / 2;
+    std::memset(localIn_, 0, sizeof(localIn_));
+    delay_ = (uint32_t)delay;
+    localNext_ = delay_;                       // the first `delay` frames idle
+    std::memset(remoteIn_, 0, sizeof(remoteIn_));
+    std::memset(used_, 0, sizeof(used_));
+    remoteNext_ = 0; remoteLast_ = 0;
+    rollbackFrom_ = UINT32_MAX;
+    peerAck_ = 0; peerCheckFrame_ = 0; peerChecksum_ = 0;
+    lastCheck_ = 0; lastCompared_ = 0;
+    stats_.frames = stats_.stalls = stats_.rollbacks = stats_.resimFrames = 0;
+    stats_.maxResim = 0; stats_.mispredicted = stats_.checks = stats_.desyncs = 0;
+    stats_.resimUs.Reset();
+
+    ResetRace(race_, seed, spawn);
+    SaveRace(race_, snaps_[0]);
+}
+
+void RollbackSession::AddLocalInput(uint8_t in){
+    if(localNext_ > race_.frame + delay_) return;   // already have this frame's
+    localIn_[localNext_ & 255] = in;
+    localNext_++;
+}
+
+uint8_t RollbackSession::InputFor(int player, uint32_t frame){
+    if(player == local_) return frame < localNext_ ? localIn_[frame & 255] : 0;
+    uint8_t v = frame < remoteNext_ ? remoteIn_[frame & 255] : (uint8_t)(remoteLast_ & RB_DUCK);
+    used_[frame & 255] = v;
+    return v;
+}
+
+// Simulate `frame` (the state must be the one before it) and keep the result.
+void RollbackSession::Simulate(uint32_t frame){
+    uint8_t in[2] = { InputFor(0, frame), InputFor(1, frame) };
+    StepRace(race_, in);
+    SaveRace(race_, snaps_[(frame + 1) % RB_WINDOW]);
+}
+
+void RollbackSession::Rollback(){
+    uint32_t from = rollbackFrom_;
+    rollbackFrom_ = UINT32_MAX;
+    if(from >= race_.frame) return;
+    auto t0 = std::chrono::steady_clock::now();
+    uint32_t to = race_.frame;
+    LoadRace(snaps_[from % RB_WINDOW], race_);
+    for(uint32_t f=from;f<to;f++) Simulate(f);
+    uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    uint32_t n = to - from;
+    stats_.rollbacks++;
+    stats_.resimFrames += n;
+    if(n > stats_.maxResim) stats_.maxResim = n;
+    stats_.resimUs.Add(ns / 1000);
+}
+
+bool RollbackSession::Advance(){
+    if(!CanAdvance()){ stats_.stalls++; return false; }
+    Rollback();
+    Simulate(race_.frame);
+    stats_.frames++;
+    CheckConfirmed();
+    return true;
+}
+
+// Checksum every RB_CHECK_EVERY-th frame once its state is final.
+void RollbackSession::CheckConfirmed(){
+    uint32_t c = ConfirmedFrame();
+    uint32_t next = lastCheck_ + RB_CHECK_EVERY;
+    while(next <= c){
+        if(next + RB_WINDOW > race_.frame){        // still in the window
+            int slot = (int)((next / RB_CHECK_EVERY) % RB_WINDOW);
+            checkFrame_[slot] = next;
+            checksum_[slot] = WorldChecksum(snaps_[next % RB_WINDOW].p[0]) * 31u
+                            + WorldChecksum(snaps_[next % RB_WINDOW].p[1]);
+            Compare(next);
+        }
+        lastCheck_ = next;
+        next += RB_CHECK_EVERY;
+    }
+}
+
+void RollbackSession::Compare(uint32_t frame){
+    if(frame == 0 || frame <= lastCompared_ || peerCheckFrame_ != frame) return;
+    int slot = (int)((frame / RB_CHECK_EVERY) % RB_WINDOW);
+    if(checkFrame_[slot] != frame) return;
+    lastCompared_ = frame;
+    stats_.checks++;
+    if(checksum_[slot] != peerChecksum_) stats_.desyncs++;
+}
+
+void RollbackSession::MakePacket(RacePacket& p) const {
+    std::memset(&p, 0, sizeof(p));
+    p.magic[0] = 'T'; p.magic[1] = 'R';
+    p.player = local_;
+    uint32_t start = peerAck_;
+    if(localNext_ > RB_PACKET_INPUTS && start < localNext_ - RB_PACKET_INPUTS) start = localNext_ - RB_PACKET_INPUTS;
+    if(start > localNext_) start = localNext_;
+    p.start = start;
+    p.count = (uint8_t)(localNext_ - start);
+    for(uint32_t i=0;i<p.count;i++) p.inputs[i] = localIn_[(start + i) & 255];
+    p.ack = remoteNext_;
+    int slot = (int)((lastCheck_ / RB_CHECK_EVERY) % RB_WINDOW);
+    bool have = lastCheck_ && checkFrame_[slot] == lastCheck_;
+    p.checkFrame = have ? lastCheck_ : 0;
+    p.checksum = have ? checksum_[slot] : 0;
+}
+
+void RollbackSession::OnPacket(const RacePacket& p){
+    if(p.magic[0] != 'T' || p.magic[1] != 'R' || p.player != remote_ || p.count > RB_PACKET_INPUTS) return;
+    if(p.ack > peerAck_) peerAck_ = p.ack;
+    // take the inputs that continue what we have, within the window
+    for(uint32_t i=0;i<p.count;i++){
+        uint32_t f = p.start + i;
+        if(f < remoteNext_) continue;
+        if(f > remoteNext_ || f >= race_.frame + RB_WINDOW) break;
+        uint8_t v = p.inputs[i];
+        remoteIn_[f & 255] = v;
+        if(f < race_.frame && used_[f & 255] != v){
+            stats_.mispredicted++;
+            if(f < rollbackFrom_) rollbackFrom_ = f;
+        }
+        remoteNext_++;
+        remoteLast_ = v;
+    }
+    if(p.checkFrame && p.checkFrame > peerCheckFrame_){
+        peerCheckFrame_ = p.checkFrame; peerChecksum_ = p.checksum;
+        Compare(p.checkFrame);
+    }
+}
@@ -0,0 +1,162 @@
+// ------------------------------------------------------------------
+// File: trex_rollback.h
+// Two-player race with rollback: POD snapshots, predicted inputs
+// ------------------------------------------------------------------
+//  - a race is two Worlds on the same seed; obstacles, clouds and the
+//    ramp never depend on the dino, so both players face the same stream
+//  - WorldSnapshot is a flat, trivially copyable image of a World (the
+//    rings copied into fixed arrays); saving or restoring one is a few
+//    memcpys and never touches the heap
+//  - RollbackSession keeps a snapshot and both players' inputs for the
+//    last RB_WINDOW frames. The remote input of a frame not heard from
+//    yet is predicted (no jump, duck as last known); when the real one
+//    differs, the session restores the snapshot of that frame and
+//    re-simulates up to the present. It never runs more than
+//    RB_MAX_PREDICT frames ahead of the remote peer.
+//  - a checksum of every RB_CHECK_EVERY-th confirmed frame is exchanged
+//    so a desync is caught instead of silently diverging
+//  - transport-agnostic: the caller moves RacePackets (RaceLink over
+//    UDP in trex_race and the game's --race mode, trex_racelink.h; an
+//    in-memory queue in trex_bench)
+// ------------------------------------------------------------------
+#ifndef TREX_ROLLBACK_H
+#define TREX_ROLLBACK_H
+
+#include "trex_sim.h"
+#include "trex_pacing.h"
+#include <cstdint>
+#include <type_traits>
+
+static const int RB_WINDOW      = 16;   // frames of history (power of two)
+static const int RB_MAX_PREDICT = 8;    // frames we may run ahead of the peer
+static const int RB_CHECK_EVERY = 30;
+static const int RB_PACKET_INPUTS = 32;
+
+// Per-tick input bits: jump = pressed this tick, duck = held.
+static const uint8_t RB_JUMP = 1, RB_DUCK = 2;
+
+struct WorldSnapshot {
+    GameState state;
+    Dino      dino;
+    Pcg32     rng;
+    Tuning    tune;
+    const SpawnTable* spawn;
+    const SpawnFeed*  feed;
+    float     worldSpd, spawnTimer, spawnGapMin, spawnGapMax, nextSpawnIn;
+    double    distance;
+    int       score;
+    uint32_t  ticks, spawned;
+    ObType    killer;
+    uint32_t  obsCount, cloudCount;
+    Obstacle  obs[OBS_CAPACITY];
+    Cloud     clouds[CLOUD_CAPACITY];
+};
+static_assert(std::is_trivially_copyable<WorldSnapshot>::value, "snapshots are copied as bytes");
+
+// World must hold at most OBS_CAPACITY obstacles (any World that only
+// ever ran UpdateGame does). Load needs no allocation into a World whose
+// rings are at least the default size.
+void SaveWorld(const World& w, WorldSnapshot& s);
+void LoadWorld(const WorldSnapshot& s, World& w);
+uint32_t WorldChecksum(const WorldSnapshot& s);
+
+// ---------------- Race -------------------------------
+struct RaceState {
+    World    p[2];
+    uint32_t frame = 0;
+};
+
+struct RaceSnapshot {
+    WorldSnapshot p[2];
+    uint32_t      frame;
+};
+
+void ResetRace(RaceState& r, uint64_t seed, const SpawnTable* spawn = &DEFAULT_SPAWN_TABLE);
+// One tick for both players; a player who has died stands still.
+void StepRace(RaceState& r, const uint8_t in[2]);
+bool RaceOver(const RaceState& r);
+void SaveRace(const RaceState& r, RaceSnapshot& s);
+void LoadRace(const RaceSnapshot& s, RaceState& r);
+
+// ---------------- Wire format ------------------------
+// Inputs of frames [start, start + count) from the sender, plus what it
+// has confirmed of ours and its latest checksum. Fixed size, host byte
+// order (both peers are the same build on one box or LAN).
+struct RacePacket {
+    char     magic[2];            // 'T','R'
+    uint8_t  player;
+    uint8_t  count;
+    uint32_t start;
+    uint32_t ack;                 // sender holds our inputs for frames < ack
+    uint32_t checkFrame;          // 0 = no checksum yet
+    uint32_t checksum;
+    uint8_t  inputs[RB_PACKET_INPUTS];
+};
+
+struct RollbackStats {
+    uint64_t frames = 0;          // frames advanced
+    uint64_t stalls = 0;          // Advance() refused: too far ahead of the peer
+    uint64_t rollbacks = 0;
+    uint64_t resimFrames = 0;
+    uint32_t maxResim = 0;        // frames in the longest rollback
+    uint64_t mispredicted = 0;    // remote inputs that differed from the guess
+    uint64_t checks = 0, desyncs = 0;
+    PacingHist resimUs;           // restore + re-simulate, per rollback
+};
+
+class RollbackSession {
+public:
+    // delay: frames between reading a local input and simulating it
+    // (at most RB_MAX_PREDICT / 2)
+    void Start(uint64_t seed, int localPlayer, int delay = 0, const SpawnTable* spawn = &DEFAULT_SPAWN_TABLE);
+
+    // Local input for the frame Advance() is about to simulate (+ delay).
+    void AddLocalInput(uint8_t in);
+    bool CanAdvance() const { return race_.frame < remoteNext_ + RB_MAX_PREDICT; }
+    // Rolls back if a late remote input contradicted a guess, then
+    // simulates one new frame. False (and nothing done) if stalled.
+    bool Advance();
+
+    void MakePacket(RacePacket& p) const;
+    // Ignores packets from the wrong player or with a bad magic.
+    void OnPacket(const RacePacket& p);
+
+    const RaceState& State() const { return race_; }
+    uint32_t Frame() const { return race_.frame; }
+    // Every input up to here is known; the state before it is final.
+    uint32_t ConfirmedFrame() const { return remoteNext_ < race_.frame ? remoteNext_ : race_.frame; }
+    // Final state at ConfirmedFrame() (only valid once it is in the window).
+    const RaceSnapshot& ConfirmedSnapshot() const { return snaps_[ConfirmedFrame() % RB_WINDOW]; }
+    int  LocalPlayer() const { return local_; }
+    const RollbackStats& Stats() const { return stats_; }
+
+private:
+    uint8_t InputFor(int player, uint32_t frame);
+    void    Simulate(uint32_t frame);
+    void    Rollback();
+    void    CheckConfirmed();
+    void    Compare(uint32_t frame);
+
+    RaceState    race_;
+    RaceSnapshot snaps_[RB_WINDOW];           // state before frame f at f % RB_WINDOW
+    uint8_t      local_ = 0, remote_ = 1;
+    uint32_t     delay_ = 0;
+    uint8_t      localIn_[256] = {};          // by frame & 255, up to localNext_
+    uint32_t     localNext_ = 0;
+    // Remote inputs arrive up to RB_WINDOW frames ahead while rollbacks
+    // still read them RB_MAX_PREDICT frames back, so these rings are
+    // sized like localIn_, not like the snapshot window.
+    uint8_t      remoteIn_[256] = {};         // known remote inputs by frame & 255, < remoteNext_
+    uint8_t      used_[256] = {};             // remote input each frame was simulated with, & 255
+    uint32_t     remoteNext_ = 0;
+    uint8_t      remoteLast_ = 0;
+    uint32_t     rollbackFrom_ = UINT32_MAX;
+    uint32_t     peerAck_ = 0;                // peer holds our inputs below this
+    uint32_t     peerCheckFrame_ = 0, peerChecksum_ = 0;
+    uint32_t     checkFrame_[RB_WINDOW] = {};  // our checksums, by check number
+    uint32_t     checksum_[RB_WINDOW] = {};
+    uint32_t     lastCheck_ = 0, lastCompared_ = 0;
+    RollbackStats stats_;
+};
+
+#endif
@@ -0,0 +1,497 @@
+// ------------------------------------------------------------------
+// File: trex_runlog.cpp
+// Mapped, multi-threaded trex_runs.log parser + sidecar index
+// ------------------------------------------------------------------
+#include "trex_runlog.h"
+#include "trex_bits.h"
+#include "trex_persist.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+static const size_t CHUNK_BYTES = 8u << 20;   // one unit of parallel work
+
+// ---------------- Dates ------------------------------
+// H. Hinnant's days_from_civil / civil_from_days
+int32_t DayNumber(int y, int m, int d){
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void DayToDate(int32_t day, int& y, int& m, int& d){
+    int z = day + 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp + (mp < 10 ? 3 : -9);
+    y = yoe + era * 400 + (m <= 2);
+}
+
+static inline bool Digits(const char* s, int n, int& v){
+    v = 0;
+    for(int i=0;i<n;i++){
+        unsigned c = (unsigned)(s[i] - '0');
+        if(c > 9) return false;
+        v = v * 10 + (int)c;
+    }
+    return true;
+}
+
+bool ParseDate(const char* s, int32_t& day){
+    int y, m, d;
+    if(std::strlen(s) != 10 || s[4] != '-' || s[7] != '-') return false;
+    if(!Digits(s, 4, y) || !Digits(s + 5, 2, m) || !Digits(s + 8, 2, d)) return false;
+    if(m < 1 || m > 12 || d < 1 || d > 31) return false;
+    day = DayNumber(y, m, d);
+    return true;
+}
+
+// ---------------- Histogram --------------------------
+int LogHist::Index(uint32_t v){
+    if(v < 2 * SUB) return (int)v;
+    int e = HighBit(v);                       // >= 7
+    return 2 * SUB + (e - 7) * SUB + (int)((v >> (e - 6)) - SUB);
+}
+
+uint32_t LogHist::Lower(int i){
+    if(i < 2 * SUB) return (uint32_t)i;
+    int e = 7 + (i - 2 * SUB) / SUB;
+    uint32_t m = (uint32_t)(SUB + (i - 2 * SUB) % SUB);
+    return m << (e - 6);
+}
+
+uint32_t LogHist::Percentile(uint64_t total, double p) const {
+    if(!total) return 0;
+    uint64_t rank = (uint64_t)std::ceil(p / 100.0 * (double)total);
+    if(rank < 1) rank = 1;
+    if(rank > total) rank = total;
+    uint64_t seen = 0;
+    for(int i=0;i<BINS;i++){
+        seen += bins[i];
+        if(seen >= rank) return Lower(i);
+    }
+    return Lower(BINS - 1);
+}
+
+void PeriodStats::Add(int score){
+    runs++; sum += score;
+    if(score < min) min = score;
+    if(score > max) max = score;
+    hist.Add((uint32_t)score);
+}
+
+void PeriodStats::Merge(const PeriodStats& o){
+    runs += o.runs; sum += o.sum;
+    min = std::min(min, o.min); max = std::max(max, o.max);
+    hist.Merge(o.hist);
+}
+
+// ---------------- Mapping ----------------------------
+class MappedFile {
+public:
+    ~MappedFile(){ Close(); }
+    bool Open(const char* path){
+#ifdef _WIN32
+        file_ = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if(file_ == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz; if(!GetFileSizeEx(file_, &sz)) return false;
+        size_ = (size_t)sz.QuadPart;
+        if(!size_) return true;
+        map_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(!map_) return false;
+        data_ = (const char*)MapViewOfFile(map_, FILE_MAP_READ, 0, 0, 0);
+        return data_ != nullptr;
+#else
+        fd_ = ::open(path, O_RDONLY);
+        if(fd_ < 0) return false;
+        struct stat st; if(fstat(fd_, &st) != 0) return false;
+        size_ = (size_t)st.st_size;
+        if(!size_) return true;
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if(p == MAP_FAILED) return false;
+        madvise(p, size_, MADV_SEQUENTIAL);
+        data_ = (const char*)p;
+        return true;
+#endif
+    }
+    void Close(){
+#ifdef _WIN32
+        if(data_) UnmapViewOfFile(data_);
+        if(map_) CloseHandle(map_);
+        if(file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        map_ = nullptr; file_ = INVALID_HANDLE_VALUE;
+#else
+        if(data_) munmap((void*)data_, size_);
+        if(fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+#endif
+        data_ = nullptr; size_ = 0;
+    }
+    const char* data() const { return data_; }
+    size_t      size() const { return size_; }
+
+private:
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE, map_ = nullptr;
+#else
+    int    fd_ = -1;
+#endif
+    const char* data_ = nullptr;
+    size_t      size_ = 0;
+};
+
+// ---------------- Sidecar index ----------------------
+// "TRXI" u32 version, u64 bytes covered, u64 fingerprint, u64 count,
+// then per segment i32 day, u32 lines, u64 offset. A segment ends where
+// the next starts. The fingerprint hashes the first and last covered
+// lines, so a rotated or rewritten log isn't read through a stale index.
+struct Segment { int32_t day; uint32_t lines; uint64_t offset; };
+
+static const char     IDX_MAGIC[4] = { 'T', 'R', 'X', 'I' };
+static const uint32_t IDX_VERSION  = 2;
+static const size_t   IDX_PRINT_MAX = 4096;     // bytes of each line hashed
+
+static uint64_t Fnv1a(uint64_t h, const char* s, size_t n){
+    for(size_t i=0;i<n;i++){ h ^= (unsigned char)s[i]; h *= 1099511628211ull; }
+    return h;
+}
+
+// First and last line of [0, covered); covered ends on a '\n'.
+static uint64_t CoverFingerprint(const char* base, uint64_t covered){
+    uint64_t h = 14695981039346656037ull;
+    if(!covered) return h;
+    size_t n = (size_t)std::min<uint64_t>(covered, IDX_PRINT_MAX);
+    const char* nl = (const char*)std::memchr(base, '\n', n);
+    h = Fnv1a(h, base, nl ? (size_t)(nl - base) + 1 : n);
+    size_t e = (size_t)covered, b = e - 1;
+    while(b > 0 && e - b < IDX_PRINT_MAX && base[b - 1] != '\n') b--;
+    return Fnv1a(h, base + b, e - b);
+}
+
+static bool LoadIndex(const std::string& path, uint64_t& covered, uint64_t& print, std::vector<Segment>& segs){
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if(!f) return false;
+    char magic[4]; uint32_t ver = 0; uint64_t n = 0;
+    bool ok = std::fread(magic, 1, 4, f) == 4 && !std::memcmp(magic, IDX_MAGIC, 4) &&
+              std::fread(&ver, 4, 1, f) == 1 && ver == IDX_VERSION &&
+              std::fread(&covered, 8, 1, f) == 1 && std::fread(&print, 8, 1, f) == 1 &&
+              std::fread(&n, 8, 1, f) == 1;
+    if(ok){
+        segs.resize((size_t)n);
+        ok = n == 0 || std::fread(segs.data(), sizeof(Segment), (size_t)n, f) == (size_t)n;
+    }
+    std::fclose(f);
+    return ok;
+}
+
+static bool SaveIndex(const std::string& path, uint64_t covered, uint64_t print, const std::vector<Segment>& segs){
+    static_assert(sizeof(Segment) == 16, "index segment layout");
+    std::string b(IDX_MAGIC, 4);
+    uint64_t n = segs.size();
+    b.append((const char*)&IDX_VERSION, 4);
+    b.append((const char*)&covered, 8);
+    b.append((const char*)&print, 8);
+    b.append((const char*)&n, 8);
+    b.append((const char*)segs.data(), segs.size() * sizeof(Segment));
+    return WriteFileAtomic(path, b);
+}
+
+static void AppendSegment(std::vector<Segment>& segs, const Segment& s){
+    if(!segs.empty() && segs.back().day == s.day) segs.back().lines += s.lines;
+    else segs.push_back(s);
+}
+
+// ---------------- Parsing ----------------------------
+struct Job {
+    size_t begin, end;
+    bool   segments;        // collect index segments for this range
+};
+
+struct WorkerStats {
+    PeriodStats total;
+    std::map<int32_t, PeriodStats> days;
+    std::vector<uint64_t> bins;
+    std::vector<TopRun> top;              // min-heap on score, size <= K
+    uint64_t bad = 0, bytes = 0;
+};
+
+static bool TopLess(const TopRun& a, const TopRun& b){ return a.score > b.score; }   // heap keeps smallest on top
+
+static void PushTop(std::vector<TopRun>& heap, int k, const TopRun& r){
+    if(k <= 0) return;
+    if((int)heap.size() < k){ heap.push_back(r); std::push_heap(heap.begin(), heap.end(), TopLess); }
+    else if(r.score > heap.front().score){
+        std::pop_heap(heap.begin(), heap.end(), TopLess);
+        heap.back() = r;
+        std::push_heap(heap.begin(), heap.end(), TopLess);
+    }
+}
+
+// "YYYY-MM-DD HH:MM:SS, score" with optional '\r'; false for anything else
+static inline bool ParseLine(const char* s, const char* e, int32_t& day, int32_t& sec, int& score,
+                             const char* lastDate, int32_t lastDay){
+    if(e - s < 22 || s[4] != '-' || s[7] != '-' || s[10] != ' ' || s[13] != ':' || s[16] != ':' ||
+       s[19] != ',' || s[20] != ' ') return false;
+    if(lastDate && !std::memcmp(s, lastDate, 10)) day = lastDay;
+    else {
+        int y, m, d;
+        if(!Digits(s, 4, y) || !Digits(s + 5, 2, m) || !Digits(s + 8, 2, d) || m < 1 || m > 12) return false;
+        day = DayNumber(y, m, d);
+    }
+    int hh, mm, ss;
+    if(!Digits(s + 11, 2, hh) || !Digits(s + 14, 2, mm) || !Digits(s + 17, 2, ss)) return false;
+    sec = hh * 3600 + mm * 60 + ss;
+    const char* p = s + 21;
+    if(e > p && e[-1] == '\r') e--;
+    if(p == e || e - p > 9) return false;
+    int v = 0;
+    for(; p<e; p++){
+        unsigned c = (unsigned)(*p - '0');
+        if(c > 9) return false;
+        v = v * 10 + (int)c;
+    }
+    score = v;
+    return true;
+}
+
+static void ParseRange(const char* base, const Job& job, const RunLogQuery& q, WorkerStats& ws,
+                       std::vector<Segment>* segs){
+    const char* p = base + job.begin;
+    const char* end = base + job.end;
+    const char* lastDate = nullptr;
+    int32_t lastDay = 0, curDay = INT_MIN;
+    PeriodStats* cur = nullptr;
+    Segment seg{ 0, 0, 0 };
+    while(p < end){
+        const char* nl = (const char*)std::memchr(p, '\n', (size_t)(end - p));
+        const char* le = nl ? nl : end;
+        int32_t day, sec; int score;
+        if(!ParseLine(p, le, day, sec, score, lastDate, lastDay)){
+            if(le > p && !(le - p == 1 && *p == '\r')) ws.bad++;
+        }
+        else {
+            lastDate = p; lastDay = day;
+            if(segs){
+                if(seg.lines && seg.day != day){ AppendSegment(*segs, seg); seg.lines = 0; }
+                if(!seg.lines){ seg.day = day; seg.offset = (uint64_t)(p - base); }
+                seg.lines++;
+            }
+            if(day >= q.from && day <= q.to){
+                if(day != curDay){ cur = &ws.days[day]; curDay = day; }
+                cur->Add(score);
+                ws.total.Add(score);
+                size_t bin = (size_t)(score / q.bucket);
+                if(bin >= ws.bins.size()) ws.bins.resize(bin + 1, 0);
+                ws.bins[bin]++;
+                if(ws.top.size() < (size_t)q.topK || score > ws.top.front().score)
+                    PushTop(ws.top, q.topK, TopRun{ score, day, sec });
+            }
+        }
+        p = nl ? nl + 1 : end;
+    }
+    if(segs && seg.lines) AppendSegment(*segs, seg);
+    ws.bytes += job.end - job.begin;
+}
+
+// Cut [b,e) into jobs of about CHUNK_BYTES that start and end on line breaks.
+static void SplitRange(const char* base, size_t b, size_t e, bool segments, std::vector<Job>& jobs){
+    while(b < e){
+        size_t cut = std::min(e, b + CHUNK_BYTES);
+        if(cut < e){
+            const char* nl = (const char*)std::memchr(base + cut, '\n', e - cut);
+            cut = nl ? (size_t)(nl - base) + 1 : e;
+        }
+        jobs.push_back(Job{ b, cut, segments });
+        b = cut;
+    }
+}
+
+// ---------------- Driver -----------------------------
+bool AnalyzeRunLog(const char* path, const RunLogQuery& q, RunLogStats& out, std::string& err){
+    auto t0 = std::chrono::steady_clock::now();
+    out = RunLogStats();
+    MappedFile mf;
+    if(!mf.Open(path)){ err = std::string("cannot map ") + path; return false; }
+    const char* base = mf.data();
+    size_t size = mf.size();
+    out.fileBytes = size;
+
+    // Index: reuse what it covers, parse only the rest
+    std::string idxPath = std::string(path) + ".idx";
+    std::vector<Segment> segs;
+    uint64_t covered = 0, print = 0;
+    if((q.useIndex || q.writeIndex) && LoadIndex(idxPath, covered, print, segs)){
+        if(covered <= size && (covered == 0 || base[covered - 1] == '\n') &&
+           CoverFingerprint(base, covered) == print)
+            out.indexUsed = q.useIndex;
+        else { out.indexStale = true; segs.clear(); covered = 0; }
+    }
+    else { segs.clear(); covered = 0; }
+    // a stale index is rebuilt, not left to be found stale again
+    bool writeIndex = q.writeIndex || out.indexStale;
+
+    std::vector<Job> jobs;
+    if(covered){
+        if(out.indexUsed && (q.from != INT_MIN || q.to != INT_MAX)){
+            // only the same-day runs inside the range, contiguous ones joined
+            size_t rb = 0, re = 0;
+            for(size_t i=0;i<segs.size();i++){
+                if(segs[i].day < q.from || segs[i].day > q.to) continue;
+                size_t b = (size_t)segs[i].offset;
+                size_t e = i + 1 < segs.size() ? (size_t)segs[i + 1].offset : (size_t)covered;
+                if(re == b){ re = e; continue; }
+                if(re > rb) SplitRange(base, rb, re, false, jobs);
+                rb = b; re = e;
+            }
+            if(re > rb) SplitRange(base, rb, re, false, jobs);
+        }
+        else SplitRange(base, 0, (size_t)covered, false, jobs);
+    }
+    size_t firstTail = jobs.size();
+    SplitRange(base, (size_t)covered, size, writeIndex, jobs);
+
+    unsigned n = q.threads ? q.threads : std::thread::hardware_concurrency();
+    if(n == 0) n = 1;
+    if(n > jobs.size()) n = jobs.empty() ? 1 : (unsigned)jobs.size();
+    out.threads = n;
+
+    std::vector<WorkerStats> ws(n);
+    std::vector<std::vector<Segment> > jobSegs(jobs.size());
+    std::atomic<size_t> next{0};
+    auto work = [&](unsigned t){
+        for(;;){
+            size_t j = next.fetch_add(1);
+            if(j >= jobs.size()) break;
+            ParseRange(base, jobs[j], q, ws[t], jobs[j].segments ? &jobSegs[j] : nullptr);
+        }
+    };
+    std::vector<std::thread> pool;
+    for(unsigned t=1;t<n;t++) pool.emplace_back(work, t);
+    work(0);
+    for(auto &th: pool) th.join();
+
+    // Merge
+    std::vector<TopRun> top;
+    for(auto &w: ws){
+        out.total.Merge(w.total);
+        for(const auto &d: w.days) out.days[d.first].Merge(d.second);
+        if(w.bins.size() > out.scoreBins.size()) out.scoreBins.resize(w.bins.size(), 0);
+        for(size_t i=0;i<w.bins.size();i++) out.scoreBins[i] += w.bins[i];
+        for(const auto &r: w.top) PushTop(top, q.topK, r);
+        out.badLines += w.bad;
+        out.bytesParsed += w.bytes;
+    }
+    std::sort(top.begin(), top.end(), [](const TopRun& a, const TopRun& b){
+        if(a.score != b.score) return a.score > b.score;
+        return a.day != b.day ? a.day < b.day : a.second < b.second;
+    });
+    out.top = top;
+
+    if(writeIndex){
+        for(size_t j=firstTail;j<jobs.size();j++)
+            for(const auto &s: jobSegs[j]) AppendSegment(segs, s);
+        out.indexWritten = SaveIndex(idxPath, size, CoverFingerprint(base, size), segs);
+    }
+    out.indexSegments = segs.size();
+    out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return true;
+}
+
+// ---------------- Report -----------------------------
+static void FormatDay(int32_t day, char* buf, size_t n){
+    int y, m, d; DayToDate(day, y, m, d);
+    std::snprintf(buf, n, "%04d-%02d-%02d", y, m, d);
+}
+
+static void PrintPeriodHeader(std::FILE* f, const char* label){
+    std::fprintf(f, "  %-10s %10s %8s %6s %6s %6s %6s %6s\n", label, "runs", "mean", "min", "p50", "p90", "p99", "max");
+}
+
+static void PrintPeriod(std::FILE* f, const char* label, const PeriodStats& p){
+    std::fprintf(f, "  %-10s %10llu %8.1f %6d %6u %6u %6u %6d\n", label, (unsigned long long)p.runs,
+                 p.runs ? (double)p.sum / (double)p.runs : 0.0, p.min,
+                 p.hist.Percentile(p.runs, 50), p.hist.Percentile(p.runs, 90), p.hist.Percentile(p.runs, 99), p.max);
+}
+
+void PrintRunLogStats(std::FILE* f, const RunLogQuery& q, const RunLogStats& s, bool days, bool weeks){
+    double mb = (double)s.bytesParsed / (1024.0 * 1024.0);
+    std::fprintf(f, "log       %.1f MB, parsed %.1f MB in %.3f s (%.0f MB/s) on %u threads\n",
+                 (double)s.fileBytes / (1024.0 * 1024.0), mb, s.seconds, s.seconds > 0 ? mb / s.seconds : 0.0, s.threads);
+    std::fprintf(f, "index     %s, %zu segments%s\n",
+                 s.indexStale ? "stale (log rewritten), ignored" : s.indexUsed ? "used" : "not used", s.indexSegments,
+                 s.indexWritten ? (s.indexStale ? " (rebuilt)" : " (written)") : "");
+    if(q.from != INT_MIN || q.to != INT_MAX){
+        char a[16] = "start", b[16] = "end";
+        if(q.from != INT_MIN) FormatDay(q.from, a, sizeof(a));
+        if(q.to != INT_MAX) FormatDay(q.to, b, sizeof(b));
+        std::fprintf(f, "range     %s .. %s\n", a, b);
+    }
+    std::fprintf(f, "runs      %llu (%llu unparsable lines)\n", (unsigned long long)s.total.runs, (unsigned long long)s.badLines);
+    if(!s.total.runs) return;
+    PrintPeriodHeader(f, "");
+    PrintPeriod(f, "all", s.total);
+
+    if(days){
+        std::fprintf(f, "daily\n");
+        PrintPeriodHeader(f, "day");
+        for(const auto &d: s.days){
+            char buf[16]; FormatDay(d.first, buf, sizeof(buf));
+            PrintPeriod(f, buf, d.second);
+        }
+    }
+    if(weeks){
+        // 1970-01-01 was a Thursday; shift so weeks start on Monday
+        std::map<int32_t, PeriodStats> wk;
+        for(const auto &d: s.days){
+            int32_t monday = d.first - (((d.first + 3) % 7) + 7) % 7;
+            wk[monday].Merge(d.second);
+        }
+        std::fprintf(f, "weekly\n");
+        PrintPeriodHeader(f, "week of");
+        for(const auto &w: wk){
+            char buf[16]; FormatDay(w.first, buf, sizeof(buf));
+            PrintPeriod(f, buf, w.second);
+        }
+    }
+
+    std::fprintf(f, "top %zu\n", s.top.size());
+    for(size_t i=0;i<s.top.size();i++){
+        char buf[16]; FormatDay(s.top[i].day, buf, sizeof(buf));
+        int sec = s.top[i].second;
+        std::fprintf(f, "  %2zu. %6d  %s %02d:%02d:%02d\n", i + 1, s.top[i].score, buf, sec / 3600, sec / 60 % 60, sec % 60);
+    }
+
+    uint64_t peak = 0; for(uint64_t c: s.scoreBins) peak = std::max(peak, c);
+    std::fprintf(f, "score histogram\n");
+    for(size_t i=0;i<s.scoreBins.size();i++){
+        if(!s.scoreBins[i]) continue;
+        int bar = peak ? (int)(s.scoreBins[i] * 50 / peak) : 0;
+        std::fprintf(f, "  %6d-%-6d %10llu |", (int)i * q.bucket, (int)(i + 1) * q.bucket - 1, (unsigned long long)s.scoreBins[i]);
+        for(int b=0;b<bar;b++) std::fputc('#', f);
+        std::fputc('\n', f);
+    }
+}
@@ -0,0 +1,91 @@
+// ------------------------------------------------------------------
+// File: trex_runlog.h
+// One-pass analytics over trex_runs.log ("YYYY-MM-DD HH:MM:SS, score")
+// ------------------------------------------------------------------
+//  - the log is memory-mapped and cut into line-aligned chunks that
+//    worker threads parse independently; per-thread totals are merged
+//  - per day: runs, mean, min/max and a log-bucketed score histogram
+//    (exact below 128, within 1/64 above) for percentiles; weeks are
+//    merged from days
+//  - optional sidecar index (<log>.idx): byte offset + count of every
+//    run of same-day lines, so a date-range query only parses those
+//    bytes, and a re-run only parses what was appended since; an index
+//    whose first/last covered lines no longer match the log is rebuilt
+// ------------------------------------------------------------------
+#ifndef TREX_RUNLOG_H
+#define TREX_RUNLOG_H
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+// Days since 1970-01-01 (proleptic Gregorian), no time zone involved.
+int32_t DayNumber(int y, int m, int d);
+void    DayToDate(int32_t day, int& y, int& m, int& d);
+// "YYYY-MM-DD" -> day number; false if malformed
+bool    ParseDate(const char* s, int32_t& day);
+
+// Score histogram with ~1.5% relative resolution and a fixed size.
+struct LogHist {
+    static const int SUB = 64;
+    static const int BINS = 2 * SUB + 25 * SUB;
+    uint32_t bins[BINS] = {};
+
+    static int Index(uint32_t v);
+    static uint32_t Lower(int i);     // smallest value in bin i
+    void Add(uint32_t v){ bins[Index(v)]++; }
+    void Merge(const LogHist& o){ for(int i=0;i<BINS;i++) bins[i] += o.bins[i]; }
+    // p in [0,100], nearest rank, reported as the bin's lower bound
+    uint32_t Percentile(uint64_t total, double p) const;
+};
+
+struct PeriodStats {
+    uint64_t runs = 0;
+    int64_t  sum  = 0;
+    int      min  = INT_MAX, max = INT_MIN;
+    LogHist  hist;
+
+    void Add(int score);
+    void Merge(const PeriodStats& o);
+};
+
+struct TopRun {
+    int      score;
+    int32_t  day;
+    int32_t  second;        // of the day
+};
+
+struct RunLogQuery {
+    int32_t  from = INT_MIN, to = INT_MAX;   // day numbers, inclusive
+    unsigned threads = 0;                    // 0 = one per hardware thread
+    int      topK = 10;
+    int      bucket = 100;                   // width of the overall histogram bins
+    bool     useIndex = true;                // read <log>.idx if present
+    bool     writeIndex = false;             // create/extend <log>.idx
+};
+
+struct RunLogStats {
+    PeriodStats total;
+    std::map<int32_t, PeriodStats> days;
+    std::vector<uint64_t> scoreBins;         // width RunLogQuery::bucket
+    std::vector<TopRun>   top;               // best first
+    uint64_t badLines = 0;
+    uint64_t bytesParsed = 0, fileBytes = 0;
+    double   seconds = 0.0;
+    unsigned threads = 0;
+    bool     indexUsed = false, indexWritten = false;
+    bool     indexStale = false;             // didn't match the log; rebuilt
+    size_t   indexSegments = 0;
+};
+
+// False (with `err` set) if the log can't be opened/mapped.
+bool AnalyzeRunLog(const char* path, const RunLogQuery& q, RunLogStats& out, std::string& err);
+
+// days: print the per-day table; weeks: per-week (Monday first) table
+void PrintRunLogStats(std::FILE* f, const RunLogQuery& q, const RunLogStats& s, bool days, bool weeks);
+
+#endif
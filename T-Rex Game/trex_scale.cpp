@@ -0,0 +1,213 @@
+// ------------------------------------------------------------------
+// File: trex_scale.cpp
+// Fit rectangle, scaler tables and the resampling kernels
+// ------------------------------------------------------------------
+#include "trex_scale.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if !defined(TREX_SIMD_SCALAR) && defined(__AVX2__)
+  #define TREX_SCALE_AVX2 1
+  #define TREX_SCALE_SSE2 1
+  #include <immintrin.h>
+#elif !defined(TREX_SIMD_SCALAR) && (defined(__SSE2__) || defined(_M_X64))
+  #define TREX_SCALE_SSE2 1
+  #include <emmintrin.h>
+#endif
+
+const char* ScaleKernelName(){
+#if defined(TREX_SCALE_AVX2)
+    return "avx2";
+#elif defined(TREX_SCALE_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+const char* ScaleModeName(ScaleMode m){
+    return m == ScaleMode::Nearest ? "nearest" : "bilinear";
+}
+
+// ---------------- Layout -----------------------------
+IRect FitRect(int srcW, int srcH, int outW, int outH, ScaleMode m){
+    if(srcW <= 0 || srcH <= 0 || outW <= 0 || outH <= 0) return IRect{ 0, 0, 0, 0 };
+    int w, h, k = std::min(outW / srcW, outH / srcH);
+    if(m == ScaleMode::Nearest && k >= 1){ w = srcW * k; h = srcH * k; }
+    else if((long long)outW * srcH <= (long long)outH * srcW){
+        w = outW; h = std::max(1, (int)((long long)srcH * outW / srcW));
+    } else {
+        h = outH; w = std::max(1, (int)((long long)srcW * outH / srcH));
+    }
+    int l = (outW - w) / 2, t = (outH - h) / 2;
+    return IRect{ l, t, l + w, t + h };
+}
+
+// Output i of n samples source n of them at the pixel centre. Bilinear
+// weights are in 1/128ths; the last source pixel is reached as
+// (size-2, 128) so the pair read is always in range.
+static void BuildAxis(int srcN, int outN, ScaleMode m, std::vector<int>& idx, std::vector<uint16_t>& wt){
+    idx.resize((size_t)outN); wt.resize((size_t)outN);
+    for(int i=0;i<outN;i++){
+        if(m == ScaleMode::Nearest || srcN < 2){
+            idx[i] = std::min(srcN - 1, (int)(((long long)i * 2 + 1) * srcN / (2LL * outN)));
+            wt[i] = 0;
+            continue;
+        }
+        double pos = ((double)i + 0.5) * srcN / outN - 0.5;
+        pos = std::max(0.0, std::min((double)(srcN - 1), pos));
+        int i0 = (int)pos;
+        int w = (int)std::lround((pos - i0) * 128.0);
+        if(w == 128){ i0++; w = 0; }
+        if(i0 >= srcN - 1){ i0 = srcN - 2; w = 128; }
+        idx[i] = i0; wt[i] = (uint16_t)w;
+    }
+}
+
+void Scaler::Configure(int srcW, int srcH, int outW, int outH, ScaleMode m){
+    srcW_ = srcW; srcH_ = srcH; outW_ = outW; outH_ = outH; mode_ = m;
+    dest_ = FitRect(srcW, srcH, outW, outH, m);
+    ScaleMode taps = (srcW < 2 || srcH < 2) ? ScaleMode::Nearest : m;   // bilinear reads pairs
+    BuildAxis(srcW, dest_.r - dest_.l, taps, colSrc_, colW_);
+    BuildAxis(srcH, dest_.b - dest_.t, taps, rowSrc_, rowW_);
+    rowA_.assign(colSrc_.size(), 0u);
+    rowB_.assign(colSrc_.size(), 0u);
+}
+
+// Output columns/rows whose source taps overlap `dirty`. The tables are
+// monotonic, so each range is two binary searches.
+IRect Scaler::Affected(const IRect& dirty, int& x0, int& x1, int& y0, int& y1) const {
+    IRect d = Intersection(dirty, IRect{ 0, 0, srcW_, srcH_ });
+    if(d.Empty() || dest_.Empty()){ x0 = x1 = y0 = y1 = 0; return IRect{ 0, 0, 0, 0 }; }
+    int ext = mode_ == ScaleMode::Bilinear ? 1 : 0;    // also reads index + 1
+    x0 = (int)(std::lower_bound(colSrc_.begin(), colSrc_.end(), d.l - ext) - colSrc_.begin());
+    x1 = (int)(std::lower_bound(colSrc_.begin(), colSrc_.end(), d.r) - colSrc_.begin());
+    y0 = (int)(std::lower_bound(rowSrc_.begin(), rowSrc_.end(), d.t - ext) - rowSrc_.begin());
+    y1 = (int)(std::lower_bound(rowSrc_.begin(), rowSrc_.end(), d.b) - rowSrc_.begin());
+    return IRect{ dest_.l + x0, dest_.t + y0, dest_.l + x1, dest_.t + y1 };
+}
+
+// ---------------- Kernels ----------------------------
+// (a * (128 - w) + b * w + 64) >> 7 per byte; every path computes exactly this
+static inline uint32_t LerpPixel(uint32_t a, uint32_t b, uint32_t w){
+    uint32_t out = 0;
+    for(int s=0;s<32;s+=8){
+        uint32_t ca = (a >> s) & 0xFFu, cb = (b >> s) & 0xFFu;
+        out |= ((ca * (128u - w) + cb * w + 64u) >> 7) << s;
+    }
+    return out;
+}
+
+static void HorizontalScalar(const uint32_t* s, const int* col, const uint16_t* w, uint32_t* out, int from, int n){
+    for(int i=from;i<n;i++) out[i] = LerpPixel(s[col[i]], s[col[i] + 1], w[i]);
+}
+
+static void VerticalScalar(const uint32_t* a, const uint32_t* b, uint32_t w, uint32_t* out, int from, int n){
+    for(int i=from;i<n;i++) out[i] = LerpPixel(a[i], b[i], w);
+}
+
+#if defined(TREX_SCALE_SSE2)
+static inline __m128i Lerp16(__m128i a, __m128i b, __m128i w){
+    __m128i inv = _mm_sub_epi16(_mm_set1_epi16(128), w);
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(a, inv), _mm_mullo_epi16(b, w));
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(64)), 7);
+}
+#endif
+
+// Two output pixels per step: both tap pairs are 8-byte loads
+static void Horizontal(const uint32_t* s, const int* col, const uint16_t* w, uint32_t* out, int n){
+    int i = 0;
+#if defined(TREX_SCALE_SSE2)
+    const __m128i z = _mm_setzero_si128();
+    for(; i + 2 <= n; i += 2){
+        __m128i p = _mm_loadl_epi64((const __m128i*)(s + col[i]));
+        __m128i q = _mm_loadl_epi64((const __m128i*)(s + col[i + 1]));
+        __m128i lr = _mm_shuffle_epi32(_mm_unpacklo_epi64(p, q), _MM_SHUFFLE(3, 1, 2, 0));   // p0 q0 p1 q1
+        short wp = (short)w[i], wq = (short)w[i + 1];
+        __m128i wv = _mm_set_epi16(wq, wq, wq, wq, wp, wp, wp, wp);
+        __m128i r = Lerp16(_mm_unpacklo_epi8(lr, z), _mm_unpackhi_epi8(lr, z), wv);
+        _mm_storel_epi64((__m128i*)(out + i), _mm_packus_epi16(r, r));
+    }
+#endif
+    HorizontalScalar(s, col, w, out, i, n);
+}
+
+static void Vertical(const uint32_t* a, const uint32_t* b, uint32_t w, uint32_t* out, int n){
+    int i = 0;
+#if defined(TREX_SCALE_AVX2)
+    const __m256i z8 = _mm256_setzero_si256(), w8 = _mm256_set1_epi16((short)w);
+    const __m256i inv8 = _mm256_set1_epi16((short)(128 - w)), r8 = _mm256_set1_epi16(64);
+    for(; i + 8 <= n; i += 8){
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i)), vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(va, z8), inv8),
+                                      _mm256_mullo_epi16(_mm256_unpacklo_epi8(vb, z8), w8));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(va, z8), inv8),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(vb, z8), w8));
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, r8), 7);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, r8), 7);
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_packus_epi16(lo, hi));
+    }
+#endif
+#if defined(TREX_SCALE_SSE2)
+    const __m128i z = _mm_setzero_si128(), wv = _mm_set1_epi16((short)w);
+    for(; i + 4 <= n; i += 4){
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i)), vb = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i lo = Lerp16(_mm_unpacklo_epi8(va, z), _mm_unpacklo_epi8(vb, z), wv);
+        __m128i hi = Lerp16(_mm_unpackhi_epi8(va, z), _mm_unpackhi_epi8(vb, z), wv);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    VerticalScalar(a, b, w, out, i, n);
+}
+
+// ---------------- Run --------------------------------
+IRect Scaler::Resample(const Framebuffer& src, Framebuffer& out, const IRect& dirty, bool simd){
+    int x0, x1, y0, y1;
+    IRect o = Affected(dirty, x0, x1, y0, y1);
+    if(o.Empty() || src.w != srcW_ || src.h != srcH_ || out.w != outW_ || out.h != outH_) return IRect{ 0, 0, 0, 0 };
+    int n = x1 - x0;
+    const int* col = colSrc_.data() + x0;
+    const uint16_t* cw = colW_.data() + x0;
+
+    if(mode_ == ScaleMode::Nearest || srcW_ < 2 || srcH_ < 2){
+        const uint32_t* prev = nullptr;
+        for(int y=y0;y<y1;y++){
+            uint32_t* d = out.Row(dest_.t + y) + o.l;
+            if(prev && rowSrc_[y] == rowSrc_[y - 1]) std::memcpy(d, prev, (size_t)n * sizeof(uint32_t));
+            else { const uint32_t* s = src.Row(rowSrc_[y]); for(int i=0;i<n;i++) d[i] = s[col[i]]; }
+            prev = d;
+        }
+        return o;
+    }
+
+    // rowA_/rowB_ hold source rows haveA/haveB resampled across [x0, x1)
+    int haveA = -1, haveB = -1;
+    uint32_t* A = rowA_.data();
+    uint32_t* B = rowB_.data();
+    for(int y=y0;y<y1;y++){
+        int sy = rowSrc_[y];
+        if(haveA != sy){
+            if(haveB == sy){ std::swap(A, B); haveA = sy; haveB = -1; }
+            else {
+                if(simd) Horizontal(src.Row(sy), col, cw, A, n); else HorizontalScalar(src.Row(sy), col, cw, A, 0, n);
+                haveA = sy;
+            }
+        }
+        if(haveB != sy + 1){
+            if(simd) Horizontal(src.Row(sy + 1), col, cw, B, n); else HorizontalScalar(src.Row(sy + 1), col, cw, B, 0, n);
+            haveB = sy + 1;
+        }
+        uint32_t* d = out.Row(dest_.t + y) + o.l;
+        if(simd) Vertical(A, B, rowW_[y], d, n); else VerticalScalar(A, B, rowW_[y], d, 0, n);
+    }
+    return o;
+}
+
+IRect Scaler::Run(const Framebuffer& src, Framebuffer& out, const IRect& dirty){
+    return Resample(src, out, dirty, true);
+}
+
+IRect Scaler::RunScalar(const Framebuffer& src, Framebuffer& out, const IRect& dirty){
+    return Resample(src, out, dirty, false);
+}
@@ -0,0 +1,69 @@
+// ------------------------------------------------------------------
+// File: trex_scale.h
+// Output scaler: logical framebuffer -> window-sized framebuffer
+// ------------------------------------------------------------------
+//  - the scene is always rendered at W_WIDTH x W_HEIGHT; the Scaler
+//    resamples it into a buffer of the window's size, letterboxed to
+//    keep the aspect ratio, so a big monitor costs one resample pass
+//    and not a native-resolution render
+//  - Nearest: the largest integer factor that fits (crisp pixels),
+//    plain aspect fit when the window is smaller than the logical size
+//  - Bilinear: aspect fit; separable, 7-bit fixed-point weights. Each
+//    source row is resampled horizontally once and cached, then pairs of
+//    rows are blended vertically (AVX2 / SSE2 / scalar, bit-identical)
+//  - per-column and per-row source indices and weights are built in
+//    Configure(), so Run() does no allocation and no division
+//  - Run() takes a dirty rectangle of the source and rescales only the
+//    output pixels that depend on it, which keeps damage-tracked frames
+//    cheap at 4K
+// ------------------------------------------------------------------
+#ifndef TREX_SCALE_H
+#define TREX_SCALE_H
+
+#include "trex_draw.h"
+#include "trex_fb.h"
+#include <cstdint>
+#include <vector>
+
+enum class ScaleMode : uint8_t { Nearest, Bilinear };
+
+const char* ScaleModeName(ScaleMode m);
+
+// Where a srcW x srcH image lands inside outW x outH for mode m
+IRect FitRect(int srcW, int srcH, int outW, int outH, ScaleMode m);
+
+class Scaler {
+public:
+    // Builds the tables for src -> out; the image goes to FitRect().
+    void Configure(int srcW, int srcH, int outW, int outH, ScaleMode m);
+    bool Matches(int srcW, int srcH, int outW, int outH, ScaleMode m) const {
+        return srcW == srcW_ && srcH == srcH_ && outW == outW_ && outH == outH_ && m == mode_;
+    }
+
+    ScaleMode    Mode() const { return mode_; }
+    const IRect& Dest() const { return dest_; }
+
+    // Rescales into `out` (sized outW x outH) every output pixel that
+    // reads from source rectangle `dirty`; returns that output rectangle.
+    // Pixels outside Dest() are never written.
+    IRect Run(const Framebuffer& src, Framebuffer& out, const IRect& dirty);
+    IRect RunScalar(const Framebuffer& src, Framebuffer& out, const IRect& dirty);
+
+private:
+    IRect Affected(const IRect& dirty, int& x0, int& x1, int& y0, int& y1) const;
+    IRect Resample(const Framebuffer& src, Framebuffer& out, const IRect& dirty, bool simd);
+
+    int       srcW_ = 0, srcH_ = 0, outW_ = 0, outH_ = 0;
+    ScaleMode mode_ = ScaleMode::Nearest;
+    IRect     dest_{ 0, 0, 0, 0 };
+    // Per output column / row of Dest(): first source index and the
+    // weight (0..128) of the next one; Nearest uses the index only
+    std::vector<int>      colSrc_, rowSrc_;
+    std::vector<uint16_t> colW_, rowW_;
+    std::vector<uint32_t> rowA_, rowB_;   // horizontally resampled source rows
+};
+
+// Name of the kernel set Run() compiled to ("avx2", "sse2", "scalar")
+const char* ScaleKernelName();
+
+#endif
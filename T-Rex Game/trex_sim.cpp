@@ -0,0 +1,196 @@
+// ------------------------------------------------------------------
+// File: trex_sim.cpp
+// Game rules for T-Rex: spawning, physics, scoring, collision
+// ------------------------------------------------------------------
+#include "trex_sim.h"
+#include "trex_stream.h"
+#include <algorithm>
+#include <cmath>
+
+// ---------------- Utilities --------------------------
+static float frand(World& w, float a, float b){ return w.rng.uniform(a,b); }
+
+void ResetWorld(World& w, uint64_t seed, uint64_t stream){
+    w.rng.seed(seed, stream);
+    w.obs.clear();
+    w.clouds.clear();
+
+    // Dino position
+    float groundY = (float)(W_HEIGHT - GROUND_H);
+    w.dino.x = 80.0f; w.dino.y = groundY - 52.0f; // standing height baseline
+    w.dino.vy = 0.0f; w.dino.onGround = true; w.dino.duck=false; w.dino.blink=0;
+
+    // Clouds
+    for(int i=0;i<6;i++){
+        w.clouds.push_back({ frand(w, 0, (float)W_WIDTH), frand(w, 30, 120.0f), frand(w, 10.0f, 24.0f) });
+    }
+
+    w.worldSpd = w.tune.baseSpd;
+    w.spawnGapMin = w.tune.gapMin; w.spawnGapMax = w.tune.gapMax;
+    w.spawnTimer = 0.0f; w.nextSpawnIn = frand(w, w.spawnGapMin, w.spawnGapMax);
+    w.score = 0;
+    w.ticks = 0;
+    w.distance = 0.0;
+    w.spawned = 0;
+    w.killer = ObType::CactusSmall;
+}
+
+// Obstacle factory: the score picks a tier, one draw picks the type
+Obstacle MakeObstacle(World& w){
+    float groundY = (float)(W_HEIGHT - GROUND_H);
+    const SpawnTable& st = *w.spawn;
+    ObType t = SpawnTable::Sample(st.Tier(w.score), w.rng.next());
+    const ObArchetype& a = st.arch[(int)t];
+
+    Obstacle o; o.type = t; o.anim=0; o.x = (float)W_WIDTH + frand(w, 0, 40);
+    o.w = a.w; o.h = a.h; o.y = groundY - a.lift - o.h;
+    o.speed = w.worldSpd * a.speedMul;
+    return o;
+}
+
+// --------------- Game update & logic -----------------
+void SpawnIfNeeded(World& w, float dt){
+    if(w.feed){
+        // rolled by these same rules on the generator's shadow World
+        size_t n = 0;
+        const StreamEvent* e = w.feed->At(w.ticks, n);
+        for(size_t i=0;i<n && !w.obs.full();i++){ w.obs.push_back(e[i].o); w.spawned++; }
+        return;
+    }
+    w.spawnTimer += dt;
+    if(w.spawnTimer >= w.nextSpawnIn){
+        w.spawnTimer = 0.0f;
+        w.nextSpawnIn = frand(w, w.spawnGapMin, w.spawnGapMax);
+        // Prevent unfair overlaps: ensure last obstacle is far enough
+        if(w.obs.full()) return;                // never grow mid-run
+        if(w.obs.empty() || (W_WIDTH - w.obs.back().x) > 40.0f){
+            w.obs.push_back(MakeObstacle(w));
+            w.spawned++;
+        }
+    }
+}
+
+void StepDino(Dino& d, float dt){
+    float groundY = (float)(W_HEIGHT - GROUND_H);
+    if(!d.onGround){
+        d.vy += GRAVITY * dt;
+        d.y  += d.vy * dt;
+        if(d.y >= groundY - 52.0f){
+            d.y = groundY - 52.0f; d.vy = 0.0f; d.onGround = true;
+        }
+    }
+}
+
+bool UpdateGame(World& w, float dt){
+    bool died = false;
+    w.ticks++;
+
+    // Difficulty ramp: every 100 score, speed increases, spawn gap shrinks
+    const Tuning& t = w.tune;
+    float tSpeed = t.baseSpd + std::min(t.speedCap, (float)w.score * t.speedPerScore);
+    w.worldSpd = tSpeed;
+    w.distance += (double)(w.worldSpd * dt);
+    w.spawnGapMin = std::max(t.gapMinFloor, t.gapMin - (float)w.score * t.gapShrink);
+    w.spawnGapMax = std::max(t.gapMaxFloor, t.gapMax - (float)w.score * t.gapShrink);
+
+    // Dino physics
+    Dino& d = w.dino;
+    StepDino(d, dt);
+
+    // Clouds (parallax)
+    for(auto &c: w.clouds){
+        c.x -= c.speed * dt;
+        if(c.x < -80) { c.x = (float)W_WIDTH + frand(w, 0, 140); c.y = frand(w, 30, 130); c.speed = frand(w, 10.0f, 24.0f);}    }
+
+    // Obstacles: move, animate and hit-test in place, then retire from the
+    // head. Spawn order is left-to-right except for a boulder overtaking
+    // near the left edge; anything offscreen is skipped until it reaches
+    // the head. New spawns appear at the right edge, nowhere near the dino,
+    // so testing before SpawnIfNeeded finds the same first hit as after it.
+    RectF dbox = d.bbox();
+    bool hit = false;
+    ObType hitType{};
+    for(auto &o: w.obs){
+        float s = (o.type==ObType::Boulder) ? o.speed : w.worldSpd;
+        o.x -= s * dt;
+        if(o.type==ObType::BirdLow || o.type==ObType::BirdHigh) o.anim++;
+        if(o.x + o.w < -8) continue;            // offscreen
+        if(!hit && Intersect(dbox, RectF{ o.x, o.y, o.w, o.h })){ hit = true; hitType = o.type; }
+    }
+    while(!w.obs.empty() && w.obs.front().x + w.obs.front().w < -8) w.obs.pop_front();
+
+    // Spawn new ones
+    SpawnIfNeeded(w, dt);
+
+    // Score
+    w.score += (int)std::round(40.0f * dt); // tweak rate
+
+    // Collision
+    if(hit){
+        d.blink = 14; // flash frames
+        w.state = GameState::GAMEOVER;
+        w.killer = hitType;
+        died = true;
+    }
+
+    if(d.blink>0) d.blink--;
+    return died;
+}
+
+// -------------------- Input --------------------------
+void StartJump(Dino& d){
+    if(d.onGround){ d.onGround=false; d.vy = -JUMP_VEL; }
+}
+
+void DoJump(World& w){
+    if(w.state==GameState::MENU){ w.state=GameState::PLAYING; }
+    if(w.state==GameState::PLAYING) StartJump(w.dino);
+}
+
+void SetDuck(World& w, bool down){
+    if(w.state==GameState::PLAYING){ w.dino.duck = down && w.dino.onGround; }
+}
+
+void ApplyInput(World& w, const TickInput& in){
+    if(in.jump) DoJump(w);
+    SetDuck(w, in.duck);
+}
+
+// ------------------- Headless runs -------------------
+EpisodeResult RunEpisode(World& w, uint64_t seed, uint64_t stream, const InputFn& input, uint32_t maxTicks){
+    ResetWorld(w, seed, stream);
+    w.state = GameState::PLAYING;
+    bool died = false;
+    while(!died && w.ticks < maxTicks){
+        if(input) ApplyInput(w, input(w));
+        died = UpdateGame(w, DT);
+    }
+    return EpisodeResult{ w.score, w.ticks, w.killer, died };
+}
+
+TickInput ReflexPolicy(const World& w){
+    TickInput in{ false, false };
+    const Dino& d = w.dino;
+    float front = d.x + 44.0f;
+    for(const auto &o: w.obs){
+        if(o.x + o.w < d.x) continue;             // already behind us
+        if(o.type==ObType::BirdHigh) break;       // passes over a standing dino
+        float spd = (o.type==ObType::Boulder) ? o.speed : w.worldSpd;
+        float lead = spd * 0.14f + 6.0f;          // take off a little before contact
+        if(o.x - front < lead) in.jump = true;
+        break;
+    }
+    return in;
+}
+
+const char* ObTypeName(ObType t){
+    switch(t){
+        case ObType::CactusSmall:  return "CactusSmall";
+        case ObType::CactusLarge:  return "CactusLarge";
+        case ObType::CactusDouble: return "CactusDouble";
+        case ObType::BirdLow:      return "BirdLow";
+        case ObType::BirdHigh:     return "BirdHigh";
+        case ObType::Boulder:      return "Boulder";
+    }
+    return "?";
+}
@@ -0,0 +1,160 @@
+// ------------------------------------------------------------------
+// File: trex_sim.h
+// Portable T-Rex simulation core (no Win32, no GDI, no timers)
+// ------------------------------------------------------------------
+//  - World holds every piece of mutable game state, including the RNG
+//  - ResetWorld() takes an explicit seed + stream; nothing reads random_device
+//  - Difficulty ramp constants live in Tuning so tools can sweep them;
+//    obstacle shapes and odds in a SpawnTable (trex_spawn.h)
+//  - UpdateGame() advances one fixed step and reports a game over;
+//    saving scores is left to the caller (main.cpp / trex_cli.cpp)
+//  - with World::feed set, obstacles come from a pre-validated stream
+//    (trex_stream.h) instead of SpawnIfNeeded's own dice
+// ------------------------------------------------------------------
+#ifndef TREX_SIM_H
+#define TREX_SIM_H
+
+#include "trex_ring.h"
+#include "trex_spawn.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// ----------------------- Config -----------------------
+static const int   W_WIDTH   = 900;
+static const int   W_HEIGHT  = 360;
+static const int   GROUND_H  = 64;     // ground strip height
+static const int   FPS       = 60;     // target frames per second
+static const float DT        = 1.0f / FPS;
+static const float GRAVITY   = 2200.0f;  // px/s^2
+static const float JUMP_VEL  = 760.0f;   // px/s
+static const float BASE_SPD  = 360.0f;   // world scroll speed px/s
+static const int   OBS_CAPACITY   = 32;  // live obstacles (a screen holds < 10)
+static const int   CLOUD_CAPACITY = 8;
+
+// ----------------------- Types ------------------------
+enum class GameState { MENU, PLAYING, GAMEOVER };
+
+struct RectF { float x, y, w, h; };
+static inline bool Intersect(const RectF&a, const RectF&b){
+    return !(a.x + a.w < b.x || b.x + b.w < a.x || a.y + a.h < b.y || b.y + b.h < a.y);
+}
+
+struct Obstacle {
+    ObType type{};
+    float x{}, y{}, w{}, h{}, speed{};
+    int anim{0}; // for birds
+};
+
+struct Cloud { float x, y, speed; };
+
+struct Dino {
+    float x{}, y{};     // top‑left position
+    float vy{};         // vertical velocity
+    bool onGround{true};
+    bool duck{false};
+    int  blink{0};      // hit flash
+
+    RectF bbox() const {
+        float bw = 44.0f;
+        float bh = duck ? 28.0f : 48.0f;
+        return RectF{ x, y + (duck ? 20.0f : 0.0f), bw, bh };
+    }
+};
+
+// PCG32 (O'Neill). Small state, and every (seed, stream) pair gives an
+// independent sequence, so parallel runs never share a generator.
+struct Pcg32 {
+    uint64_t state = 0x853c49e6748fea9bULL;
+    uint64_t inc   = 0xda3e39cb94b95bdbULL;
+
+    void seed(uint64_t initstate, uint64_t stream = 0){
+        state = 0; inc = (stream << 1u) | 1u;
+        next(); state += initstate; next();
+    }
+    uint32_t next(){
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        uint32_t xs  = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+        uint32_t rot = (uint32_t)(old >> 59u);
+        return (xs >> rot) | (xs << ((0u - rot) & 31u));
+    }
+    // [a,b) float and [a,b] int; same results on every compiler/stdlib
+    float uniform(float a, float b){ return a + (b - a) * ((float)(next() >> 8) * (1.0f / 16777216.0f)); }
+    int   range(int a, int b){ return a + (int)(((uint64_t)next() * (uint64_t)(uint32_t)(b - a + 1)) >> 32); }
+};
+
+// Difficulty ramp. Defaults are the hand-tuned values the game shipped with.
+struct Tuning {
+    float baseSpd       = BASE_SPD;  // scroll speed at score 0
+    float speedPerScore = 0.8f;      // px/s gained per point
+    float speedCap      = 280.0f;    // max px/s added on top of baseSpd
+    float gapMin        = 0.85f;     // spawn gap range at score 0 (s)
+    float gapMax        = 1.85f;
+    float gapShrink     = 0.0009f;   // s removed from both ends per point
+    float gapMinFloor   = 0.55f;
+    float gapMaxFloor   = 0.95f;
+};
+
+class SpawnFeed;   // trex_stream.h
+
+// Everything UpdateGame touches. Copying a World forks the run.
+// Entity rings are sized once here; play itself never allocates.
+struct World {
+    World() : obs(OBS_CAPACITY), clouds(CLOUD_CAPACITY) {}
+
+    GameState state = GameState::MENU;
+    Dino dino;
+    Ring<Obstacle> obs;           // spawn order, oldest first
+    Ring<Cloud>    clouds;
+    Pcg32                 rng;
+    Tuning                tune;     // kept across ResetWorld
+    const SpawnTable*     spawn = &DEFAULT_SPAWN_TABLE;   // likewise
+    const SpawnFeed*      feed = nullptr;   // likewise; null = roll obstacles here
+
+    float worldSpd = BASE_SPD;
+    float spawnTimer = 0.0f;
+    float spawnGapMin = 0.85f, spawnGapMax = 1.85f; // seconds
+    float nextSpawnIn = 1.0f;
+    double distance = 0.0;    // px the ground has scrolled since ResetWorld (drawing only)
+
+    int      score = 0;       // integer score (meters)
+    uint32_t ticks = 0;       // fixed steps since ResetWorld
+    uint32_t spawned = 0;     // obstacles spawned since ResetWorld
+    ObType   killer{};        // what ended the run (valid in GAMEOVER)
+};
+
+// Per‑tick input, as the keyboard/mouse would have produced it.
+struct TickInput { bool jump; bool duck; };
+typedef std::function<TickInput(const World&)> InputFn;
+
+// ------------------- Simulation ----------------------
+void     ResetWorld(World& w, uint64_t seed, uint64_t stream = 0);
+Obstacle MakeObstacle(World& w);
+void     SpawnIfNeeded(World& w, float dt);
+bool     UpdateGame(World& w, float dt);   // true if this step ended the run
+void     StepDino(Dino& d, float dt);      // gravity + landing, as UpdateGame does
+void     StartJump(Dino& d);               // takes off if on the ground, as DoJump does
+
+void DoJump(World& w);
+void SetDuck(World& w, bool down);
+void ApplyInput(World& w, const TickInput& in);
+
+// ------------------- Headless runs -------------------
+struct EpisodeResult {
+    int      score;
+    uint32_t ticks;
+    ObType   killer;
+    bool     died;      // false if maxTicks was reached first
+};
+
+// Reset with (seed, stream), start playing and step at DT until death or maxTicks.
+EpisodeResult RunEpisode(World& w, uint64_t seed, uint64_t stream, const InputFn& input, uint32_t maxTicks);
+
+// Simple look‑at‑the‑next‑obstacle policy used by the CLI driver.
+TickInput ReflexPolicy(const World& w);
+
+const char* ObTypeName(ObType t);
+
+#endif
@@ -0,0 +1,140 @@
+// ------------------------------------------------------------------
+// File: trex_simthread.cpp
+// SimThread: step scheduling, input application, snapshot publishing
+// ------------------------------------------------------------------
+#include "trex_simthread.h"
+#include "trex_alloc.h"
+#include <algorithm>
+#include <chrono>
+
+// ---------------- Lifecycle --------------------------
+void SimThread::Start(const SimSetup& setup){
+    Stop();
+    fair_ = setup.fairStream;
+    scores_ = setup.scores;
+    highScore_ = setup.highScore;
+    top5_ = setup.top5;
+    top5_.reserve(5);
+    world_.spawn = setup.spawn;
+    world_.feed = fair_ ? &feed_ : nullptr;
+    world_.state = GameState::MENU;
+    step_ = 0; run_ = 0;
+    hasPending_ = false;
+    SimInput stale;
+    while(inputs_.TryPop(stale)) {}
+    NewRun(setup.seed);
+
+    uint64_t start = clock_.Now();
+    Publish(start);
+    stop_ = false;
+    thread_ = std::thread(&SimThread::Run, this, start);
+}
+
+void SimThread::Stop(){
+    if(!thread_.joinable()) return;
+    stop_ = true;
+    thread_.join();
+    stream_.Stop();
+}
+
+bool SimThread::Post(SimInputKind k, uint64_t seed){
+    SimInput in;
+    in.at = clock_.Now(); in.kind = k; in.seed = seed;
+    return Post(in);
+}
+
+bool SimThread::Post(const SimInput& in){
+    if(inputs_.TryPush(in)) return true;
+    stats_.dropped++;
+    return false;
+}
+
+// ---------------- Simulation thread ------------------
+void SimThread::NewRun(uint64_t seed){
+    ResetWorld(world_, seed);
+    feed_.Clear();
+    if(fair_) stream_.Start(seed, world_.tune, world_.spawn);
+    rec_.Begin(world_, seed);
+    run_++;
+}
+
+void SimThread::Apply(const SimInput& in){
+    switch(in.kind){
+    case SimInputKind::Jump:     rec_.Jump(world_); break;
+    case SimInputKind::DuckDown: rec_.Duck(world_, true); break;
+    case SimInputKind::DuckUp:   rec_.Duck(world_, false); break;
+    case SimInputKind::Restart:  world_.state = GameState::PLAYING; NewRun(in.seed); break;
+    }
+    stats_.inputs++;
+}
+
+void SimThread::Step(uint64_t due){
+    AllocScope heap;
+    bool restarted = false;
+    for(;;){
+        if(!hasPending_){
+            if(!inputs_.TryPop(pending_)) break;
+            hasPending_ = true;
+        }
+        if(pending_.at > due) break;
+        restarted |= pending_.kind == SimInputKind::Restart;
+        Apply(pending_);
+        hasPending_ = false;
+    }
+    if(world_.state==GameState::PLAYING){
+        if(fair_) stream_.Feed(feed_, world_.ticks + 1);
+        if(UpdateGame(world_, DT)){
+            // game over: scores here, files on the ScoreWriter thread
+            int score = world_.score;
+            if(score > highScore_) highScore_ = score;
+            InsertTop5(top5_, score);
+            if(scores_) scores_->Push(score, new RunRecording(rec_.Finish(world_)));
+        }
+        else if(!restarted && heap.Delta().Calls()) stats_.allocSteps++;
+    }
+    step_++;
+    Publish(due);
+}
+
+void SimThread::Publish(uint64_t due){
+    SimSnapshot& s = snaps_.Back();
+    SaveWorld(world_, s.world);
+    s.checksum = WorldChecksum(s.world);
+    s.highScore = highScore_;
+    s.top5Count = (uint32_t)std::min<size_t>(top5_.size(), 5);
+    for(uint32_t i=0;i<s.top5Count;i++) s.top5[i] = top5_[i];
+    s.step = step_; s.run = run_; s.dueAt = due;
+    snaps_.Publish();
+}
+
+// Step k is due at start + k * f / FPS. Sleeps until about a millisecond
+// before that, then yields; a late thread runs the missed steps back to
+// back, so the step count always matches elapsed time.
+void SimThread::Run(uint64_t start){
+    const uint64_t f = clock_.Frequency();
+    const uint64_t maxLag = (uint64_t)(SIM_MAX_LAG * (double)f);
+    const uint64_t ms = f / 1000;
+    uint64_t k = 1;
+    while(!stop_.load(std::memory_order_relaxed)){
+        uint64_t due = start + k * f / FPS;
+        uint64_t now = clock_.Now();
+        if(now < due){
+            uint64_t left = due - now;
+            if(left > 2 * ms) std::this_thread::sleep_for(std::chrono::microseconds((left - ms) * 1000000ull / f));
+            else std::this_thread::yield();
+            continue;
+        }
+        uint64_t lag = now - due;
+        if(lag > maxLag){
+            stats_.resyncs++;
+            start = now - k * f / FPS;        // this step is due now
+            due = now; lag = 0;
+        }
+        uint64_t lateUs = lag * 1000000ull / f;
+        if(lateUs > stats_.maxLateUs.load(std::memory_order_relaxed)) stats_.maxLateUs = lateUs;
+        if(lag * FPS > f) stats_.late++;
+        Step(due);
+        stats_.steps++;
+        k++;
+    }
+}
@@ -0,0 +1,128 @@
+// ------------------------------------------------------------------
+// File: trex_simthread.h
+// Fixed-step simulation on its own thread, snapshots out, inputs in
+// ------------------------------------------------------------------
+//  - SimThread owns the World, the input recorder, the obstacle stream
+//    and the score bookkeeping; nothing else touches them while it runs
+//  - step k is due at start + k * DT on the Clock (absolute, not an
+//    accumulator), so a slow frame on the UI thread never changes the
+//    simulation rate; a thread that falls more than SIM_MAX_LAG behind
+//    (suspend, debugger) re-bases instead of replaying the gap
+//  - after every step the whole state is published as a SimSnapshot (a
+//    WorldSnapshot plus scores) through a TripleBuffer; the UI thread
+//    renders the latest one and never waits for the simulation
+//  - inputs travel through an SpscQueue stamped with Clock time; each
+//    is applied at the first step due at or after its stamp, so input
+//    timing doesn't depend on when the UI thread got to run
+// ------------------------------------------------------------------
+#ifndef TREX_SIMTHREAD_H
+#define TREX_SIMTHREAD_H
+
+#include "trex_sim.h"
+#include "trex_rollback.h"
+#include "trex_replay.h"
+#include "trex_stream.h"
+#include "trex_persist.h"
+#include "trex_pacing.h"
+#include "trex_spsc.h"
+#include "trex_triple.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+static const double SIM_MAX_LAG = 0.25;   // seconds behind before re-basing
+
+enum class SimInputKind : uint8_t { Jump, DuckDown, DuckUp, Restart };
+
+struct SimInput {
+    uint64_t     at;       // Clock ticks when it happened
+    SimInputKind kind;
+    uint64_t     seed;     // Restart: seed of the new run
+};
+
+// Everything the UI draws from. Pointers inside `world` belong to the
+// simulation and are not for the reader.
+struct SimSnapshot {
+    WorldSnapshot world;
+    uint32_t checksum;         // WorldChecksum(world), taken at publish
+    int      highScore;
+    int      top5[5];
+    uint32_t top5Count;
+    uint64_t step;             // fixed steps since Start()
+    uint64_t run;              // runs started since Start()
+    uint64_t dueAt;            // Clock ticks this step was scheduled for
+};
+static_assert(std::is_trivially_copyable<SimSnapshot>::value, "snapshots are copied as bytes");
+
+struct SimSetup {
+    uint64_t          seed = 1;
+    const SpawnTable* spawn = &DEFAULT_SPAWN_TABLE;
+    bool              fairStream = true;    // obstacles from a StreamWorker
+    ScoreWriter*      scores = nullptr;     // gets game overs + recordings
+    int               highScore = 0;
+    std::vector<int>  top5;
+};
+
+// Written by the simulation thread, readable from any thread.
+struct SimStats {
+    std::atomic<uint64_t> steps{0};
+    std::atomic<uint64_t> late{0};          // steps run more than one DT after they were due
+    std::atomic<uint64_t> maxLateUs{0};
+    std::atomic<uint64_t> resyncs{0};       // times SIM_MAX_LAG was exceeded
+    std::atomic<uint64_t> inputs{0};        // applied
+    std::atomic<uint64_t> dropped{0};       // Post() found the queue full
+    std::atomic<uint64_t> allocSteps{0};    // PLAYING steps that hit the heap (trex_alloc.h)
+};
+
+class SimThread {
+public:
+    explicit SimThread(Clock& clock) : clock_(clock) {}
+    ~SimThread(){ Stop(); }
+
+    // Starts a run in MENU and the thread; the first snapshot is out
+    // before this returns.
+    void Start(const SimSetup& setup);
+    void Stop();
+
+    // UI thread only. Stamped with the clock now; false if the queue is full.
+    bool Post(SimInputKind k, uint64_t seed = 0);
+    bool Post(const SimInput& in);
+
+    // UI thread only: newest snapshot, valid until the next call.
+    const SimSnapshot& Latest(){ return snaps_.Latest(); }
+
+    const SimStats& Stats() const { return stats_; }
+
+private:
+    SimThread(const SimThread&);
+    SimThread& operator=(const SimThread&);
+
+    void Run(uint64_t start);
+    void NewRun(uint64_t seed);
+    void Apply(const SimInput& in);
+    void Step(uint64_t due);
+    void Publish(uint64_t due);
+
+    Clock&        clock_;
+    World         world_;
+    InputRecorder rec_;
+    SpawnFeed     feed_;
+    StreamWorker  stream_;
+    bool          fair_ = true;
+    ScoreWriter*  scores_ = nullptr;
+    int           highScore_ = 0;
+    std::vector<int> top5_;
+    uint64_t      step_ = 0, run_ = 0;
+
+    SpscQueue<SimInput, 256> inputs_;
+    SimInput      pending_{};        // popped but due after the current step
+    bool          hasPending_ = false;
+    TripleBuffer<SimSnapshot> snaps_;
+
+    std::thread       thread_;
+    std::atomic<bool> stop_{false};
+    SimStats          stats_;
+};
+
+#endif
@@ -0,0 +1,157 @@
+// ------------------------------------------------------------------
+// File: trex_soa.cpp
+// ObstacleSoA kernels (AVX / SSE2 / scalar)
+// ------------------------------------------------------------------
+#include "trex_soa.h"
+#include "trex_bits.h"
+
+#if !defined(TREX_SIMD_SCALAR) && defined(__AVX__)
+  #define TREX_SOA_AVX 1
+  #include <immintrin.h>
+#elif !defined(TREX_SIMD_SCALAR) && (defined(__SSE2__) || defined(_M_X64))
+  #define TREX_SOA_SSE2 1
+  #include <emmintrin.h>
+#endif
+
+const char* SoaKernelName(){
+#if defined(TREX_SOA_AVX)
+    return "avx";
+#elif defined(TREX_SOA_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+// ---------------- Storage ----------------------------
+void ObstacleSoA::clear(){
+    x.clear(); y.clear(); w.clear(); h.clear();
+    speed.clear(); animStep.clear(); anim.clear(); type.clear();
+}
+
+void ObstacleSoA::reserve(size_t n){
+    x.reserve(n); y.reserve(n); w.reserve(n); h.reserve(n);
+    speed.reserve(n); animStep.reserve(n); anim.reserve(n); type.reserve(n);
+}
+
+void ObstacleSoA::push(const Obstacle& o){
+    bool bird = (o.type==ObType::BirdLow || o.type==ObType::BirdHigh);
+    x.push_back(o.x); y.push_back(o.y); w.push_back(o.w); h.push_back(o.h);
+    speed.push_back(o.type==ObType::Boulder ? o.speed : 0.0f);
+    animStep.push_back(bird ? 1 : 0);
+    anim.push_back(o.anim);
+    type.push_back((uint8_t)o.type);
+}
+
+Obstacle ObstacleSoA::get(size_t i) const {
+    Obstacle o;
+    o.type = (ObType)type[i];
+    o.x = x[i]; o.y = y[i]; o.w = w[i]; o.h = h[i];
+    o.speed = speed[i]; o.anim = anim[i];
+    return o;
+}
+
+// ---------------- Movement ---------------------------
+void ObstacleSoA::MoveScalar(float worldSpd, float dt){
+    size_t n = size();
+    for(size_t i=0;i<n;i++){
+        float s = speed[i] != 0.0f ? speed[i] : worldSpd;
+        x[i] -= s * dt;
+        anim[i] += animStep[i];
+    }
+}
+
+void ObstacleSoA::Move(float worldSpd, float dt){
+    size_t n = size(), i = 0;
+    float* px = x.data(); const float* ps = speed.data();
+    int32_t* pa = anim.data(); const int32_t* pst = animStep.data();
+#if defined(TREX_SOA_AVX)
+    __m256 vw = _mm256_set1_ps(worldSpd), vdt = _mm256_set1_ps(dt), zero = _mm256_setzero_ps();
+    for(; i + 8 <= n; i += 8){
+        __m256 s   = _mm256_loadu_ps(ps + i);
+        __m256 own = _mm256_cmp_ps(s, zero, _CMP_NEQ_OQ);
+        s = _mm256_blendv_ps(vw, s, own);
+        _mm256_storeu_ps(px + i, _mm256_sub_ps(_mm256_loadu_ps(px + i), _mm256_mul_ps(s, vdt)));
+    }
+    // AVX1 has no 256-bit integer add; anim goes four at a time
+    for(size_t j = 0; j + 4 <= i; j += 4){
+        __m128i a = _mm_loadu_si128((const __m128i*)(pa + j));
+        _mm_storeu_si128((__m128i*)(pa + j), _mm_add_epi32(a, _mm_loadu_si128((const __m128i*)(pst + j))));
+    }
+#elif defined(TREX_SOA_SSE2)
+    __m128 vw = _mm_set1_ps(worldSpd), vdt = _mm_set1_ps(dt), zero = _mm_setzero_ps();
+    for(; i + 4 <= n; i += 4){
+        __m128 s   = _mm_loadu_ps(ps + i);
+        __m128 own = _mm_cmpneq_ps(s, zero);
+        s = _mm_or_ps(_mm_and_ps(own, s), _mm_andnot_ps(own, vw));
+        _mm_storeu_ps(px + i, _mm_sub_ps(_mm_loadu_ps(px + i), _mm_mul_ps(s, vdt)));
+        __m128i a = _mm_loadu_si128((const __m128i*)(pa + i));
+        _mm_storeu_si128((__m128i*)(pa + i), _mm_add_epi32(a, _mm_loadu_si128((const __m128i*)(pst + i))));
+    }
+#endif
+    for(; i<n; i++){
+        float s = ps[i] != 0.0f ? ps[i] : worldSpd;
+        px[i] -= s * dt;
+        pa[i] += pst[i];
+    }
+}
+
+// ---------------- Collision --------------------------
+int ObstacleSoA::FirstHitScalar(const RectF& b) const {
+    size_t n = size();
+    for(size_t i=0;i<n;i++){
+        if(Intersect(b, RectF{ x[i], y[i], w[i], h[i] })) return (int)i;
+    }
+    return -1;
+}
+
+int ObstacleSoA::FirstHit(const RectF& b) const {
+    size_t n = size(), i = 0;
+    const float *px = x.data(), *py = y.data(), *pw = w.data(), *ph = h.data();
+#if defined(TREX_SOA_AVX)
+    __m256 bx = _mm256_set1_ps(b.x), by = _mm256_set1_ps(b.y);
+    __m256 bx2 = _mm256_set1_ps(b.x + b.w), by2 = _mm256_set1_ps(b.y + b.h);
+    for(; i + 8 <= n; i += 8){
+        __m256 ox = _mm256_loadu_ps(px + i), oy = _mm256_loadu_ps(py + i);
+        __m256 ox2 = _mm256_add_ps(ox, _mm256_loadu_ps(pw + i));
+        __m256 oy2 = _mm256_add_ps(oy, _mm256_loadu_ps(ph + i));
+        __m256 miss = _mm256_or_ps(
+            _mm256_or_ps(_mm256_cmp_ps(bx2, ox, _CMP_LT_OQ), _mm256_cmp_ps(ox2, bx, _CMP_LT_OQ)),
+            _mm256_or_ps(_mm256_cmp_ps(by2, oy, _CMP_LT_OQ), _mm256_cmp_ps(oy2, by, _CMP_LT_OQ)));
+        int hit = ~_mm256_movemask_ps(miss) & 0xFF;
+        if(hit) return (int)i + LowBit((unsigned)hit);
+    }
+#elif defined(TREX_SOA_SSE2)
+    __m128 bx = _mm_set1_ps(b.x), by = _mm_set1_ps(b.y);
+    __m128 bx2 = _mm_set1_ps(b.x + b.w), by2 = _mm_set1_ps(b.y + b.h);
+    for(; i + 4 <= n; i += 4){
+        __m128 ox = _mm_loadu_ps(px + i), oy = _mm_loadu_ps(py + i);
+        __m128 ox2 = _mm_add_ps(ox, _mm_loadu_ps(pw + i));
+        __m128 oy2 = _mm_add_ps(oy, _mm_loadu_ps(ph + i));
+        __m128 miss = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(bx2, ox), _mm_cmplt_ps(ox2, bx)),
+                                _mm_or_ps(_mm_cmplt_ps(by2, oy), _mm_cmplt_ps(oy2, by)));
+        int hit = ~_mm_movemask_ps(miss) & 0xF;
+        if(hit) return (int)i + LowBit((unsigned)hit);
+    }
+#endif
+    for(; i<n; i++){
+        if(Intersect(b, RectF{ px[i], py[i], pw[i], ph[i] })) return (int)i;
+    }
+    return -1;
+}
+
+// ---------------- Despawn ----------------------------
+void ObstacleSoA::Compact(float minRight){
+    size_t n = size(), out = 0;
+    // Most frames drop nothing; only read x/w until the first casualty
+    while(out < n && !(x[out] + w[out] < minRight)) out++;
+    if(out == n) return;
+    for(size_t i=out+1;i<n;i++){
+        if(x[i] + w[i] < minRight) continue;
+        x[out] = x[i]; y[out] = y[i]; w[out] = w[i]; h[out] = h[i];
+        speed[out] = speed[i]; animStep[out] = animStep[i]; anim[out] = anim[i]; type[out] = type[i];
+        out++;
+    }
+    x.resize(out); y.resize(out); w.resize(out); h.resize(out);
+    speed.resize(out); animStep.resize(out); anim.resize(out); type.resize(out);
+}
@@ -0,0 +1,49 @@
+// ------------------------------------------------------------------
+// File: trex_soa.h
+// Structure-of-arrays obstacle store with SIMD move / hit kernels
+// ------------------------------------------------------------------
+// Meant for the high entity counts of the headless tools; the normal
+// game (a handful of obstacles) keeps World::obs.
+//  - separate x/y/w/h/speed/type lanes, each a plain float/int array
+//  - Move() and FirstHit() use AVX or SSE2 when the compiler targets
+//    them, otherwise the scalar loops; define TREX_SIMD_SCALAR to force
+//    the scalar path
+//  - Compact() drops off-screen entries in place, keeping spawn order
+// ------------------------------------------------------------------
+#ifndef TREX_SOA_H
+#define TREX_SOA_H
+
+#include "trex_sim.h"
+#include <vector>
+
+class ObstacleSoA {
+public:
+    std::vector<float>   x, y, w, h;
+    std::vector<float>   speed;     // own speed for boulders, 0 = follow world
+    std::vector<int32_t> animStep;  // 1 for birds, 0 otherwise
+    std::vector<int32_t> anim;
+    std::vector<uint8_t> type;      // ObType
+
+    size_t size() const { return x.size(); }
+    bool   empty() const { return x.empty(); }
+    void   clear();
+    void   reserve(size_t n);
+    void   push(const Obstacle& o);
+    Obstacle get(size_t i) const;
+
+    // x -= (speed ? speed : worldSpd) * dt, anim += animStep
+    void Move(float worldSpd, float dt);
+    void MoveScalar(float worldSpd, float dt);
+
+    // Index of the first obstacle overlapping `box` (Intersect rules), or -1
+    int  FirstHit(const RectF& box) const;
+    int  FirstHitScalar(const RectF& box) const;
+
+    // Remove entries with x + w < minRight, preserving order
+    void Compact(float minRight = -8.0f);
+};
+
+// Name of the kernel set Move()/FirstHit() compiled to ("avx", "sse2", "scalar")
+const char* SoaKernelName();
+
+#endif
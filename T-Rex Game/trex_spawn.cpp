@@ -0,0 +1,121 @@
+// ------------------------------------------------------------------
+// File: trex_spawn.cpp
+// Shipped spawn table + trex_spawn.txt loader
+// ------------------------------------------------------------------
+#include "trex_spawn.h"
+#include "trex_sim.h"
+#include <cstdlib>
+#include <cstring>
+
+// ---------------- Shipped table ----------------------
+// Birds hover: the low one at knee height, the high one at head height.
+static constexpr ObArchetype DEFAULT_ARCHETYPES[OBTYPE_COUNT] = {
+    { 22.0f, 42.0f,  0.0f, 1.0f  },   // CactusSmall
+    { 34.0f, 72.0f,  0.0f, 1.0f  },   // CactusLarge
+    { 52.0f, 46.0f,  0.0f, 1.0f  },   // CactusDouble
+    { 44.0f, 26.0f, 24.0f, 1.0f  },   // BirdLow
+    { 44.0f, 26.0f, 88.0f, 1.0f  },   // BirdHigh
+    { 32.0f, 32.0f,  0.0f, 1.18f },   // Boulder
+};
+
+// Early on mostly cacti; birds and boulders unlock at 200.
+static constexpr SpawnTier DEFAULT_TIERS[] = {
+    {   0, { 50, 35, 15,  0,  0, 0 } },
+    { 200, { 30, 25, 15, 15, 10, 5 } },
+};
+static const int DEFAULT_TIER_COUNT = (int)(sizeof(DEFAULT_TIERS) / sizeof(DEFAULT_TIERS[0]));
+
+constexpr SpawnTable DEFAULT_SPAWN_TABLE = BakeSpawnTable(DEFAULT_ARCHETYPES, DEFAULT_TIERS, DEFAULT_TIER_COUNT);
+
+static_assert(DEFAULT_SPAWN_TABLE.tiers[0].fromScore == 0, "first tier must start at score 0");
+static_assert(DEFAULT_SPAWN_TABLE.tiers[0].cumulative[OBTYPE_COUNT - 1] == 100, "tier 0 weights are percentages");
+static_assert(DEFAULT_SPAWN_TABLE.tiers[1].cumulative[OBTYPE_COUNT - 1] == 100, "tier 1 weights are percentages");
+static_assert(DEFAULT_SPAWN_TABLE.tiers[0].threshold[(int)ObType::BirdLow] == 0, "no birds before 200");
+
+// ---------------- Override file ----------------------
+static const uint32_t MAX_WEIGHT = 1000000;   // keeps the alias maths in 64 bits
+
+static bool ParseType(const char* name, ObType& t){
+    for(int i=0;i<OBTYPE_COUNT;i++){
+        if(!std::strcmp(name, ObTypeName((ObType)i))){ t = (ObType)i; return true; }
+    }
+    return false;
+}
+
+bool LoadSpawnTable(const char* path, SpawnTable& out, std::FILE* err){
+    FILE* f = std::fopen(path, "r");
+    if(!f){ if(err) std::fprintf(err, "%s: cannot open\n", path); return false; }
+
+    ObArchetype arch[OBTYPE_COUNT];
+    for(int i=0;i<OBTYPE_COUNT;i++) arch[i] = DEFAULT_ARCHETYPES[i];
+    SpawnTier tiers[SPAWN_MAX_TIERS];
+    int count = 0;
+
+    char line[256];
+    int lineNo = 0;
+    const char* why = nullptr;
+    while(!why && std::fgets(line, sizeof(line), f)){
+        lineNo++;
+        char* hash = std::strchr(line, '#');
+        if(hash) *hash = '\0';
+        char kind[16], name[32];
+        if(std::sscanf(line, "%15s", kind) != 1) continue;      // blank
+        if(!std::strcmp(kind, "arch")){
+            ObArchetype a; ObType t;
+            if(std::sscanf(line, "%*s %31s %f %f %f %f", name, &a.w, &a.h, &a.lift, &a.speedMul) != 5) why = "expected: arch <Type> <w> <h> <lift> <speedMul>";
+            else if(!ParseType(name, t)) why = "unknown obstacle type";
+            else if(a.w <= 0 || a.h <= 0 || a.lift < 0 || a.speedMul <= 0) why = "sizes and speed must be positive";
+            else arch[(int)t] = a;
+        }
+        else if(!std::strcmp(kind, "tier")){
+            SpawnTier t;
+            unsigned wt[OBTYPE_COUNT];
+            uint64_t total = 0;
+            if(std::sscanf(line, "%*s %d %u %u %u %u %u %u", &t.fromScore, &wt[0], &wt[1], &wt[2], &wt[3], &wt[4], &wt[5]) != 7)
+                why = "expected: tier <fromScore> and 6 weights";
+            else if(count == SPAWN_MAX_TIERS) why = "too many tiers";
+            else if(count == 0 ? t.fromScore != 0 : t.fromScore <= tiers[count - 1].fromScore)
+                why = "tiers must ascend from score 0";
+            else {
+                for(int i=0;i<OBTYPE_COUNT;i++){
+                    if(wt[i] > MAX_WEIGHT){ why = "weight too large"; break; }
+                    t.weight[i] = wt[i]; total += wt[i];
+                }
+                if(!why && total == 0) why = "tier has no weight";
+                if(!why) tiers[count++] = t;
+            }
+        }
+        else why = "expected 'arch' or 'tier'";
+    }
+    std::fclose(f);
+    if(why){
+        if(err) std::fprintf(err, "%s:%d: %s\n", path, lineNo, why);
+        return false;
+    }
+    // archetype-only files keep the shipped tiers
+    if(count == 0){
+        for(int i=0;i<DEFAULT_TIER_COUNT;i++) tiers[i] = DEFAULT_TIERS[i];
+        count = DEFAULT_TIER_COUNT;
+    }
+    out = BakeSpawnTable(arch, tiers, count);
+    return true;
+}
+
+void PrintSpawnTable(std::FILE* f, const SpawnTable& s){
+    std::fprintf(f, "spawn table %08x\n", s.id);
+    for(int i=0;i<OBTYPE_COUNT;i++){
+        const ObArchetype& a = s.arch[i];
+        std::fprintf(f, "  %-13s %3.0f x %-3.0f lift %3.0f  speed x%.2f\n", ObTypeName((ObType)i), a.w, a.h, a.lift, a.speedMul);
+    }
+    for(int t=0;t<s.tierCount;t++){
+        const BakedTier& b = s.tiers[t];
+        double total = (double)b.cumulative[OBTYPE_COUNT - 1];
+        std::fprintf(f, "  from %5d:", b.fromScore);
+        uint32_t prev = 0;
+        for(int i=0;i<OBTYPE_COUNT;i++){
+            std::fprintf(f, " %5.1f%%", 100.0 * (double)(b.cumulative[i] - prev) / total);
+            prev = b.cumulative[i];
+        }
+        std::fputc('\n', f);
+    }
+}
@@ -0,0 +1,133 @@
+// ------------------------------------------------------------------
+// File: trex_spawn.h
+// Obstacle archetypes and difficulty tiers as data
+// ------------------------------------------------------------------
+//  - an archetype is an obstacle's size, height above the ground and
+//    speed relative to the world scroll
+//  - a tier is a starting score plus a weight per archetype; the tier
+//    in force is the last one whose score has been reached
+//  - tiers are baked into cumulative weights and an alias table (Vose),
+//    so picking a type costs one RNG draw, a multiply and a compare
+//    whatever the number of archetypes
+//  - the shipped table is baked at compile time; LoadSpawnTable() reads
+//    a text override (trex_spawn.txt in the game, --spawn in trex_cli)
+//    and bakes it with the same code
+//  - SpawnTable::id fingerprints a table so recordings made under a
+//    different one can be told apart
+// ------------------------------------------------------------------
+#ifndef TREX_SPAWN_H
+#define TREX_SPAWN_H
+
+#include <cstdint>
+#include <cstdio>
+
+enum class ObType { CactusSmall, CactusLarge, CactusDouble, BirdLow, BirdHigh, Boulder };
+static const int OBTYPE_COUNT = 6;
+static const int SPAWN_MAX_TIERS = 16;
+
+struct ObArchetype {
+    float w, h;
+    float lift;          // gap between ground and the obstacle's bottom
+    float speedMul;      // x world speed; only boulders differ
+};
+
+struct SpawnTier {
+    int      fromScore;
+    uint32_t weight[OBTYPE_COUNT];   // relative, by ObType; 0 = never
+};
+
+// A tier ready to sample: column i keeps type i when the draw's fraction
+// is below threshold[i], otherwise it yields alias[i].
+struct BakedTier {
+    int      fromScore = 0;
+    uint32_t cumulative[OBTYPE_COUNT] = {};   // running weight total
+    uint64_t threshold[OBTYPE_COUNT] = {};    // out of 2^32
+    uint8_t  alias[OBTYPE_COUNT] = {};
+};
+
+struct SpawnTable {
+    ObArchetype arch[OBTYPE_COUNT] = {};
+    BakedTier   tiers[SPAWN_MAX_TIERS] = {};
+    int         tierCount = 0;
+    uint32_t    id = 0;
+
+    // Branch-free: tiers are sorted by fromScore and tiers[0] starts at 0.
+    const BakedTier& Tier(int score) const {
+        int t = 0;
+        for(int i=1;i<tierCount;i++) t += (score >= tiers[i].fromScore);
+        return tiers[t];
+    }
+    // `draw` is one uniform 32-bit RNG output.
+    static ObType Sample(const BakedTier& t, uint32_t draw){
+        uint64_t m = (uint64_t)draw * OBTYPE_COUNT;
+        uint32_t col = (uint32_t)(m >> 32), frac = (uint32_t)m;
+        return (ObType)(frac < t.threshold[col] ? col : t.alias[col]);
+    }
+};
+
+// ---------------- Baking -----------------------------
+// Vose's alias method in integers: each weight is scaled by the column
+// count so a full column holds exactly `total`.
+constexpr BakedTier BakeTier(const SpawnTier& t){
+    BakedTier b{};
+    b.fromScore = t.fromScore;
+    uint64_t total = 0;
+    for(int i=0;i<OBTYPE_COUNT;i++){ total += t.weight[i]; b.cumulative[i] = (uint32_t)total; }
+    if(total == 0) return b;                       // rejected by the callers
+
+    uint64_t scaled[OBTYPE_COUNT] = {};
+    int small[OBTYPE_COUNT] = {}, large[OBTYPE_COUNT] = {};
+    int ns = 0, nl = 0;
+    for(int i=0;i<OBTYPE_COUNT;i++){
+        scaled[i] = (uint64_t)t.weight[i] * OBTYPE_COUNT;
+        if(scaled[i] < total) small[ns++] = i; else large[nl++] = i;
+        b.alias[i] = (uint8_t)i;
+    }
+    while(ns > 0 && nl > 0){
+        int s = small[--ns], l = large[--nl];
+        b.threshold[s] = (scaled[s] << 32) / total;
+        b.alias[s] = (uint8_t)l;
+        scaled[l] -= total - scaled[s];
+        if(scaled[l] < total) small[ns++] = l; else large[nl++] = l;
+    }
+    // what is left is full up to rounding
+    while(nl > 0) b.threshold[large[--nl]] = 1ull << 32;
+    while(ns > 0) b.threshold[small[--ns]] = 1ull << 32;
+    return b;
+}
+
+// FNV-1a over the values that change what gets spawned.
+constexpr uint32_t SpawnTableId(const ObArchetype* arch, const SpawnTier* tiers, int count){
+    uint32_t h = 2166136261u;
+    for(int i=0;i<OBTYPE_COUNT;i++){
+        const float f[4] = { arch[i].w, arch[i].h, arch[i].lift, arch[i].speedMul };
+        for(int k=0;k<4;k++){ h ^= (uint32_t)(int32_t)(f[k] * 1000.0f); h *= 16777619u; }
+    }
+    for(int t=0;t<count;t++){
+        h ^= (uint32_t)tiers[t].fromScore; h *= 16777619u;
+        for(int i=0;i<OBTYPE_COUNT;i++){ h ^= tiers[t].weight[i]; h *= 16777619u; }
+    }
+    return h;
+}
+
+constexpr SpawnTable BakeSpawnTable(const ObArchetype* arch, const SpawnTier* tiers, int count){
+    SpawnTable s{};
+    for(int i=0;i<OBTYPE_COUNT;i++) s.arch[i] = arch[i];
+    for(int t=0;t<count && t<SPAWN_MAX_TIERS;t++) s.tiers[s.tierCount++] = BakeTier(tiers[t]);
+    s.id = SpawnTableId(arch, tiers, count);
+    return s;
+}
+
+// The table the game shipped with.
+extern const SpawnTable DEFAULT_SPAWN_TABLE;
+
+// ---------------- Override file ----------------------
+// Text, one entry per line, '#' comments:
+//   arch <Type> <w> <h> <lift> <speedMul>     (replaces a default archetype)
+//   tier <fromScore> <6 weights in ObType order>
+// Tiers must ascend and the first must start at 0. On error prints
+// file:line to `err` and leaves `out` untouched.
+bool LoadSpawnTable(const char* path, SpawnTable& out, std::FILE* err = stderr);
+void PrintSpawnTable(std::FILE* f, const SpawnTable& s);
+
+#endif
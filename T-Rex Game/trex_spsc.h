@@ -0,0 +1,47 @@
+// ------------------------------------------------------------------
+// File: trex_spsc.h
+// Bounded single-producer / single-consumer lock-free queue
+// ------------------------------------------------------------------
+//  - one thread calls TryPush, one other thread calls TryPop
+//  - N must be a power of two; the queue holds up to N items
+//  - no locks and no allocation after construction: a full queue makes
+//    TryPush return false instead of waiting
+// ------------------------------------------------------------------
+#ifndef TREX_SPSC_H
+#define TREX_SPSC_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+template<class T, size_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+public:
+    bool TryPush(const T& v){
+        size_t h = head_.load(std::memory_order_relaxed);
+        if(h - tail_.load(std::memory_order_acquire) == N) return false;
+        slots_[h & (N - 1)] = v;
+        head_.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    bool TryPop(T& out){
+        size_t t = tail_.load(std::memory_order_relaxed);
+        if(t == head_.load(std::memory_order_acquire)) return false;
+        out = std::move(slots_[t & (N - 1)]);
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    // Approximate unless called from one of the two owning threads
+    size_t Size() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+    bool   Empty() const { return Size() == 0; }
+
+private:
+    // head and tail on separate cache lines so the two sides don't
+    // bounce one line between cores
+    alignas(64) std::atomic<size_t> head_{0};   // written by producer
+    alignas(64) std::atomic<size_t> tail_{0};   // written by consumer
+    alignas(64) T slots_[N];
+};
+
+#endif
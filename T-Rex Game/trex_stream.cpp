@@ -0,0 +1,167 @@
+// ------------------------------------------------------------------
+// File: trex_stream.cpp
+// Stream generation, the reachability check and the worker thread
+// ------------------------------------------------------------------
+#include "trex_stream.h"
+#include <chrono>
+
+// ---------------- Reachability -----------------------
+// Inputs per tick: nothing, jump, duck. Jumping clears duck (SetDuck
+// follows DoJump in ApplyInput) and in the air neither does anything.
+void StepReachable(const std::vector<Dino>& from, const Ring<Obstacle>& obs, std::vector<Dino>& to){
+    to.clear();
+    for(const auto &s: from){
+        for(int in=0;in<3;in++){
+            if(in > 0 && !s.onGround) break;
+            Dino d = s;
+            if(in == 1){ d.onGround = false; d.vy = -JUMP_VEL; }
+            d.duck = in == 2 && d.onGround;
+            StepDino(d, DT);
+            RectF b = d.bbox();
+            bool hit = false;
+            for(const auto &o: obs){
+                if(o.x + o.w < -8) continue;            // offscreen, as UpdateGame skips it
+                if(Intersect(b, RectF{ o.x, o.y, o.w, o.h })){ hit = true; break; }
+            }
+            if(hit) continue;
+            bool seen = false;
+            for(const auto &t: to){
+                if(t.y == d.y && t.vy == d.vy && t.onGround == d.onGround && t.duck == d.duck){ seen = true; break; }
+            }
+            if(!seen) to.push_back(d);
+        }
+    }
+}
+
+// ---------------- Generator --------------------------
+StreamGenerator::StreamGenerator(){
+    // a jump arc is ~40 ticks, on the ground there are two states
+    reach_.reserve(128); reachStart_.reserve(128); next_.reserve(128); tailReach_.reserve(128);
+}
+
+void StreamGenerator::Reset(uint64_t seed, const Tuning& tune, const SpawnTable* spawn){
+    shadow_.tune = tune;
+    shadow_.spawn = spawn;
+    shadow_.feed = nullptr;
+    ResetWorld(shadow_, seed, STREAM_RNG_STREAM);
+    shadow_.state = GameState::PLAYING;
+    reach_.assign(1, shadow_.dino);
+    dinoX_ = shadow_.dino.x;
+    shadow_.dino.x = -1.0e6f;         // the real dino lives in reach_
+    index_ = 0;
+    stats_ = StreamStats();
+}
+
+// One attempt at the next chunk from the current shadow_/reach_. The
+// last attempt spawns nothing and is always kept.
+bool StreamGenerator::Roll(StreamChunk& out, int attempt){
+    bool empty = attempt == STREAM_MAX_REROLLS;
+    for(int i=0;i<attempt;i++) shadow_.rng.next();   // a different roll each time
+    out.fromTick = shadow_.ticks + 1;
+    out.toTick = out.fromTick + STREAM_CHUNK_TICKS;
+    out.count = 0;
+    out.empty = empty;
+    for(uint32_t t=0;t<STREAM_CHUNK_TICKS;t++){
+        if(empty) shadow_.spawnTimer = 0.0f;
+        uint32_t before = shadow_.spawned;
+        UpdateGame(shadow_, DT);
+        stats_.ticksChecked++;
+        if(shadow_.spawned != before){
+            if(out.count == (uint32_t)STREAM_CHUNK_EVENTS) return false;
+            out.ev[out.count++] = StreamEvent{ shadow_.ticks, shadow_.obs.back() };
+        }
+        StepReachable(reach_, shadow_.obs, next_);
+        reach_.swap(next_);
+        if(reach_.size() > stats_.maxStates) stats_.maxStates = reach_.size();
+        if(reach_.empty() && !empty) return false;
+    }
+    return empty || SurvivesTail();
+}
+
+// With no more spawns, can some state outlive everything on screen?
+// This is what makes the empty fallback chunk safe.
+bool StreamGenerator::SurvivesTail(){
+    tail_ = shadow_;
+    tail_.nextSpawnIn = 1.0e30f;
+    tailReach_ = reach_;
+    for(uint32_t t=0;t<STREAM_TAIL_TICKS;t++){
+        bool ahead = false;
+        for(const auto &o: tail_.obs) if(o.x + o.w >= dinoX_){ ahead = true; break; }
+        if(!ahead) return true;
+        UpdateGame(tail_, DT);
+        stats_.ticksChecked++;
+        StepReachable(tailReach_, tail_.obs, next_);
+        tailReach_.swap(next_);
+        if(tailReach_.empty()) return false;
+    }
+    return true;
+}
+
+void StreamGenerator::Next(StreamChunk& out){
+    auto t0 = std::chrono::steady_clock::now();
+    start_ = shadow_;
+    reachStart_ = reach_;
+    int attempt = 0;
+    for(;;attempt++){
+        if(attempt){ shadow_ = start_; reach_ = reachStart_; }
+        if(Roll(out, attempt) || attempt == STREAM_MAX_REROLLS) break;
+    }
+    out.index = index_++;
+    out.rerolls = (uint32_t)attempt;
+    stats_.chunks++;
+    stats_.events += out.count;
+    stats_.rerolls += (uint64_t)attempt;
+    if(out.empty) stats_.emptied++;
+    stats_.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void FillFeed(StreamGenerator& g, SpawnFeed& feed, uint32_t tick){
+    StreamChunk c;
+    while(feed.CoveredTo() <= tick && !feed.Full()){
+        g.Next(c);
+        feed.Add(c);
+    }
+}
+
+// ---------------- Worker -----------------------------
+void StreamWorker::Start(uint64_t seed, const Tuning& tune, const SpawnTable* spawn){
+    Stop();
+    StreamChunk stale;
+    while(queue_.TryPop(stale)) {}
+    gen_.Reset(seed, tune, spawn);
+    stop_ = false;
+    worker_ = std::thread(&StreamWorker::Run, this);
+}
+
+void StreamWorker::Stop(){
+    if(!worker_.joinable()) return;
+    { std::lock_guard<std::mutex> lk(wakeMutex_); stop_ = true; }
+    wake_.notify_one();
+    worker_.join();
+}
+
+void StreamWorker::Run(){
+    StreamChunk c;
+    bool ready = false;
+    while(!stop_){
+        if(!ready){ gen_.Next(c); ready = true; }
+        if(queue_.TryPush(c)){ ready = false; continue; }
+        // Feed() pops without the mutex, so a wakeup can be missed; the
+        // timeout bounds the delay
+        std::unique_lock<std::mutex> lk(wakeMutex_);
+        wake_.wait_for(lk, std::chrono::milliseconds(20), [this]{ return stop_.load(); });
+    }
+}
+
+void StreamWorker::Feed(SpawnFeed& feed, uint32_t tick){
+    feed.Retire(tick);
+    bool popped = false, stalled = false;
+    StreamChunk c;
+    for(;;){
+        while(!feed.Full() && queue_.TryPop(c)){ feed.Add(c); popped = true; }
+        if(feed.CoveredTo() > tick || feed.Full()) break;
+        if(!stalled){ stalls_++; stalled = true; }
+        std::this_thread::yield();
+    }
+    if(popped) wake_.notify_one();
+}
@@ -0,0 +1,174 @@
+// ------------------------------------------------------------------
+// File: trex_stream.h
+// Obstacle stream generated ahead of play and checked for solvability
+// ------------------------------------------------------------------
+//  - SpawnIfNeeded only keeps 40px between spawns, so at top speed it
+//    can deal a sequence no jump/duck timing survives
+//  - obstacles never depend on the dino, so the whole stream is a
+//    function of (seed, Tuning, SpawnTable). StreamGenerator rolls it
+//    on a shadow World whose dino stands far off-screen, in chunks of
+//    STREAM_CHUNK_TICKS ticks
+//  - each chunk is checked against every dino state reachable under the
+//    real physics (StepDino, DoJump/SetDuck rules, bbox incl. duck), plus
+//    a spawn-free tail until its last obstacle has passed the dino. A
+//    chunk no state survives is re-rolled; after STREAM_MAX_REROLLS the
+//    chunk is served empty, which the previous tail check proved safe.
+//    So some input sequence always survives every served chunk.
+//  - StreamWorker runs the generator on its own thread and hands chunks
+//    over through an SpscQueue; the game thread only copies finished
+//    chunks into a SpawnFeed, which World::feed reads by tick
+//  - generation is deterministic: trex_cli --replay rebuilds the same
+//    stream inline from the recording's seed
+// ------------------------------------------------------------------
+#ifndef TREX_STREAM_H
+#define TREX_STREAM_H
+
+#include "trex_sim.h"
+#include "trex_spsc.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static const uint32_t STREAM_CHUNK_TICKS  = 120;   // 2 s of play
+static const int      STREAM_CHUNK_EVENTS = 32;    // more in one chunk = re-roll
+static const int      STREAM_MAX_REROLLS  = 16;
+static const uint32_t STREAM_TAIL_TICKS   = 600;   // longest an obstacle stays on screen
+static const uint64_t STREAM_RNG_STREAM   = 0x5354;   // the shadow World's PCG stream
+
+// An obstacle as SpawnIfNeeded pushes it during the step that ends with
+// World::ticks == tick.
+struct StreamEvent {
+    uint32_t tick;
+    Obstacle o;
+};
+
+// Spawns for ticks [fromTick, toTick). Plain data, copied by value.
+struct StreamChunk {
+    uint32_t    index;
+    uint32_t    fromTick, toTick;
+    uint32_t    count;
+    uint32_t    rerolls;          // attempts thrown away before this one
+    bool        empty;            // served spawn-free after STREAM_MAX_REROLLS
+    StreamEvent ev[STREAM_CHUNK_EVENTS];
+};
+
+// Read side: the chunks around the current tick. Sized once; Add()
+// refuses a chunk instead of growing.
+class SpawnFeed {
+public:
+    explicit SpawnFeed(size_t maxChunks = 8) : cap_(maxChunks) { chunks_.reserve(maxChunks); }
+
+    void Clear(){ chunks_.clear(); coveredTo_ = 1; }
+    bool Full() const { return chunks_.size() == cap_; }
+    // Chunks must arrive in order.
+    bool Add(const StreamChunk& c){
+        if(Full()) return false;
+        chunks_.push_back(c);
+        coveredTo_ = c.toTick;
+        return true;
+    }
+    // Drop chunks that end at or before `tick`.
+    void Retire(uint32_t tick){
+        size_t n = 0;
+        while(n < chunks_.size() && chunks_[n].toTick <= tick) n++;
+        if(n) chunks_.erase(chunks_.begin(), chunks_.begin() + (std::ptrdiff_t)n);
+    }
+    // Spawns are known for every tick below this.
+    uint32_t CoveredTo() const { return coveredTo_; }
+
+    // Events due at `tick`, in spawn order; none if the tick isn't held.
+    const StreamEvent* At(uint32_t tick, size_t& n) const {
+        n = 0;
+        for(const auto &c: chunks_){
+            if(tick < c.fromTick || tick >= c.toTick) continue;
+            uint32_t i = 0;
+            while(i < c.count && c.ev[i].tick < tick) i++;
+            uint32_t j = i;
+            while(j < c.count && c.ev[j].tick == tick) j++;
+            n = j - i;
+            return c.ev + i;
+        }
+        return nullptr;
+    }
+
+private:
+    std::vector<StreamChunk> chunks_;
+    size_t   cap_;
+    uint32_t coveredTo_ = 1;      // UpdateGame's first step is tick 1
+};
+
+struct StreamStats {
+    uint64_t chunks = 0, events = 0;
+    uint64_t rerolls = 0;         // chunks rolled and thrown away
+    uint64_t emptied = 0;         // chunks served empty
+    uint64_t ticksChecked = 0;    // incl. tails and re-rolls
+    size_t   maxStates = 0;       // largest reachable set seen
+    double   seconds = 0.0;       // spent in Next()
+};
+
+// Pure and single-threaded: the same (seed, tune, table) always gives
+// the same chunks.
+class StreamGenerator {
+public:
+    StreamGenerator();
+    void Reset(uint64_t seed, const Tuning& tune, const SpawnTable* spawn);
+    void Next(StreamChunk& out);
+    const StreamStats& Stats() const { return stats_; }
+
+private:
+    bool Roll(StreamChunk& out, int attempt);
+    bool SurvivesTail();
+
+    World    shadow_, start_, tail_;
+    std::vector<Dino> reach_, reachStart_, next_, tailReach_;
+    float    dinoX_ = 0.0f;
+    uint32_t index_ = 0;
+    StreamStats stats_;
+};
+
+// Every dino state one tick of input can lead to from `from` without
+// touching `obs` (moved for the tick), deduplicated.
+void StepReachable(const std::vector<Dino>& from, const Ring<Obstacle>& obs, std::vector<Dino>& to);
+
+// Generate inline until `feed` covers `tick` (replay, tools).
+void FillFeed(StreamGenerator& g, SpawnFeed& feed, uint32_t tick);
+
+// ---------------- Worker -----------------------------
+class StreamWorker {
+public:
+    StreamWorker() {}
+    ~StreamWorker(){ Stop(); }
+
+    // (Re)starts generation for a run; chunks of any previous run are dropped.
+    void Start(uint64_t seed, const Tuning& tune, const SpawnTable* spawn);
+    void Stop();
+
+    // Game thread, before each step: moves ready chunks into `feed` and
+    // retires old ones. Only waits if the worker has not yet produced
+    // the chunk holding `tick` (counted in Stalls()).
+    void Feed(SpawnFeed& feed, uint32_t tick);
+
+    uint64_t Stalls() const { return stalls_; }
+    // Worker-side stats; read after Stop()
+    const StreamStats& Stats() const { return gen_.Stats(); }
+
+private:
+    StreamWorker(const StreamWorker&);
+    StreamWorker& operator=(const StreamWorker&);
+
+    void Run();
+
+    StreamGenerator gen_;
+    SpscQueue<StreamChunk, 8> queue_;
+    std::thread     worker_;
+    std::mutex      wakeMutex_;
+    std::condition_variable wake_;
+    std::atomic<bool> stop_{false};
+    uint64_t        stalls_ = 0;
+};
+
+#endif
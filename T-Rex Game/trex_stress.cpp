@@ -0,0 +1,122 @@
+// ------------------------------------------------------------------
+// File: trex_stress.cpp
+// UniformGrid + StressScene
+// ------------------------------------------------------------------
+#include "trex_stress.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+typedef std::chrono::steady_clock StressClock;
+
+static double Since(StressClock::time_point t0){
+    return std::chrono::duration<double>(StressClock::now() - t0).count();
+}
+
+// ---------------- Grid -------------------------------
+void UniformGrid::Reset(float x0, float y0, float x1, float y1, float cell){
+    x0_ = x0; y0_ = y0; inv_ = 1.0f / cell;
+    cols_ = std::max(1, (int)std::ceil((x1 - x0) / cell));
+    rows_ = std::max(1, (int)std::ceil((y1 - y0) / cell));
+    start_.assign(Cells() + 1, 0);
+    fill_.assign(Cells(), 0);
+}
+
+void UniformGrid::Build(const std::vector<RectF>& boxes){
+    size_t n = boxes.size(), cells = Cells();
+    spans_.resize(n);
+    std::fill(start_.begin(), start_.end(), 0);
+    // pass 1: count entries per cell
+    for(size_t i=0;i<n;i++){
+        const RectF& b = boxes[i];
+        Span s{ (int16_t)CellX(b.x), (int16_t)CellY(b.y), (int16_t)CellX(b.x + b.w), (int16_t)CellY(b.y + b.h) };
+        spans_[i] = s;
+        for(int cy=s.cy0;cy<=s.cy1;cy++)
+            for(int cx=s.cx0;cx<=s.cx1;cx++) start_[cy * cols_ + cx + 1]++;
+    }
+    for(size_t c=0;c<cells;c++) start_[c + 1] += start_[c];
+    // pass 2: scatter
+    items_.resize(start_[cells]);
+    for(size_t c=0;c<cells;c++) fill_[c] = start_[c];
+    for(size_t i=0;i<n;i++){
+        const Span& s = spans_[i];
+        for(int cy=s.cy0;cy<=s.cy1;cy++)
+            for(int cx=s.cx0;cx<=s.cx1;cx++) items_[fill_[cy * cols_ + cx]++] = (uint32_t)i;
+    }
+}
+
+// ---------------- Scene ------------------------------
+void StressScene::Reset(const StressConfig& cfg){
+    cfg_ = cfg;
+    ResetWorld(w_, cfg.seed);
+    w_.state = GameState::PLAYING;
+    w_.obs.reserve(cfg.obstacles);
+    w_.clouds.reserve(cfg.clouds);
+    boxes_.reserve(cfg.obstacles);
+    grid_.Reset(-64.0f, 0.0f, 2.0f * W_WIDTH + 64.0f, (float)W_HEIGHT, cfg.cell);
+
+    // runners spread over the screen, each on its own jump phase
+    runners_.assign(cfg.runners, Dino());
+    float groundY = (float)(W_HEIGHT - GROUND_H);
+    for(uint32_t i=0;i<cfg.runners;i++){
+        Dino& d = runners_[i];
+        d.x = 20.0f + (W_WIDTH - 80.0f) * (float)i / (float)std::max(1u, cfg.runners);
+        d.y = groundY - 52.0f;
+        d.onGround = (i % 3) != 0;
+        d.vy = d.onGround ? 0.0f : -JUMP_VEL * (float)(i % 7) / 7.0f;
+    }
+}
+
+void StressScene::Step(StressFrame& out){
+    out = StressFrame{};
+
+    // Spawn: keep the live counts at the target, queued left to right past
+    // the right edge (the ring only retires from its head) at a screen's
+    // width per `obstacles`
+    auto t0 = StressClock::now();
+    float gap = (float)W_WIDTH / (float)std::max(1u, cfg_.obstacles);
+    while(w_.obs.size() < cfg_.obstacles){
+        Obstacle o = MakeObstacle(w_);
+        float x = w_.obs.empty() ? (float)W_WIDTH : std::max((float)W_WIDTH, w_.obs.back().x + gap);
+        o.x = x + w_.rng.uniform(0.0f, gap);
+        w_.obs.push_back(o);
+        out.spawned++;
+    }
+    while(w_.clouds.size() < cfg_.clouds){
+        w_.clouds.push_back(Cloud{ w_.rng.uniform(0.0f, W_WIDTH + 140.0f), w_.rng.uniform(30.0f, 130.0f),
+                                   w_.rng.uniform(10.0f, 24.0f) });
+    }
+    out.spawnSec = Since(t0);
+
+    // The real game step; the dino shrugs off hits so the scene keeps going
+    t0 = StressClock::now();
+    UpdateGame(w_, DT);
+    w_.state = GameState::PLAYING;
+    out.updateSec = Since(t0);
+
+    // Runners hold jump: the game's own take-off and physics step
+    for(auto &d: runners_){ StartJump(d); StepDino(d, DT); }
+
+    // Broadphase
+    t0 = StressClock::now();
+    boxes_.clear();
+    for(const auto &o: w_.obs) boxes_.push_back(RectF{ o.x, o.y, o.w, o.h });
+    grid_.Build(boxes_);
+    uint32_t hits = 0;
+    for(const auto &d: runners_){
+        RectF b = d.bbox();
+        grid_.Query(b, [&](uint32_t i){ if(Intersect(b, boxes_[i])) hits++; });
+    }
+    out.gridHits = hits;
+    out.gridSec = Since(t0);
+
+    // All pairs
+    t0 = StressClock::now();
+    hits = 0;
+    for(const auto &d: runners_){
+        RectF b = d.bbox();
+        for(const auto &o: w_.obs) if(Intersect(b, RectF{ o.x, o.y, o.w, o.h })) hits++;
+    }
+    out.naiveHits = hits;
+    out.naiveSec = Since(t0);
+}
@@ -0,0 +1,94 @@
+// ------------------------------------------------------------------
+// File: trex_stress.h
+// Stress scene: thousands of live obstacles/clouds + a uniform grid
+// ------------------------------------------------------------------
+//  - StressScene keeps a normal World topped up to a target number of
+//    obstacles and clouds (far beyond SpawnIfNeeded's cadence) and
+//    steps it with the real UpdateGame, so its cost is what's measured
+//  - a crowd of ghost runners spread over the screen, moved by the
+//    game's StartJump/StepDino but never drawn, are hit-tested
+//    against every obstacle, once through UniformGrid and once by
+//    brute force, to compare broadphase against all-pairs; the grid
+//    costs O(obstacles + overlaps found), brute force O(runners x obstacles)
+//  - UniformGrid: cells in a flat CSR array rebuilt each frame with a
+//    counting sort (two linear passes, no per-cell vectors)
+// ------------------------------------------------------------------
+#ifndef TREX_STRESS_H
+#define TREX_STRESS_H
+
+#include "trex_sim.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class UniformGrid {
+public:
+    // Fixed bounds; anything outside lands in the border cells.
+    void Reset(float x0, float y0, float x1, float y1, float cell);
+    void Build(const std::vector<RectF>& boxes);
+
+    // Calls f(i) once for every box i sharing a cell with r.
+    template<class F>
+    void Query(const RectF& r, F f) const {
+        int cx0 = CellX(r.x), cx1 = CellX(r.x + r.w), cy0 = CellY(r.y), cy1 = CellY(r.y + r.h);
+        for(int cy=cy0;cy<=cy1;cy++){
+            for(int cx=cx0;cx<=cx1;cx++){
+                int c = cy * cols_ + cx;
+                for(uint32_t k=start_[c];k<start_[c+1];k++){
+                    uint32_t i = items_[k];
+                    const Span& s = spans_[i];
+                    // a box in several cells is reported from the first shared one only
+                    if(cx != (s.cx0 > cx0 ? s.cx0 : cx0) || cy != (s.cy0 > cy0 ? s.cy0 : cy0)) continue;
+                    f(i);
+                }
+            }
+        }
+    }
+
+    size_t Cells() const { return (size_t)cols_ * rows_; }
+    size_t Entries() const { return items_.size(); }
+
+private:
+    struct Span { int16_t cx0, cy0, cx1, cy1; };
+    int CellX(float x) const { int c = (int)((x - x0_) * inv_); return c < 0 ? 0 : (c >= cols_ ? cols_ - 1 : c); }
+    int CellY(float y) const { int c = (int)((y - y0_) * inv_); return c < 0 ? 0 : (c >= rows_ ? rows_ - 1 : c); }
+
+    float x0_ = 0, y0_ = 0, inv_ = 1;
+    int   cols_ = 1, rows_ = 1;
+    std::vector<uint32_t> start_;     // cells + 1 offsets into items_
+    std::vector<uint32_t> items_;
+    std::vector<uint32_t> fill_;
+    std::vector<Span>     spans_;
+};
+
+struct StressConfig {
+    uint32_t obstacles = 1000;        // live obstacles to keep
+    uint32_t clouds    = 250;         // live clouds to keep
+    uint32_t runners   = 64;          // ghost dinos for the broadphase test
+    float    cell      = 64.0f;
+    uint64_t seed      = 3;
+};
+
+struct StressFrame {
+    double   spawnSec, updateSec, gridSec, naiveSec;
+    uint32_t spawned;                 // obstacles added this frame
+    uint32_t gridHits, naiveHits;     // runner/obstacle overlaps found
+};
+
+class StressScene {
+public:
+    void Reset(const StressConfig& cfg);
+    // Top up, UpdateGame, then the runner hit tests; timings in `out`.
+    void Step(StressFrame& out);
+
+    const World& GetWorld() const { return w_; }
+
+private:
+    StressConfig cfg_;
+    World        w_;
+    std::vector<RectF> boxes_;
+    std::vector<Dino>  runners_;
+    UniformGrid  grid_;
+};
+
+#endif
@@ -0,0 +1,195 @@
+// ------------------------------------------------------------------
+// File: trex_telemetry.cpp
+// Shared-memory segment setup and the seqlock write / read
+// ------------------------------------------------------------------
+#include "trex_telemetry.h"
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <dirent.h>
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <time.h>
+  #include <unistd.h>
+#endif
+
+std::string TelemetryName(uint32_t pid){
+    char buf[48];
+    std::snprintf(buf, sizeof(buf), "%s%u", TELEMETRY_PREFIX, (unsigned)pid);
+    return buf;
+}
+
+uint32_t CurrentPid(){
+#ifdef _WIN32
+    return (uint32_t)GetCurrentProcessId();
+#else
+    return (uint32_t)getpid();
+#endif
+}
+
+uint64_t TelemetryNowNs(){
+#ifdef _WIN32
+    static LARGE_INTEGER freq = [](){ LARGE_INTEGER f; QueryPerformanceFrequency(&f); return f; }();
+    LARGE_INTEGER c; QueryPerformanceCounter(&c);
+    uint64_t t = (uint64_t)c.QuadPart, f = (uint64_t)freq.QuadPart;
+    return t / f * 1000000000ull + t % f * 1000000000ull / f;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// ---------------- Mapping ----------------------------
+#ifdef _WIN32
+static std::wstring MappingName(const std::string& name){
+    std::wstring w = L"Local\\";
+    for(char c: name) w += (wchar_t)(unsigned char)c;
+    return w;
+}
+#else
+static std::string ShmName(const std::string& name){ return "/" + name; }
+#endif
+
+bool TelemetryWriter::Open(const std::string& name){
+    Close();
+    void* p = nullptr;
+#ifdef _WIN32
+    HANDLE h = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                  (DWORD)sizeof(TelemetryBlock), MappingName(name).c_str());
+    if(!h) return false;
+    p = MapViewOfFile(h, FILE_MAP_WRITE, 0, 0, sizeof(TelemetryBlock));
+    if(!p){ CloseHandle(h); return false; }
+    handle_ = h;
+#else
+    int fd = shm_open(ShmName(name).c_str(), O_CREAT | O_RDWR, 0644);
+    if(fd < 0) return false;
+    if(ftruncate(fd, (off_t)sizeof(TelemetryBlock)) != 0){ ::close(fd); return false; }
+    p = mmap(nullptr, sizeof(TelemetryBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(p == MAP_FAILED) return false;
+#endif
+    name_ = name;
+    // A reader that mapped a previous owner's segment sees magic 0 until
+    // the header is complete.
+    std::memset(p, 0, sizeof(TelemetryBlock));
+    block_ = new(p) TelemetryBlock;
+    block_->seq.store(0, std::memory_order_relaxed);
+    for(auto &w: block_->words) w.store(0, std::memory_order_relaxed);
+    block_->version = TELEMETRY_VERSION;
+    block_->size = (uint32_t)sizeof(TelemetryBlock);
+    block_->pid = CurrentPid();
+    std::atomic_thread_fence(std::memory_order_release);
+    block_->magic = TELEMETRY_MAGIC;
+    publishes_ = 0;
+    return true;
+}
+
+void TelemetryWriter::Close(){
+    if(!block_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(block_);
+    CloseHandle((HANDLE)handle_);
+#else
+    munmap(block_, sizeof(TelemetryBlock));
+    shm_unlink(ShmName(name_).c_str());
+#endif
+    block_ = nullptr; handle_ = nullptr;
+}
+
+bool TelemetryReader::Open(const std::string& name){
+    Close();
+    void* p = nullptr;
+#ifdef _WIN32
+    HANDLE h = OpenFileMappingW(FILE_MAP_READ, FALSE, MappingName(name).c_str());
+    if(!h) return false;
+    p = MapViewOfFile(h, FILE_MAP_READ, 0, 0, sizeof(TelemetryBlock));
+    if(!p){ CloseHandle(h); return false; }
+    handle_ = h;
+#else
+    int fd = shm_open(ShmName(name).c_str(), O_RDONLY, 0);
+    if(fd < 0) return false;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TelemetryBlock)){ ::close(fd); return false; }
+    p = mmap(nullptr, sizeof(TelemetryBlock), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(p == MAP_FAILED) return false;
+#endif
+    block_ = (const TelemetryBlock*)p;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(block_->magic != TELEMETRY_MAGIC || block_->version != TELEMETRY_VERSION || block_->size != sizeof(TelemetryBlock)){
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void TelemetryReader::Close(){
+    if(!block_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(block_);
+    CloseHandle((HANDLE)handle_);
+#else
+    munmap((void*)block_, sizeof(TelemetryBlock));
+#endif
+    block_ = nullptr; handle_ = nullptr;
+}
+
+std::vector<std::string> ListTelemetry(){
+    std::vector<std::string> names;
+#ifndef _WIN32
+    if(DIR* d = opendir("/dev/shm")){
+        const size_t n = sizeof(TELEMETRY_PREFIX) - 1;
+        while(struct dirent* e = readdir(d))
+            if(!std::strncmp(e->d_name, TELEMETRY_PREFIX, n)) names.push_back(e->d_name);
+        closedir(d);
+    }
+#endif
+    return names;
+}
+
+// ---------------- Seqlock ----------------------------
+// Writer: odd, fence, words, even (release). Reader: even (acquire),
+// words, fence, same even again. The words are atomics so the racing
+// copy is defined behaviour; relaxed 64-bit loads/stores are plain moves.
+void TelemetryWriter::Publish(const TelemetrySample& s){
+    if(!block_) return;
+    TelemetrySample v = s;
+    v.publishes = ++publishes_;
+    uint64_t w[TELEMETRY_WORDS];
+    std::memcpy(w, &v, sizeof(w));
+    uint64_t seq = block_->seq.load(std::memory_order_relaxed);
+    block_->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for(size_t i=0;i<TELEMETRY_WORDS;i++) block_->words[i].store(w[i], std::memory_order_relaxed);
+    block_->seq.store(seq + 2, std::memory_order_release);
+}
+
+bool TelemetryReader::Read(TelemetrySample& out, uint32_t* retries, int maxTries) const {
+    if(retries) *retries = 0;
+    if(!block_) return false;
+    uint64_t w[TELEMETRY_WORDS];
+    for(int t=0;t<maxTries;t++){
+        uint64_t s0 = block_->seq.load(std::memory_order_acquire);
+        if(!(s0 & 1)){
+            for(size_t i=0;i<TELEMETRY_WORDS;i++) w[i] = block_->words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(block_->seq.load(std::memory_order_relaxed) == s0){
+                std::memcpy(&out, w, sizeof(out));
+                return true;
+            }
+        }
+        if(retries) ++*retries;
+        std::this_thread::yield();      // let a preempted writer finish
+    }
+    return false;
+}
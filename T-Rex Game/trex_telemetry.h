@@ -0,0 +1,136 @@
+// ------------------------------------------------------------------
+// File: trex_telemetry.h
+// Live counters in a shared-memory segment, guarded by a seqlock
+// ------------------------------------------------------------------
+//  - the game owns one fixed-layout TelemetryBlock per process, named
+//    trex_telemetry.<pid> (POSIX shm_open, so /dev/shm on Linux; a
+//    Local\ file mapping on Windows)
+//  - Publish() is a seqlock write: sequence to odd, the sample copied in
+//    as relaxed 64-bit atomic words, sequence to even. No syscalls, no
+//    locks, never waits for a reader
+//  - a reader maps the segment read-only and retries while the sequence
+//    is odd or moved under it, so any number of monitors can poll at any
+//    rate without the game noticing
+//  - layout is versioned (magic, version, size); a reader refuses a
+//    segment it does not understand instead of misreading it
+// ------------------------------------------------------------------
+#ifndef TREX_TELEMETRY_H
+#define TREX_TELEMETRY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+static const uint32_t TELEMETRY_MAGIC   = 0x54585254u;   // "TRXT"
+static const uint32_t TELEMETRY_VERSION = 1;
+static const char     TELEMETRY_PREFIX[] = "trex_telemetry.";
+
+// TelemetrySample::flags
+static const uint32_t TELEM_SOFT_RENDER = 1u << 0;
+static const uint32_t TELEM_CAPTURING   = 1u << 1;
+static const uint32_t TELEM_NIGHT       = 1u << 2;
+
+// One publish. Fixed-size fields only; times from the steady clock.
+struct TelemetrySample {
+    uint64_t publishes;       // samples published, this one included
+    uint64_t updatedNs;       // steady clock at publish (system-wide monotonic)
+    uint64_t frames;          // frames presented
+    uint64_t simSteps;        // fixed update steps
+    uint64_t lateSteps;       // steps run more than one DT late
+    uint64_t runs;            // runs started
+    int32_t  state;           // GameState
+    int32_t  score;
+    int32_t  highScore;
+    uint32_t obstacles;       // live obstacles
+    uint32_t particles;       // live particles
+    uint32_t allocFrames;     // frames that hit the heap (tracking builds)
+    float    fps;             // presented frames per second, last second
+    float    frameP50Ms;      // frame interval percentiles since start
+    float    frameP99Ms;
+    float    frameMaxMs;
+    float    renderP99Ms;
+    uint32_t flags;           // TELEM_*
+};
+static_assert(std::is_trivially_copyable<TelemetrySample>::value, "samples are copied as words");
+static_assert(sizeof(TelemetrySample) % 8 == 0, "samples are copied as 64-bit words");
+
+static const size_t TELEMETRY_WORDS = sizeof(TelemetrySample) / 8;
+
+// What lives in the segment. Header fields are written once before the
+// magic; the sample only through the seqlock.
+struct TelemetryBlock {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;            // sizeof(TelemetryBlock)
+    uint32_t pid;
+    alignas(64) std::atomic<uint64_t> seq;     // odd while a write is in progress
+    std::atomic<uint64_t> words[TELEMETRY_WORDS];
+};
+// 64-bit atomics are lock-free (plain loads/stores) on every target the
+// game ships for; a lock-based atomic would not work across processes.
+static_assert(sizeof(std::atomic<uint64_t>) == 8, "shared atomics must be bare words");
+
+// trex_telemetry.<pid>
+std::string TelemetryName(uint32_t pid);
+uint32_t    CurrentPid();
+
+class TelemetryWriter {
+public:
+    TelemetryWriter() {}
+    ~TelemetryWriter(){ Close(); }
+
+    // Creates (or takes over) the named segment. False if the OS refuses.
+    bool Open(const std::string& name);
+    // Unmaps; on POSIX the name is removed too.
+    void Close();
+    bool IsOpen() const { return block_ != nullptr; }
+
+    // Fills in `publishes`; the rest is the caller's.
+    void Publish(const TelemetrySample& s);
+
+private:
+    TelemetryWriter(const TelemetryWriter&);
+    TelemetryWriter& operator=(const TelemetryWriter&);
+
+    TelemetryBlock* block_ = nullptr;
+    void*           handle_ = nullptr;    // Windows mapping handle
+    std::string     name_;
+    uint64_t        publishes_ = 0;
+};
+
+class TelemetryReader {
+public:
+    TelemetryReader() {}
+    ~TelemetryReader(){ Close(); }
+
+    // Maps the segment read-only. False if it is missing, too small or
+    // of another magic / version.
+    bool Open(const std::string& name);
+    void Close();
+    bool IsOpen() const { return block_ != nullptr; }
+    uint32_t Pid() const { return block_ ? block_->pid : 0; }
+
+    // A consistent sample, or false if every one of maxTries attempts
+    // raced a write. `retries` gets the attempts that had to be redone.
+    bool Read(TelemetrySample& out, uint32_t* retries = nullptr, int maxTries = 1000) const;
+
+private:
+    TelemetryReader(const TelemetryReader&);
+    TelemetryReader& operator=(const TelemetryReader&);
+
+    const TelemetryBlock* block_ = nullptr;
+    void*                 handle_ = nullptr;
+};
+
+// Names of the segments present (scans /dev/shm; empty on Windows,
+// where mappings can't be listed).
+std::vector<std::string> ListTelemetry();
+
+// Steady clock in nanoseconds, comparable across processes on one
+// machine (CLOCK_MONOTONIC / QueryPerformanceCounter)
+uint64_t TelemetryNowNs();
+
+#endif
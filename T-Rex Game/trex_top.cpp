@@ -0,0 +1,127 @@
+// ------------------------------------------------------------------
+// File: trex_top.cpp
+// Live view of running T-Rex games through their telemetry segments
+// ------------------------------------------------------------------
+// Maps every /dev/shm/trex_telemetry.<pid> read-only (trex_telemetry.h)
+// and prints one line per game each --interval. Reading is a seqlock
+// copy out of shared memory: no messages to the game, which cannot tell
+// how many monitors there are or how often they poll. A game that has
+// not published for 2 s is marked STALE, one whose process is gone
+// (crashed without unlinking) GONE; remove those with
+// rm /dev/shm/trex_telemetry.<pid>.
+//
+//   trex_bench telemetry --serve &      (headless writer, for testing)
+//   trex_top --interval 250
+//
+// Usage: trex_top [--pid PID | --name NAME] [--interval MS] [--count N]
+//                 [--once]
+// Build (Linux): g++ -O2 -std=c++14 -o trex_top trex_top.cpp trex_telemetry.cpp
+//                    (add -lrt on glibc older than 2.17)
+// ------------------------------------------------------------------
+#include "trex_telemetry.h"
+#include "trex_sim.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <signal.h>
+#include <string>
+#include <thread>
+
+struct TopOptions {
+    std::string name;                 // empty: every segment found
+    uint32_t interval = 1000;         // ms
+    uint64_t count = 0;               // 0: until interrupted
+};
+
+static void PrintUsage(){
+    std::printf("usage: trex_top [--pid PID | --name NAME] [--interval MS] [--count N]\n"
+                "                [--once]\n");
+}
+
+static bool ParseArgs(int argc, char** argv, TopOptions& o){
+    for(int i=1;i<argc;i++){
+        const char* a = argv[i];
+        bool hasVal = i + 1 < argc;
+        if(!std::strcmp(a,"--pid") && hasVal)           o.name = TelemetryName((uint32_t)std::strtoul(argv[++i], nullptr, 10));
+        else if(!std::strcmp(a,"--name") && hasVal)     o.name = argv[++i];
+        else if(!std::strcmp(a,"--interval") && hasVal) o.interval = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if(!std::strcmp(a,"--count") && hasVal)    o.count = std::strtoull(argv[++i], nullptr, 10);
+        else if(!std::strcmp(a,"--once"))               o.count = 1;
+        else return false;
+    }
+    return o.interval > 0;
+}
+
+static const char* StateName(int32_t s){
+    switch((GameState)s){
+    case GameState::MENU:     return "menu";
+    case GameState::PLAYING:  return "play";
+    case GameState::GAMEOVER: return "over";
+    }
+    return "?";
+}
+
+static bool ProcessAlive(uint32_t pid){
+    return pid && (kill((pid_t)pid, 0) == 0 || errno == EPERM);
+}
+
+static void PrintHeader(){
+    std::printf("%7s %-4s %6s %6s %6s %6s %6s %6s %6s %9s %5s %4s %5s %7s %4s %s\n",
+                "pid", "st", "score", "high", "fps", "p50ms", "p99ms", "maxms", "rndp99",
+                "steps", "late", "obs", "fx", "age_ms", "try", "flags");
+}
+
+static void PrintSample(uint32_t pid, const TelemetrySample& t, uint32_t retries){
+    uint64_t now = TelemetryNowNs();
+    double age = now > t.updatedNs ? (double)(now - t.updatedNs) / 1e6 : 0.0;
+    char flags[64] = "";
+    if(t.flags & TELEM_SOFT_RENDER) std::strcat(flags, "soft ");
+    else                            std::strcat(flags, "gdi ");
+    if(t.flags & TELEM_NIGHT)       std::strcat(flags, "night ");
+    if(t.flags & TELEM_CAPTURING)   std::strcat(flags, "rec ");
+    if(!ProcessAlive(pid))          std::strcat(flags, "GONE");
+    else if(age > 2000.0)           std::strcat(flags, "STALE");
+    std::printf("%7u %-4s %6d %6d %6.1f %6.2f %6.2f %6.2f %6.2f %9llu %5llu %4u %5u %7.1f %4u %s\n",
+                (unsigned)pid, StateName(t.state), t.score, t.highScore, t.fps,
+                t.frameP50Ms, t.frameP99Ms, t.frameMaxMs, t.renderP99Ms,
+                (unsigned long long)t.simSteps, (unsigned long long)t.lateSteps,
+                (unsigned)t.obstacles, (unsigned)t.particles, age, (unsigned)retries, flags);
+}
+
+int main(int argc, char** argv){
+    TopOptions o;
+    if(!ParseArgs(argc, argv, o)){ PrintUsage(); return 2; }
+
+    // mappings stay open between polls; only new names are opened
+    std::map<std::string, std::unique_ptr<TelemetryReader>> readers;
+    for(uint64_t n=0; !o.count || n < o.count; n++){
+        if(n) std::this_thread::sleep_for(std::chrono::milliseconds(o.interval));
+        std::vector<std::string> names = o.name.empty() ? ListTelemetry() : std::vector<std::string>{ o.name };
+        std::map<std::string, std::unique_ptr<TelemetryReader>> live;
+        for(const auto &name: names){
+            auto it = readers.find(name);
+            if(it != readers.end()){ live[name] = std::move(it->second); continue; }
+            std::unique_ptr<TelemetryReader> r(new TelemetryReader());
+            if(r->Open(name)) live[name] = std::move(r);
+        }
+        readers.swap(live);
+
+        if(readers.empty()){
+            std::printf("no T-Rex telemetry%s%s\n", o.name.empty() ? "" : " at ", o.name.c_str());
+            continue;
+        }
+        PrintHeader();
+        for(const auto &kv: readers){
+            TelemetrySample t;
+            uint32_t retries = 0;
+            if(kv.second->Read(t, &retries)) PrintSample(kv.second->Pid(), t, retries);
+            else std::printf("%7u (no consistent sample after %u tries)\n", (unsigned)kv.second->Pid(), (unsigned)retries);
+        }
+        std::fflush(stdout);
+    }
+    return readers.empty() ? 1 : 0;
+}
@@ -0,0 +1,47 @@
+// ------------------------------------------------------------------
+// File: trex_triple.h
+// Lock-free triple buffer: one writer publishes, one reader takes latest
+// ------------------------------------------------------------------
+//  - three slots: the writer owns one (back), the reader owns one
+//    (front), the third (middle) is handed over with a single atomic
+//    exchange in each direction
+//  - the writer never waits and never overwrites what the reader holds;
+//    the reader always gets the newest complete value, and a value it
+//    is holding stays untouched until its next Latest()
+//  - values the reader never looked at are simply replaced
+// ------------------------------------------------------------------
+#ifndef TREX_TRIPLE_H
+#define TREX_TRIPLE_H
+
+#include <atomic>
+#include <cstdint>
+
+template<class T>
+class TripleBuffer {
+public:
+    // Writer: fill Back() completely, then Publish() it.
+    T&   Back(){ return slots_[back_]; }
+    void Publish(){
+        back_ = (uint8_t)(middle_.exchange((uint8_t)(back_ | FRESH), std::memory_order_acq_rel) & INDEX);
+    }
+
+    // Reader: the newest published value (the one held before if
+    // nothing new was published; slot 2 default-constructed at first).
+    const T& Latest(){
+        if(middle_.load(std::memory_order_relaxed) & FRESH)
+            front_ = (uint8_t)(middle_.exchange(front_, std::memory_order_acq_rel) & INDEX);
+        return slots_[front_];
+    }
+    // True if Latest() would return a value not seen yet.
+    bool Fresh() const { return (middle_.load(std::memory_order_relaxed) & FRESH) != 0; }
+
+private:
+    static const uint8_t INDEX = 3, FRESH = 4;
+
+    T slots_[3];
+    alignas(64) std::atomic<uint8_t> middle_{1};
+    alignas(64) uint8_t back_ = 0;     // writer only
+    alignas(64) uint8_t front_ = 2;    // reader only
+};
+
+#endif